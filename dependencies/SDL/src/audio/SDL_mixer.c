@@ -30,6 +30,7 @@
 #include "SDL_mixer_MMX.h"
 #include "SDL_mixer_MMX_VC.h"
 #include "SDL_mixer_m68k.h"
+#include "SDL_mixer_SIMD.h"
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -196,31 +197,8 @@ void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
 #if defined(__GNUC__) && (defined(__m68k__) && !defined(__mcoldfire__)) && defined(SDL_ASSEMBLY_ROUTINES)
 			SDL_MixAudio_m68k_S16LSB((short*)dst,(short*)src,(unsigned long)len,(long)volume);
 #else
-			{
-			Sint16 src1, src2;
-			int dst_sample;
-			const int max_audioval = ((1<<(16-1))-1);
-			const int min_audioval = -(1<<(16-1));
-
-			len /= 2;
-			while ( len-- ) {
-				src1 = ((src[1])<<8|src[0]);
-				ADJUST_VOLUME(src1, volume);
-				src2 = ((dst[1])<<8|dst[0]);
-				src += 2;
-				dst_sample = src1+src2;
-				if ( dst_sample > max_audioval ) {
-					dst_sample = max_audioval;
-				} else
-				if ( dst_sample < min_audioval ) {
-					dst_sample = min_audioval;
-				}
-				dst[0] = dst_sample&0xFF;
-				dst_sample >>= 8;
-				dst[1] = dst_sample&0xFF;
-				dst += 2;
-			}
-			}
+			/* SSE2 or NEON where the CPU has it, the C version otherwise */
+			SDL_MixAudio_SIMD_S16LSB(dst, src, len, volume);
 #endif
 		}
 		break;
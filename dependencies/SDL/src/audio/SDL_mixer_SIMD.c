@@ -0,0 +1,169 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_audio.h"
+#include "SDL_endian.h"
+#include "SDL_mixer_SIMD.h"
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDL_MIXER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SDL_MIXER_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/* SDL_MIX_MAXVOLUME is 128, the vector versions divide by shifting */
+#define VOLUME_SHIFT	7
+
+void SDL_MixAudio_C_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	Sint16 src1, src2;
+	int dst_sample;
+	const int max_audioval = ((1<<(16-1))-1);
+	const int min_audioval = -(1<<(16-1));
+
+	len /= 2;
+	while ( len-- ) {
+		src1 = ((src[1])<<8|src[0]);
+		src1 = (src1*volume)/SDL_MIX_MAXVOLUME;
+		src2 = ((dst[1])<<8|dst[0]);
+		src += 2;
+		dst_sample = src1+src2;
+		if ( dst_sample > max_audioval ) {
+			dst_sample = max_audioval;
+		} else
+		if ( dst_sample < min_audioval ) {
+			dst_sample = min_audioval;
+		}
+		dst[0] = dst_sample&0xFF;
+		dst_sample >>= 8;
+		dst[1] = dst_sample&0xFF;
+		dst += 2;
+	}
+}
+
+#if defined(SDL_MIXER_SSE2)
+/* Eight samples at a time. The volume products are widened to 32 bits, and
+   negative ones get SDL_MIX_MAXVOLUME-1 added before the shift, so they
+   round toward zero like the division in the C version. The add saturates
+   the way the C version clamps. */
+static Uint32 SDL_MixAudio_SSE2_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const Uint32 blocks = len / 16;
+	Uint32 i;
+
+	if ( volume == SDL_MIX_MAXVOLUME ) {
+		for ( i = 0; i < blocks; ++i, src += 16, dst += 16 ) {
+			__m128i s = _mm_loadu_si128((const __m128i *) src);
+			__m128i d = _mm_loadu_si128((const __m128i *) dst);
+			_mm_storeu_si128((__m128i *) dst, _mm_adds_epi16(d, s));
+		}
+	} else {
+		const __m128i vol = _mm_set1_epi16((short) volume);
+		const __m128i bias = _mm_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+
+		for ( i = 0; i < blocks; ++i, src += 16, dst += 16 ) {
+			__m128i s = _mm_loadu_si128((const __m128i *) src);
+			__m128i d = _mm_loadu_si128((const __m128i *) dst);
+			__m128i lo = _mm_mullo_epi16(s, vol);
+			__m128i hi = _mm_mulhi_epi16(s, vol);
+			__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+			__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+			p0 = _mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias));
+			p1 = _mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias));
+			s = _mm_packs_epi32(_mm_srai_epi32(p0, VOLUME_SHIFT), _mm_srai_epi32(p1, VOLUME_SHIFT));
+
+			_mm_storeu_si128((__m128i *) dst, _mm_adds_epi16(d, s));
+		}
+	}
+
+	return blocks * 16;
+}
+#endif
+
+#if defined(SDL_MIXER_NEON)
+/* Same as the SSE2 version, byte loads keep it safe for any alignment */
+static Uint32 SDL_MixAudio_NEON_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	const Uint32 blocks = len / 16;
+	Uint32 i;
+
+	if ( volume == SDL_MIX_MAXVOLUME ) {
+		for ( i = 0; i < blocks; ++i, src += 16, dst += 16 ) {
+			int16x8_t s = vreinterpretq_s16_u8(vld1q_u8(src));
+			int16x8_t d = vreinterpretq_s16_u8(vld1q_u8(dst));
+			vst1q_u8(dst, vreinterpretq_u8_s16(vqaddq_s16(d, s)));
+		}
+	} else {
+		const int16x4_t vol = vdup_n_s16((int16_t) volume);
+		const int32x4_t bias = vdupq_n_s32(SDL_MIX_MAXVOLUME - 1);
+
+		for ( i = 0; i < blocks; ++i, src += 16, dst += 16 ) {
+			int16x8_t s = vreinterpretq_s16_u8(vld1q_u8(src));
+			int16x8_t d = vreinterpretq_s16_u8(vld1q_u8(dst));
+			int32x4_t p0 = vmull_s16(vget_low_s16(s), vol);
+			int32x4_t p1 = vmull_s16(vget_high_s16(s), vol);
+
+			p0 = vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), bias));
+			p1 = vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), bias));
+			s = vcombine_s16(vshrn_n_s32(p0, VOLUME_SHIFT), vshrn_n_s32(p1, VOLUME_SHIFT));
+
+			vst1q_u8(dst, vreinterpretq_u8_s16(vqaddq_s16(d, s)));
+		}
+	}
+
+	return blocks * 16;
+}
+#endif
+
+void SDL_MixAudio_SIMD_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	Uint32 done = 0;
+
+	/* The shift only matches the division for volumes in range */
+	if ( volume >= 0 && volume <= SDL_MIX_MAXVOLUME ) {
+#if defined(SDL_MIXER_SSE2)
+		done = SDL_MixAudio_SSE2_S16LSB(dst, src, len, volume);
+#elif defined(SDL_MIXER_NEON)
+		done = SDL_MixAudio_NEON_S16LSB(dst, src, len, volume);
+#endif
+	}
+
+	/* What is left over, less than a block */
+	SDL_MixAudio_C_S16LSB(dst + done, src + done, len - done, volume);
+}
+
+const char *SDL_MixAudio_SIMDName(void)
+{
+#if defined(SDL_MIXER_SSE2)
+	return "SSE2";
+#elif defined(SDL_MIXER_NEON)
+	return "NEON";
+#else
+	return "none";
+#endif
+}
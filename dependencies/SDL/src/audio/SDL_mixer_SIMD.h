@@ -0,0 +1,38 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/*
+	SSE2 and NEON versions of the 16 bit little endian mix routine
+
+	Both give exactly the samples the C version gives. Where neither
+	instruction set is there, or on big endian CPUs, the SIMD entry point
+	runs the C version.
+*/
+
+#include "SDL_stdinc.h"
+
+void SDL_MixAudio_C_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+void SDL_MixAudio_SIMD_S16LSB(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
+
+/* "SSE2", "NEON" or "none" */
+const char *SDL_MixAudio_SIMDName(void);
@@ -36,6 +36,13 @@
 /* The tag name used by DUMMY audio */
 #define LIBRETRO_DRIVER_NAME         "libretro"
 
+/* Mixer chunks the output ring holds. A chunk is mixed each frame and most
+   of it goes out the same frame, the rest is room to spare. */
+#define LIBRETRO_RING_CHUNKS         4
+
+/* Furthest the sent rate may be from the mixed one */
+#define LIBRETRO_MAX_RATIO_ADJUST    0.02
+
 // defined in libretro.cpp
 extern short int libretro_audio_cb(int16_t *buffer, uint32_t buffer_len);
 
@@ -125,37 +132,126 @@ static void LIBRETRO_CloseAudio(_THIS)
 		SDL_FreeAudioMem(this->hidden->mixbuf);
 		this->hidden->mixbuf = NULL;
 	}
+	if ( this->hidden->outbuf != NULL ) {
+		SDL_free(this->hidden->outbuf);
+		this->hidden->outbuf = NULL;
+	}
+}
+
+/* Sends the queued frames straight out of the ring, without copying them */
+static void LIBRETRO_SendRing(struct SDL_PrivateAudioData *hidden)
+{
+	while (hidden->ring_fill > 0) {
+		Uint32 frames = hidden->ring_frames - hidden->ring_read;
+
+		if (frames > hidden->ring_fill) {
+			frames = hidden->ring_fill;
+		}
+
+		libretro_audio_cb((int16_t *) hidden->mixbuf + hidden->ring_read * 2, frames);
+
+		hidden->ring_read = (hidden->ring_read + frames) % hidden->ring_frames;
+		hidden->ring_fill -= frames;
+	}
+
+	/* Dropping what was left between two frames shifts the sound by less
+	   than a frame */
+	hidden->phase = 0;
+}
+
+/* Interpolates between each two queued frames, stepping step input frames
+   per frame sent. The last frame stays queued to start the next batch. */
+static void LIBRETRO_Resample(struct SDL_PrivateAudioData *hidden)
+{
+	const Sint16 *ring = (const Sint16 *) hidden->mixbuf;
+	Sint16 *out = hidden->outbuf;
+	Uint32 frames = 0;
+
+	while (hidden->ring_fill >= 2 && frames < hidden->outbuf_frames) {
+		const Sint16 *left = ring + hidden->ring_read * 2;
+		const Sint16 *right = ring + ((hidden->ring_read + 1) % hidden->ring_frames) * 2;
+		Sint32 weight = (Sint32) (hidden->phase >> 1);
+		Uint32 advance;
+
+		/* 15 bit weights keep the products inside 32 bits */
+		out[0] = (Sint16) (left[0] + (((right[0] - left[0]) * weight) >> 15));
+		out[1] = (Sint16) (left[1] + (((right[1] - left[1]) * weight) >> 15));
+		out += 2;
+		frames++;
+
+		hidden->phase += hidden->step;
+		advance = hidden->phase >> 16;
+		hidden->phase &= 0xFFFF;
+
+		hidden->ring_read = (hidden->ring_read + advance) % hidden->ring_frames;
+		hidden->ring_fill -= advance;
+	}
+
+	libretro_audio_cb((int16_t *) hidden->outbuf, frames);
+}
+
+/* ratio is how many frames are sent for each frame mixed. At 1.0 the mixer
+   output goes out as it is. */
+void LIBRETRO_SetAudioRatio(double ratio)
+{
+	if (audiodevice == NULL) {
+		return;
+	}
+
+	if (ratio < 1.0 - LIBRETRO_MAX_RATIO_ADJUST) {
+		ratio = 1.0 - LIBRETRO_MAX_RATIO_ADJUST;
+	} else if (ratio > 1.0 + LIBRETRO_MAX_RATIO_ADJUST) {
+		ratio = 1.0 + LIBRETRO_MAX_RATIO_ADJUST;
+	}
+
+	audiodevice->hidden->step = (Uint32) (65536.0 / ratio + 0.5);
 }
 
+/* Mixes one chunk, spec->samples frames, into the ring and sends what is
+   queued. Called once per retro_run, so every frame sends its own batch. */
 void LIBRETRO_MixAudio()
 {
 	SDL_AudioDevice *audio = (SDL_AudioDevice *) audiodevice;
-	SDL_AudioSpec *spec = &audio->spec;
+	struct SDL_PrivateAudioData *hidden;
+	SDL_AudioSpec *spec;
+	Uint8 *chunk;
 
 	if (audio == NULL) {
 		return;
 	}
 
 	spec = &audio->spec;
+	hidden = audio->hidden;
 
-	/* Silence the buffer, since it's ours */
-	SDL_memset(audio->hidden->mixbuf, spec->silence, audio->hidden->mixlen);
-
-	/* Only do soemthing if audio is enabled */
-	if (!audio->enabled) {
-		return;
+	/* Nothing went out for a while, start over rather than send old sound */
+	if (hidden->ring_fill + spec->samples > hidden->ring_frames) {
+		hidden->ring_read = hidden->ring_write;
+		hidden->ring_fill = 0;
+		hidden->phase = 0;
 	}
 
-	if (audio->convert.needed) {
-		// TODO
-		return;
+	/* The ring holds whole chunks, so the mixer always gets one piece of it */
+	chunk = hidden->mixbuf + hidden->ring_write * 4;
+
+	/* Silence the buffer, since it's ours */
+	SDL_memset(chunk, spec->silence, spec->size);
+
+	/* Only mix if audio is enabled, the silence still goes out so the
+	   frontend's buffer keeps going. Converting is a TODO. */
+	if (audio->enabled && !audio->convert.needed) {
+		SDL_mutexP(audio->mixer_lock);
+		(*spec->callback)(spec->userdata, chunk, spec->size);
+		SDL_mutexV(audio->mixer_lock);
 	}
 
-	SDL_mutexP(audio->mixer_lock);
-	(*spec->callback)(spec->userdata, audio->hidden->mixbuf, audio->hidden->mixlen);
-	SDL_mutexV(audio->mixer_lock);
+	hidden->ring_write = (hidden->ring_write + spec->samples) % hidden->ring_frames;
+	hidden->ring_fill += spec->samples;
 
-	libretro_audio_cb(audio->hidden->mixbuf, spec->size / spec->channels / 2);
+	if (hidden->step == 0x10000) {
+		LIBRETRO_SendRing(hidden);
+	} else {
+		LIBRETRO_Resample(hidden);
+	}
 }
 
 static int LIBRETRO_OpenAudio(_THIS, SDL_AudioSpec *spec)
@@ -170,13 +266,29 @@ static int LIBRETRO_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	/* Update the fragment size as size in bytes */
 	SDL_CalculateAudioSpec(spec);
 
-	/* Allocate mixing buffer */
-	this->hidden->mixlen = spec->size;
+	/* Allocate the ring the mixer mixes into, always stereo S16 */
+	this->hidden->ring_frames = spec->samples * LIBRETRO_RING_CHUNKS;
+	this->hidden->ring_read = 0;
+	this->hidden->ring_write = 0;
+	this->hidden->ring_fill = 0;
+
+	this->hidden->mixlen = spec->size * LIBRETRO_RING_CHUNKS;
 	this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
 	if ( this->hidden->mixbuf == NULL ) {
 		return(-1);
 	}
-	SDL_memset(this->hidden->mixbuf, spec->silence, spec->size);
+	SDL_memset(this->hidden->mixbuf, spec->silence, this->hidden->mixlen);
+
+	/* Room for resampling all of the ring at the highest ratio */
+	this->hidden->outbuf_frames = (Uint32) (this->hidden->ring_frames * (1.0 + LIBRETRO_MAX_RATIO_ADJUST)) + 2;
+	this->hidden->outbuf = (Sint16 *) SDL_malloc(this->hidden->outbuf_frames * 2 * sizeof(Sint16));
+	if ( this->hidden->outbuf == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+
+	this->hidden->step = 0x10000;
+	this->hidden->phase = 0;
 
 	bytes_per_sec = (float) (((spec->format & 0xFF) / 8) *
 	                   spec->channels * spec->freq);
@@ -35,6 +35,18 @@ struct SDL_PrivateAudioData {
 	Uint32 mixlen;
 	Uint32 write_delay;
 	Uint32 initial_calls;
+
+	/* mixbuf is a ring of whole mixer chunks, positions are in frames */
+	Uint32 ring_frames;
+	Uint32 ring_read;
+	Uint32 ring_write;
+	Uint32 ring_fill;
+
+	/* Resampler output, step and phase are 16.16 fixed point input frames */
+	Sint16 *outbuf;
+	Uint32 outbuf_frames;
+	Uint32 step;
+	Uint32 phase;
 };
 
 #endif /* _SDL_libretroaudio_h */
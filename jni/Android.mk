@@ -9,6 +9,7 @@ NEED_BPP                 := 16
 NEED_STEREO_SOUND        := 1
 HAVE_CHD                 := 0
 IS_X86                   := 0
+HAVE_THREADS             := 1
 FLAGS                    :=
 
 ifeq ($(TARGET_ARCH),x86)
@@ -0,0 +1,478 @@
+//Headless benchmark for the gameplay simulation. Links the whole core, acts
+//as a do-nothing frontend and runs one match between CPU players:
+//
+//  superbroswar_benchmark <data dir> <maps.zip> <map> [options]
+//
+//    -players N    CPU players, 1 to 4 (default 4)
+//    -frames K     frames to run (default 3600)
+//    -seed S       random seed (default 1)
+//    -mode M       game mode index, see create_gamemodes() (default 0)
+//    -norender     only simulate, skip drawing the frames
+//
+//It prints the frame rate, the per phase timings of the frame profiler and a
+//hash of the final match state. Two runs with the same arguments have to
+//produce the same hash, on any build.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "libretro.h"
+#include "zlib.h"
+
+#include "FrameProfiler.h"
+#include "GameMode.h"
+#include "GameValues.h"
+#include "GSGameplay.h"
+#include "map.h"
+#include "ObjectContainer.h"
+#include "player.h"
+#include "RandomNumberGenerator.h"
+#include "ResourceManager.h"
+#include "Score.h"
+
+extern CGameValues game_values;
+extern CResourceManager* rm;
+extern CMap* g_map;
+
+extern CGameMode *gamemodes[GAMEMODE_LAST];
+
+extern CPlayer *list_players[4];
+extern short list_players_cnt;
+
+extern CScore *score[4];
+extern short score_cnt;
+
+extern CObjectContainer noncolcontainer;
+extern CObjectContainer objectcontainer[3];
+
+extern void SetGameModeSettingsFromMenu();
+extern void LoadCurrentMapBackground();
+extern void LoadMapObjects(bool fPreview);
+
+struct BenchmarkOptions {
+    const char * szDataDir;
+    const char * szZipFile;
+    const char * szMapName;
+
+    short iPlayers;
+    int iFrames;
+    unsigned int iSeed;
+    short iMode;
+    bool fRender;
+};
+
+//
+// Frontend
+//
+static bool environment(unsigned cmd, void * data)
+{
+    switch (cmd) {
+    case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+        return *(enum retro_pixel_format *)data == RETRO_PIXEL_FORMAT_RGB565;
+
+    case RETRO_ENVIRONMENT_SET_VARIABLES:
+    case RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS:
+    case RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static void video_refresh(const void *, unsigned, unsigned, size_t) {}
+static size_t audio_sample_batch(const int16_t *, size_t frames) { return frames; }
+static void audio_sample(int16_t, int16_t) {}
+static void input_poll() {}
+static int16_t input_state(unsigned, unsigned, unsigned, unsigned) { return 0; }
+
+//
+// Zip
+//
+static uint32_t read16(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read32(const uint8_t * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool readFile(const char * szPath, std::vector<uint8_t>& data)
+{
+    FILE * file = fopen(szPath, "rb");
+
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    data.resize(size > 0 ? size : 0);
+    bool fOk = size > 0 && fread(&data[0], 1, size, file) == (size_t)size;
+
+    fclose(file);
+    return fOk;
+}
+
+//Finds szName in the zip's central directory, either as the full entry name
+//or as the file name without its folder, and inflates it
+static bool extractFromZip(const std::vector<uint8_t>& zip, const char * szName, std::vector<uint8_t>& out)
+{
+    size_t iEnd = zip.size();
+
+    if (iEnd < 22)
+        return false;
+
+    size_t iRecord = iEnd - 22;
+    while (read32(&zip[iRecord]) != 0x06054b50) {
+        if (iRecord == 0)
+            return false;
+        iRecord--;
+    }
+
+    uint32_t iEntries = read16(&zip[iRecord + 10]);
+    size_t iEntry = read32(&zip[iRecord + 16]);
+
+    for (uint32_t i = 0; i < iEntries; i++) {
+        if (iEntry + 46 > iEnd || read32(&zip[iEntry]) != 0x02014b50)
+            return false;
+
+        uint32_t iMethod = read16(&zip[iEntry + 10]);
+        uint32_t iPackedSize = read32(&zip[iEntry + 20]);
+        uint32_t iSize = read32(&zip[iEntry + 24]);
+        uint32_t iNameLength = read16(&zip[iEntry + 28]);
+        uint32_t iExtraLength = read16(&zip[iEntry + 30]);
+        uint32_t iCommentLength = read16(&zip[iEntry + 32]);
+        size_t iLocalHeader = read32(&zip[iEntry + 42]);
+
+        std::string sEntryName((const char *)&zip[iEntry + 46], iNameLength);
+        std::string sFileName = sEntryName.substr(sEntryName.find_last_of('/') + 1);
+
+        iEntry += 46 + iNameLength + iExtraLength + iCommentLength;
+
+        if (sEntryName != szName && sFileName != szName)
+            continue;
+
+        if (iLocalHeader + 30 > iEnd)
+            return false;
+
+        size_t iData = iLocalHeader + 30 + read16(&zip[iLocalHeader + 26]) + read16(&zip[iLocalHeader + 28]);
+
+        if (iData + iPackedSize > iEnd)
+            return false;
+
+        out.resize(iSize);
+
+        if (iMethod == 0) {
+            if (iPackedSize != iSize)
+                return false;
+
+            if (iSize > 0)
+                memcpy(&out[0], &zip[iData], iSize);
+            return true;
+        }
+
+        if (iMethod != 8)
+            return false;
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+
+        //Negative window bits, zip entries are raw deflate streams without a zlib header
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return false;
+
+        stream.next_in = (Bytef *)&zip[iData];
+        stream.avail_in = iPackedSize;
+        stream.next_out = (Bytef *)&out[0];
+        stream.avail_out = iSize;
+
+        int iResult = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        return iResult == Z_STREAM_END && stream.total_out == iSize;
+    }
+
+    return false;
+}
+
+//The map reader wants a file, so the map is unpacked next to the other temp files
+static bool extractMap(const BenchmarkOptions& options, std::string& sMapPath)
+{
+    std::vector<uint8_t> zip, map;
+
+    if (!readFile(options.szZipFile, zip)) {
+        fprintf(stderr, "Could not read %s\n", options.szZipFile);
+        return false;
+    }
+
+    std::string sName = options.szMapName;
+    if (sName.find(".map") == std::string::npos)
+        sName += ".map";
+
+    if (!extractFromZip(zip, sName.c_str(), map)) {
+        fprintf(stderr, "Could not extract %s from %s\n", sName.c_str(), options.szZipFile);
+        return false;
+    }
+
+    const char * szTempDir = getenv("TMPDIR");
+    sMapPath = std::string(szTempDir && *szTempDir ? szTempDir : "/tmp") + "/smw_benchmark_" + sName.substr(sName.find_last_of('/') + 1);
+
+    FILE * file = fopen(sMapPath.c_str(), "wb");
+
+    if (!file)
+        return false;
+
+    bool fOk = fwrite(&map[0], 1, map.size(), file) == map.size();
+    fclose(file);
+
+    return fOk;
+}
+
+//
+// Match
+//
+
+//Does what the menu does between "start game" and the first gameplay frame,
+//minus music, fades and the countdown
+static void startMatch(const BenchmarkOptions& options, const std::string& sMapPath)
+{
+    rm->LoadAllGraphics();
+    rm->PreloadGraphics();
+    rm->LoadGameSounds();
+
+    game_values.music = false;
+    game_values.matchtype = MATCH_TYPE_SINGLE_GAME;
+    game_values.startgamecountdown = false;
+
+    //Every player on their own team, all of them driven by CPlayerAI
+    score_cnt = options.iPlayers;
+
+    for (short iPlayer = 0; iPlayer < 4; iPlayer++) {
+        game_values.teamids[iPlayer][0] = iPlayer;
+        game_values.teamcounts[iPlayer] = iPlayer < options.iPlayers ? 1 : 0;
+        game_values.playercontrol[iPlayer] = iPlayer < options.iPlayers ? 2 : 0;
+        game_values.randomskin[iPlayer] = false;
+
+        if (iPlayer < options.iPlayers)
+            rm->LoadFullSkin(rm->spr_player[iPlayer], game_values.skinids[iPlayer], game_values.colorids[iPlayer]);
+    }
+
+    game_values.gamemode = gamemodes[options.iMode];
+    SetGameModeSettingsFromMenu();
+
+    //No winner means the match lasts for as many frames as asked for
+    game_values.gamemode->goal = -1;
+
+    RandomNumberGenerator::generator().reseed(options.iSeed);
+
+    g_map->loadMap(sMapPath, read_type_full);
+    LoadCurrentMapBackground();
+
+    game_values.singleplayermode = -1;
+    game_values.gamestate = GS_GAME;
+    game_values.screenfade = 0;
+    game_values.screenfadespeed = 0;
+
+    g_map->predrawbackground(rm->spr_background, rm->spr_backmap[0]);
+    g_map->predrawforeground(rm->spr_frontmap[0]);
+
+    g_map->predrawbackground(rm->spr_background, rm->spr_backmap[1]);
+    g_map->predrawforeground(rm->spr_frontmap[1]);
+
+    g_map->SetupAnimatedTiles();
+    LoadMapObjects(false);
+
+    GameplayState::instance().setRenderingEnabled(options.fRender);
+    GameStateManager::instance().changeStateTo(&GameplayState::instance());
+}
+
+//FNV-1a over the things a diverging simulation would show up in first.
+//Only values, no pointers, so the hash is stable across builds and runs.
+static uint32_t hashValue(uint32_t hash, const void * data, size_t size)
+{
+    const uint8_t * bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+
+    return hash;
+}
+
+template <class T> static uint32_t hashValue(uint32_t hash, T value)
+{
+    return hashValue(hash, &value, sizeof(T));
+}
+
+static uint32_t hashContainer(uint32_t hash, CObjectContainer& container)
+{
+    hash = hashValue(hash, container.list_end);
+
+    for (short i = 0; i < container.list_end; i++) {
+        CObject * object = container.list[i];
+
+        hash = hashValue(hash, (int)object->getObjectType());
+        hash = hashValue(hash, object->ix);
+        hash = hashValue(hash, object->iy);
+        hash = hashValue(hash, object->GetState());
+    }
+
+    return hash;
+}
+
+static uint32_t matchStateHash()
+{
+    uint32_t hash = 2166136261u;
+
+    hash = hashValue(hash, list_players_cnt);
+
+    for (short i = 0; i < list_players_cnt; i++) {
+        CPlayer * player = list_players[i];
+
+        hash = hashValue(hash, player->getGlobalID());
+        hash = hashValue(hash, player->leftX());
+        hash = hashValue(hash, player->topY());
+        hash = hashValue(hash, player->getVelX());
+        hash = hashValue(hash, player->getVelY());
+        hash = hashValue(hash, player->isdead());
+    }
+
+    for (short i = 0; i < score_cnt; i++)
+        hash = hashValue(hash, score[i]->score);
+
+    hash = hashContainer(hash, noncolcontainer);
+
+    for (short i = 0; i < 3; i++)
+        hash = hashContainer(hash, objectcontainer[i]);
+
+    return hash;
+}
+
+static void printReport(int iFrames, int64_t iElapsed)
+{
+    double dSeconds = iElapsed / 1000000.0;
+
+    printf("frames     %d\n", iFrames);
+    printf("seconds    %.3f\n", dSeconds);
+    printf("fps        %.1f\n", dSeconds > 0.0 ? iFrames / dSeconds : 0.0);
+    printf("\n%-20s %9s %9s %9s\n", "phase (ms)", "min", "avg", "max");
+
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        CFrameProfiler::PhaseStats stats;
+
+        if (!g_profiler.getRunStats((ProfilePhase)iPhase, stats))
+            continue;
+
+        printf("%-20s %9.3f %9.3f %9.3f\n", CFrameProfiler::phaseName((ProfilePhase)iPhase),
+               stats.iMin / 1000.0, stats.iAvg / 1000.0, stats.iMax / 1000.0);
+    }
+
+    printf("\nstate hash %08x\n", matchStateHash());
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: superbroswar_benchmark <data dir> <maps.zip> <map> [-players N] [-frames K] [-seed S] [-mode M] [-norender]\n");
+}
+
+static bool parseOptions(int argc, char ** argv, BenchmarkOptions& options)
+{
+    if (argc < 4)
+        return false;
+
+    options.szDataDir = argv[1];
+    options.szZipFile = argv[2];
+    options.szMapName = argv[3];
+
+    options.iPlayers = 4;
+    options.iFrames = 3600;
+    options.iSeed = 1;
+    options.iMode = 0;
+    options.fRender = true;
+
+    for (int i = 4; i < argc; i++) {
+        bool fHasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-players") && fHasValue)
+            options.iPlayers = (short)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-frames") && fHasValue)
+            options.iFrames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-seed") && fHasValue)
+            options.iSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-mode") && fHasValue)
+            options.iMode = (short)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-norender"))
+            options.fRender = false;
+        else
+            return false;
+    }
+
+    return options.iPlayers >= 1 && options.iPlayers <= 4 &&
+           options.iFrames > 0 &&
+           options.iMode >= 0 && options.iMode < GAMEMODE_LAST;
+}
+
+int main(int argc, char ** argv)
+{
+    BenchmarkOptions options;
+
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    std::string sMapPath;
+    if (!extractMap(options, sMapPath))
+        return 1;
+
+    retro_set_environment(environment);
+    retro_set_video_refresh(video_refresh);
+    retro_set_audio_sample(audio_sample);
+    retro_set_audio_sample_batch(audio_sample_batch);
+    retro_set_input_poll(input_poll);
+    retro_set_input_state(input_state);
+
+    retro_init();
+
+    //The core only looks at the folder the content is in
+    std::string sContent = std::string(options.szDataDir) + "/smw.game";
+
+    struct retro_game_info info;
+    memset(&info, 0, sizeof(info));
+    info.path = sContent.c_str();
+
+    if (!retro_load_game(&info)) {
+        fprintf(stderr, "Could not load the game data from %s\n", options.szDataDir);
+        remove(sMapPath.c_str());
+        return 1;
+    }
+
+    startMatch(options, sMapPath);
+
+    g_profiler.setEnabled(true);
+
+    int64_t iStart = g_profiler.now();
+    int iFrame = 0;
+
+    //Stops early if the match ends anyway (e.g. the mode has no unlimited goal)
+    while (iFrame < options.iFrames && GameStateManager::instance().currentState == &GameplayState::instance()) {
+        retro_run();
+        iFrame++;
+    }
+
+    int64_t iElapsed = g_profiler.now() - iStart;
+
+    printReport(iFrame, iElapsed);
+
+    retro_unload_game();
+    retro_deinit();
+
+    remove(sMapPath.c_str());
+    return 0;
+}
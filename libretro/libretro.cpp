@@ -1,6 +1,7 @@
 #include <ctime>
 #include <cmath>
 #include <cstdlib> // srand()
+#include <cstring>
 
 #include <stdio.h>
 #if defined(_WIN32) && !defined(_XBOX)
@@ -22,16 +23,23 @@
 #define VERSIONNUMBER "1.0"
 
 #include "FileList.h"
+#include "FrameProfiler.h"
+#include "gfx/gfxDirtyRects.h"
+#include "gfx/gfxSkinCache.h"
+#include "gfx/gfxSurfaceCache.h"
 #include "GameMode.h"
 #include "gamemodes.h"
 #include "GameValues.h"
 #include "map.h"
 #include "MapList.h"
+#include "MapPreviewCache.h"
 #include "net.h"
 #include "linfunc.h"
 #include "player.h"
 #include "ResourceManager.h"
+#include "SaveState.h"
 #include "sfx.h"
+#include "SoundCache.h"
 #include "TilesetManager.h"
 
 #include "GSSplashScreen.h"
@@ -140,9 +148,10 @@ static void fallback_log(enum retro_log_level level, const char *fmt, ...)
    va_end(va);
 }
 
+//Not static: map scans and the preview workers log from their own threads
 void libretro_printf(const char *fmt, ...)
 {
-    static char formatted[4096];
+    char formatted[4096];
     va_list args;
 
     if (fmt == NULL)
@@ -162,8 +171,8 @@ static void create_globals()
     rm = new CResourceManager();
 #pragma warning ("delete these or use boost GC shared_ptr")
 
-    g_map = new CMap();
     g_tilesetmanager = new CTilesetManager();
+    g_map = new CMap(rm, g_tilesetmanager);
 
     filterslist = new FiltersList();
     maplist = new MapList(false);
@@ -357,6 +366,8 @@ static void game_deinit()
     for (short i = 0; i < GAMEMODE_LAST; i++)
         delete gamemodes[i];
 
+    g_mappreviews.clear();
+
     sfx_close();
     gfx_close();
     net_close();
@@ -392,6 +403,63 @@ static void gameloop_frame()
     gfx_flipscreen();
 }
 
+// screen->pixels holds the last frame that was presented
+static bool own_buffer_current = true;
+static bool frame_presented    = false;
+
+static bool     have_frame_hash = false;
+static uint64_t last_frame_hash = 0;
+
+// FNV-1a over 64 bit words, only used to spot frames that didn't change
+static uint64_t hash_frame(const void *pixels, unsigned width, unsigned height, size_t pitch)
+{
+    uint64_t hash      = 14695981039346656037ULL;
+    const uint8_t *row = (const uint8_t *)pixels;
+    size_t row_bytes   = width * sizeof(uint16_t);
+
+    for (unsigned y = 0; y < height; y++, row += pitch)
+    {
+        size_t x = 0;
+
+        for (; x + sizeof(uint64_t) <= row_bytes; x += sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, row + x, sizeof(word));
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+
+        for (; x < row_bytes; x++)
+            hash = (hash ^ row[x]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Points the screen at the frontend's framebuffer when the current state
+// paints all of it, which saves the frontend copying the frame out of ours
+static bool use_frontend_framebuffer(GameState *state)
+{
+    struct retro_framebuffer fb = {0};
+
+    if (!state->redrawsWholeScreen())
+        return false;
+
+    fb.width        = screen->w;
+    fb.height       = screen->h;
+    fb.access_flags = RETRO_MEMORY_ACCESS_WRITE | RETRO_MEMORY_ACCESS_READ;
+
+    if (!environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) || !fb.data)
+        return false;
+
+    if (fb.format != RETRO_PIXEL_FORMAT_RGB565 || fb.width != (unsigned)screen->w ||
+        fb.height != (unsigned)screen->h || fb.pitch < fb.width * sizeof(uint16_t) || fb.pitch > 0xFFFF)
+        return false;
+
+    screen->pixels = fb.data;
+    screen->pitch  = (Uint16)fb.pitch;
+    return true;
+}
+
 void retro_init(void)
 {
     const char *system_dir      = NULL;
@@ -399,6 +467,7 @@ void retro_init(void)
     const char *save_dir        = NULL;
     struct retro_vfs_interface_info vfs_iface_info;
     struct retro_log_callback logging;
+    struct retro_perf_callback perf;
 
     struct retro_input_descriptor desc[] = {
         { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT,  "Left" },
@@ -470,6 +539,10 @@ void retro_init(void)
         log_cb = fallback_log;
     }
     
+    //The profiler falls back to std::chrono when the frontend has no timer
+    if (environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf) && perf.get_time_usec)
+        g_profiler.setClock(perf.get_time_usec);
+
     vfs_iface_info.required_interface_version = 3;
     vfs_iface_info.iface                      = NULL;
 
@@ -521,7 +594,136 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 
 void retro_set_environment(retro_environment_t cb)
 {
+    static const struct retro_variable vars[] = {
+        { "superbroswar_profiler", "Frame profiler; disabled|overlay|log|overlay and log" },
+        { "superbroswar_dirty_rects", "Dirty rectangle rendering; disabled|enabled" },
+        { "superbroswar_skin_cache", "Skin cache size; 8 MB|disabled|2 MB|4 MB|16 MB|32 MB" },
+        { "superbroswar_sprite_cache", "Keep converted sprites in the save directory; disabled|enabled" },
+        { "superbroswar_sound_cache", "Keep decoded sound effects in the save directory; disabled|enabled" },
+        { "superbroswar_audio_latency", "Minimum audio latency; frontend default|32 ms|64 ms|96 ms|128 ms" },
+        { NULL, NULL },
+    };
+
     environ_cb = cb;
+    environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void *)vars);
+}
+
+// defined in SDL_libretroaudio.c
+extern "C" void LIBRETRO_MixAudio();
+extern "C" void LIBRETRO_SetAudioRatio(double ratio);
+
+// How far the sent audio rate may stray from the mixed one, and how far the
+// frontend's buffer may stray from half full before it does
+#define AUDIO_MAX_RATE_ADJUST 0.005
+#define AUDIO_DEAD_BAND       10
+
+// reported by the frontend right before each retro_run
+static bool     audio_buffer_status    = false;
+static bool     audio_buffer_active    = false;
+static unsigned audio_buffer_occupancy = 50;
+static bool     audio_buffer_underrun  = false;
+
+// only applied from inside retro_run
+static unsigned audio_min_latency         = 0;
+static bool     audio_min_latency_pending = false;
+
+static void RETRO_CALLCONV audio_buffer_status_cb(bool active, unsigned occupancy, bool underrun_likely)
+{
+    audio_buffer_active    = active;
+    audio_buffer_occupancy = occupancy;
+    audio_buffer_underrun  = underrun_likely;
+}
+
+// Sends a little more or less than was mixed to keep the frontend's buffer
+// about half full. Inside the dead band the mixer output goes out as is.
+static double audio_rate_ratio()
+{
+    if (!audio_buffer_active)
+        return 1.0;
+
+    if (audio_buffer_underrun)
+        return 1.0 + AUDIO_MAX_RATE_ADJUST;
+
+    int distance = 50 - (int)audio_buffer_occupancy;
+
+    if (abs(distance) <= AUDIO_DEAD_BAND)
+        return 1.0;
+
+    return 1.0 + AUDIO_MAX_RATE_ADJUST * distance / 50.0;
+}
+
+static void check_variables()
+{
+    struct retro_variable var;
+
+    var.key = "superbroswar_profiler";
+    var.value = NULL;
+
+    bool fOverlay = false;
+    bool fLog = false;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        fOverlay = !strcmp(var.value, "overlay") || !strcmp(var.value, "overlay and log");
+        fLog = !strcmp(var.value, "log") || !strcmp(var.value, "overlay and log");
+    }
+
+    g_profiler.setOverlay(fOverlay);
+    g_profiler.setLogging(fLog);
+    g_profiler.setEnabled(fOverlay || fLog);
+
+    var.key = "superbroswar_dirty_rects";
+    var.value = NULL;
+
+    bool fDirtyRects = false;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        fDirtyRects = !strcmp(var.value, "enabled");
+
+    g_dirtyrects.setEnabled(fDirtyRects);
+
+    var.key = "superbroswar_skin_cache";
+    var.value = NULL;
+
+    size_t iSkinCacheBudget = SKINCACHE_DEFAULT_BUDGET;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        iSkinCacheBudget = (size_t)atoi(var.value) * 1024 * 1024;
+
+    g_skincache.setBudget(iSkinCacheBudget);
+
+    var.key = "superbroswar_sprite_cache";
+    var.value = NULL;
+
+    bool fSpriteCache = false;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        fSpriteCache = !strcmp(var.value, "enabled");
+
+    g_surfacecache.setDirectory(fSpriteCache ? GetHomeDirectory() + SURFACECACHE_DIRECTORY : "");
+
+    var.key = "superbroswar_sound_cache";
+    var.value = NULL;
+
+    bool fSoundCache = false;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        fSoundCache = !strcmp(var.value, "enabled");
+
+    g_soundcache.setDirectory(fSoundCache ? GetHomeDirectory() + SOUNDCACHE_DIRECTORY : "");
+
+    var.key = "superbroswar_audio_latency";
+    var.value = NULL;
+
+    unsigned iAudioLatency = 0;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        iAudioLatency = (unsigned)atoi(var.value);
+
+    // asking again can restart the frontend's audio driver
+    if (iAudioLatency != audio_min_latency) {
+        audio_min_latency = iAudioLatency;
+        audio_min_latency_pending = true;
+    }
 }
 
 void retro_reset(void)
@@ -529,16 +731,72 @@ void retro_reset(void)
     // no reset
 }
 
-// defined in SDL_libretroaudio.c
-extern "C" void LIBRETRO_MixAudio();
-
 void retro_run(void)
 {
+    bool updated = false;
+
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
+        check_variables();
+
     input_poll_cb();
 
+    GameState *state  = GameStateManager::instance().currentState;
+    void *own_pixels  = screen->pixels;
+    Uint16 own_pitch  = screen->pitch;
+    bool direct       = use_frontend_framebuffer(state);
+
+    gfx_setscreenpreserved(!direct && own_buffer_current);
+
     gameloop_frame();
-    video_cb(screen->pixels, screen->w, screen->h, screen->pitch);
 
+    // switching states ends the frame before anything is drawn
+    bool drawn        = GameStateManager::instance().currentState == state;
+    const void *frame = screen->pixels;
+    size_t pitch      = screen->pitch;
+
+    // the frontend's buffer must not be touched after retro_run returns
+    screen->pixels = own_pixels;
+    screen->pitch  = own_pitch;
+
+    // with nothing presented yet there is no frame to repeat, and nothing was
+    // drawn into the frontend's buffer, so show the core's own one instead
+    if (!drawn && !frame_presented)
+    {
+        frame  = own_pixels;
+        pitch  = own_pitch;
+        direct = false;
+    }
+
+    bool duplicate = !drawn;
+
+    if (drawn && state->framesCanRepeat())
+    {
+        uint64_t hash   = hash_frame(frame, screen->w, screen->h, pitch);
+        duplicate       = have_frame_hash && hash == last_frame_hash;
+        last_frame_hash = hash;
+        have_frame_hash = true;
+    }
+    else if (drawn)
+        have_frame_hash = false;
+
+    if (duplicate && frame_presented)
+        video_cb(NULL, screen->w, screen->h, pitch);
+    else
+    {
+        video_cb(frame, screen->w, screen->h, pitch);
+        frame_presented    = true;
+        own_buffer_current = !direct;
+    }
+
+    if (audio_min_latency_pending)
+    {
+        environ_cb(RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY, &audio_min_latency);
+        audio_min_latency_pending = false;
+    }
+
+    sfx_update();
+
+    LIBRETRO_SetAudioRatio(audio_rate_ratio());
     LIBRETRO_MixAudio();
 }
 
@@ -546,11 +804,25 @@ bool retro_load_game(const struct retro_game_info *info)
 {
     enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_RGB565;
 
+    // states hold raw pointers into this process, see SaveState.h
+    uint64_t quirks = RETRO_SERIALIZATION_QUIRK_SINGLE_SESSION |
+                      RETRO_SERIALIZATION_QUIRK_ENDIAN_DEPENDENT |
+                      RETRO_SERIALIZATION_QUIRK_PLATFORM_DEPENDENT;
+
     if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
     {
         log_cb(RETRO_LOG_INFO, "RGB565 is not supported.\n");
         return false;
     }
+
+    environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks);
+
+    // without it the mixer output always goes out as it is
+    struct retro_audio_buffer_status_callback buffer_status = { audio_buffer_status_cb };
+    audio_buffer_status = environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buffer_status);
+    audio_buffer_active = false;
+
+    check_variables();
     
     if (info && !string_is_empty(info->path))
     {
@@ -567,6 +839,12 @@ bool retro_load_game(const struct retro_game_info *info)
 
 void retro_unload_game(void)
 {
+    if (audio_buffer_status)
+        environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+
+    audio_buffer_status = false;
+    audio_buffer_active = false;
+
     CleanUp();
     game_values.gamestate = GS_QUIT;
     game_deinit();
@@ -584,17 +862,17 @@ bool retro_load_game_special(unsigned type, const struct retro_game_info *info,
 
 size_t retro_serialize_size(void)
 {
-    return 0;
+    return SaveState::maxSize();
 }
 
 bool retro_serialize(void *data_, size_t size)
 {
-    return false;
+    return SaveState::save(data_, size);
 }
 
 bool retro_unserialize(const void *data_, size_t size)
 {
-    return false;
+    return SaveState::load(data_, size);
 }
 
 void *retro_get_memory_data(unsigned id)
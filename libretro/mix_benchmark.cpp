@@ -0,0 +1,154 @@
+//Micro benchmark for the 16 bit mix routine behind SDL_MixAudio. Mixes a
+//frame's worth of sound from N channels into one buffer, like SDL_mixer does
+//every retro_run, once with the C version and once with the SIMD version:
+//
+//  superbroswar_mix_benchmark [-frames K] [-volume V] [channels ...]
+//
+//    -frames K     frames to mix per run (default 20000)
+//    -volume V     channel volume besides the full one, 0 to 128 (default 96)
+//    channels      channel counts to run (default 1 4 8 16)
+//
+//Both versions have to produce the same samples, it fails if they don't.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <stdint.h>
+
+//SDL_mixer_SIMD.c, Uint8 and Uint32 spelled out to keep SDL's headers out
+extern "C" void SDL_MixAudio_C_S16LSB(uint8_t *dst, const uint8_t *src, uint32_t len, int volume);
+extern "C" void SDL_MixAudio_SIMD_S16LSB(uint8_t *dst, const uint8_t *src, uint32_t len, int volume);
+extern "C" const char *SDL_MixAudio_SIMDName(void);
+
+typedef void (*MixFunction)(uint8_t *dst, const uint8_t *src, uint32_t len, int volume);
+
+//One retro_run at 44.1 kHz and 60 fps, stereo 16 bit
+#define FRAME_SAMPLES   735
+#define FRAME_BYTES     (FRAME_SAMPLES * 2 * 2)
+
+#define MAX_CHANNELS    16  //NUM_SOUND_CHANNELS
+
+struct MixOptions {
+    int iFrames;
+    int iVolume;
+    std::vector<int> channels;
+};
+
+//Loud noise, so the sums clip as often as overlapping explosions do
+static void fillChannels(std::vector<uint8_t>& data)
+{
+    uint32_t iState = 12345;
+
+    for (size_t i = 0; i < data.size(); i++) {
+        iState ^= iState << 13;
+        iState ^= iState >> 17;
+        iState ^= iState << 5;
+        data[i] = (uint8_t)iState;
+    }
+}
+
+//Mixes the frames and returns the time it took in nanoseconds. Each frame
+//starts from silence like SDL's audio callback does.
+static double runMix(MixFunction mix, const std::vector<uint8_t>& channels, int iChannels, int iVolume, int iFrames, std::vector<uint8_t>& out)
+{
+    out.assign(FRAME_BYTES, 0);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int iFrame = 0; iFrame < iFrames; iFrame++) {
+        memset(&out[0], 0, FRAME_BYTES);
+
+        for (int iChannel = 0; iChannel < iChannels; iChannel++)
+            mix(&out[0], &channels[iChannel * FRAME_BYTES], FRAME_BYTES, iVolume);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: superbroswar_mix_benchmark [-frames K] [-volume V] [channels ...]\n");
+}
+
+static bool parseOptions(int argc, char ** argv, MixOptions& options)
+{
+    options.iFrames = 20000;
+    options.iVolume = 96;
+
+    for (int i = 1; i < argc; i++) {
+        bool fHasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-frames") && fHasValue)
+            options.iFrames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-volume") && fHasValue)
+            options.iVolume = atoi(argv[++i]);
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9')
+            options.channels.push_back(atoi(argv[i]));
+        else
+            return false;
+    }
+
+    if (options.channels.empty()) {
+        options.channels.push_back(1);
+        options.channels.push_back(4);
+        options.channels.push_back(8);
+        options.channels.push_back(MAX_CHANNELS);
+    }
+
+    for (size_t i = 0; i < options.channels.size(); i++) {
+        if (options.channels[i] < 1 || options.channels[i] > MAX_CHANNELS)
+            return false;
+    }
+
+    return options.iFrames > 0 && options.iVolume >= 0 && options.iVolume <= 128;
+}
+
+int main(int argc, char ** argv)
+{
+    MixOptions options;
+
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    std::vector<uint8_t> channels(MAX_CHANNELS * FRAME_BYTES);
+    fillChannels(channels);
+
+    int volumes[2] = {128, options.iVolume};
+    int iVolumes = options.iVolume == 128 ? 1 : 2;
+
+    printf("SIMD: %s, %d frames of %d samples\n\n", SDL_MixAudio_SIMDName(), options.iFrames, FRAME_SAMPLES);
+    printf("channels  volume     C us/frame  SIMD us/frame  speedup\n");
+
+    std::vector<uint8_t> scalarOut, simdOut;
+    bool fMatch = true;
+
+    for (size_t i = 0; i < options.channels.size(); i++) {
+        for (int iVolume = 0; iVolume < iVolumes; iVolume++) {
+            int iChannels = options.channels[i];
+            int volume = volumes[iVolume];
+
+            double scalar = runMix(SDL_MixAudio_C_S16LSB, channels, iChannels, volume, options.iFrames, scalarOut);
+            double simd = runMix(SDL_MixAudio_SIMD_S16LSB, channels, iChannels, volume, options.iFrames, simdOut);
+
+            bool fSame = scalarOut == simdOut;
+            fMatch = fMatch && fSame;
+
+            printf("%8d  %6d  %13.2f  %13.2f  %6.2fx%s\n", iChannels, volume,
+                   scalar / options.iFrames / 1000.0, simd / options.iFrames / 1000.0,
+                   simd > 0.0 ? scalar / simd : 0.0, fSame ? "" : "  MISMATCH");
+        }
+    }
+
+    if (!fMatch) {
+        fprintf(stderr, "\nThe SIMD version mixed different samples than the C version\n");
+        return 1;
+    }
+
+    return 0;
+}
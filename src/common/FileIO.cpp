@@ -13,8 +13,22 @@
 
 BinaryFile::BinaryFile(const char* filename, const char* options)
     : fp(NULL)
+    , fBuffered(false)
+    , cursor(0)
 {
     fp = fopen(filename, options);
+
+    if (fp && options[0] == 'r' && !strchr(options, '+')) {
+        //If the size can't be found out, keep reading from the file
+        if (load_into_buffer()) {
+            fclose(fp);
+            fp = NULL;
+            fBuffered = true;
+        } else {
+            buffer.clear();
+            ::rewind(fp);
+        }
+    }
 }
 
 BinaryFile::~BinaryFile()
@@ -23,26 +37,54 @@ BinaryFile::~BinaryFile()
         fclose(fp);
 }
 
+bool BinaryFile::load_into_buffer()
+{
+    if (fseek(fp, 0, SEEK_END) != 0)
+        return false;
+
+    int64_t size = ftell(fp);
+
+    if (size < 0 || fseek(fp, 0, SEEK_SET) != 0)
+        return false;
+
+    buffer.resize((size_t)size);
+
+    return size == 0 || fread(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+}
+
 void BinaryFile::fread_or_exception(void* ptr, size_t size, size_t count)
 {
-    if (fread(ptr, size, count, fp) != count)
+    if (fBuffered) {
+        size_t bytes = size * count;
+
+        if (bytes > buffer.size() - cursor)
+            throw std::runtime_error("File read error");
+
+        memcpy(ptr, buffer.data() + cursor, bytes);
+        cursor += bytes;
+        return;
+    }
+
+    if (!fp || fread(ptr, size, count, fp) != count)
         throw std::runtime_error("File read error");
 }
 
 void BinaryFile::fwrite_or_exception(const void* ptr, size_t size, size_t count)
 {
-    if (fwrite(ptr, size, count, fp) != count)
+    if (!fp || fwrite(ptr, size, count, fp) != count)
         throw std::runtime_error("File write error");
 }
 
 bool BinaryFile::is_open()
 {
-    return fp;
+    return fp || fBuffered;
 }
 
 void BinaryFile::rewind()
 {
-    if (fp)
+    if (fBuffered)
+        cursor = 0;
+    else if (fp)
         ::rewind(fp);
 }
 
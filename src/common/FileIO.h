@@ -3,7 +3,11 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <vector>
 
+//Files opened for reading are loaded in one go and decoded from memory, which
+//saves a trip through the frontend's file layer for every value. Writing
+//still goes straight to the file.
 class BinaryFile {
 public:
     BinaryFile(const char* filename, const char* options);
@@ -37,6 +41,11 @@ public:
 private:
     FILE* fp;
 
+    bool fBuffered;
+    std::vector<uint8_t> buffer;
+    size_t cursor;
+
+    bool load_into_buffer();
     void fread_or_exception(void*, size_t, size_t);
     void fwrite_or_exception(const void*, size_t, size_t);
 };
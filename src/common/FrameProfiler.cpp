@@ -0,0 +1,189 @@
+#include "FrameProfiler.h"
+
+#include <chrono>
+
+extern void libretro_printf(const char *fmt, ...);
+
+CFrameProfiler g_profiler;
+
+static const char * g_szPhaseNames[PROFILE_LAST] = {
+    "update world",
+    " p2p collisions",
+    " platforms",
+    " player move",
+    " object update",
+    " p2obj collisions",
+    " obj2obj collisions",
+    " eyecandy",
+    " gamemode think",
+    " map update",
+    "draw",
+    " back layer",
+    " middle layer",
+    " front layer",
+    " spotlights",
+    " hud"
+};
+
+static int64_t steadyClock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+// class frame profiler
+//------------------------------------------------------------------------------
+CFrameProfiler::CFrameProfiler()
+{
+    fEnabled = false;
+    fLogging = false;
+    fOverlay = false;
+
+    clockSource = steadyClock;
+
+    reset();
+}
+
+void CFrameProfiler::setEnabled(bool enabled)
+{
+    //Don't mix in numbers from before the profiler was switched off
+    if (enabled && !fEnabled)
+        reset();
+
+    fEnabled = enabled;
+}
+
+void CFrameProfiler::setClock(ProfilerClock newclock)
+{
+    clockSource = newclock ? newclock : steadyClock;
+}
+
+void CFrameProfiler::reset()
+{
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        iFrameTime[iPhase] = 0;
+        fRanThisFrame[iPhase] = false;
+
+        iSampleCount[iPhase] = 0;
+        iNextSample[iPhase] = 0;
+
+        iRunTotal[iPhase] = 0;
+        iRunMin[iPhase] = 0;
+        iRunMax[iPhase] = 0;
+        iRunFrames[iPhase] = 0;
+    }
+
+    iFramesSinceReport = 0;
+}
+
+void CFrameProfiler::beginFrame()
+{
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        iFrameTime[iPhase] = 0;
+        fRanThisFrame[iPhase] = false;
+    }
+}
+
+void CFrameProfiler::add(ProfilePhase phase, int64_t iMicroseconds)
+{
+    iFrameTime[phase] += iMicroseconds;
+    fRanThisFrame[phase] = true;
+}
+
+void CFrameProfiler::endFrame()
+{
+    if (!fEnabled)
+        return;
+
+    //Phases that were skipped this frame (countdown, paused) keep their old window
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        if (!fRanThisFrame[iPhase])
+            continue;
+
+        iSamples[iPhase][iNextSample[iPhase]] = iFrameTime[iPhase];
+
+        if (++iNextSample[iPhase] >= PROFILER_WINDOW)
+            iNextSample[iPhase] = 0;
+
+        if (iSampleCount[iPhase] < PROFILER_WINDOW)
+            iSampleCount[iPhase]++;
+
+        int64_t iTime = iFrameTime[iPhase];
+
+        if (iRunFrames[iPhase] == 0 || iTime < iRunMin[iPhase])
+            iRunMin[iPhase] = iTime;
+        if (iRunFrames[iPhase] == 0 || iTime > iRunMax[iPhase])
+            iRunMax[iPhase] = iTime;
+
+        iRunTotal[iPhase] += iTime;
+        iRunFrames[iPhase]++;
+    }
+
+    if (fLogging && ++iFramesSinceReport >= PROFILER_WINDOW) {
+        iFramesSinceReport = 0;
+        logReport();
+    }
+}
+
+bool CFrameProfiler::getStats(ProfilePhase phase, PhaseStats& stats) const
+{
+    stats.iSamples = iSampleCount[phase];
+
+    if (stats.iSamples == 0) {
+        stats.iMin = stats.iAvg = stats.iMax = 0;
+        return false;
+    }
+
+    int64_t iTotal = 0;
+    stats.iMin = iSamples[phase][0];
+    stats.iMax = iSamples[phase][0];
+
+    for (short iSample = 0; iSample < stats.iSamples; iSample++) {
+        int64_t iTime = iSamples[phase][iSample];
+
+        if (iTime < stats.iMin)
+            stats.iMin = iTime;
+        if (iTime > stats.iMax)
+            stats.iMax = iTime;
+
+        iTotal += iTime;
+    }
+
+    stats.iAvg = iTotal / stats.iSamples;
+    return true;
+}
+
+bool CFrameProfiler::getRunStats(ProfilePhase phase, PhaseStats& stats) const
+{
+    stats.iSamples = iRunFrames[phase];
+
+    if (stats.iSamples == 0) {
+        stats.iMin = stats.iAvg = stats.iMax = 0;
+        return false;
+    }
+
+    stats.iMin = iRunMin[phase];
+    stats.iAvg = iRunTotal[phase] / stats.iSamples;
+    stats.iMax = iRunMax[phase];
+    return true;
+}
+
+const char * CFrameProfiler::phaseName(ProfilePhase phase)
+{
+    return g_szPhaseNames[phase];
+}
+
+void CFrameProfiler::logReport() const
+{
+    libretro_printf("[profiler] last %d frames, ms       min      avg      max\n", PROFILER_WINDOW);
+
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        PhaseStats stats;
+
+        if (!getStats((ProfilePhase)iPhase, stats))
+            continue;
+
+        libretro_printf("[profiler] %-20s %8.3f %8.3f %8.3f\n", phaseName((ProfilePhase)iPhase),
+                        stats.iMin / 1000.0, stats.iAvg / 1000.0, stats.iMax / 1000.0);
+    }
+}
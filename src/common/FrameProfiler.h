@@ -0,0 +1,138 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <stdint.h>
+
+#define PROFILER_WINDOW         120     //Frames the rolling min/avg/max cover
+
+enum ProfilePhase {
+    PROFILE_UPDATE_WORLD,
+    PROFILE_P2P_COLLISIONS,
+    PROFILE_PLATFORMS,
+    PROFILE_PLAYER_MOVE,
+    PROFILE_OBJECT_UPDATE,
+    PROFILE_P2OBJ_COLLISIONS,
+    PROFILE_OBJ2OBJ_COLLISIONS,
+    PROFILE_EYECANDY,
+    PROFILE_GAMEMODE_THINK,
+    PROFILE_MAP_UPDATE,
+
+    PROFILE_DRAW,
+    PROFILE_DRAW_BACK,
+    PROFILE_DRAW_MIDDLE,
+    PROFILE_DRAW_FRONT,
+    PROFILE_DRAW_SPOTLIGHTS,
+    PROFILE_DRAW_HUD,
+
+    PROFILE_LAST
+};
+
+//Microseconds from an arbitrary but fixed starting point
+typedef int64_t (*ProfilerClock)(void);
+
+//Per phase frame timings for finding out where a frame goes. Compiled in
+//everywhere and switched on at runtime; while it is off a scope costs one
+//branch. Each frame the time spent in every phase is summed, and the last
+//PROFILER_WINDOW frames that ran a phase make up its min/avg/max.
+class CFrameProfiler
+{
+    public:
+        struct PhaseStats {
+            int64_t iMin;
+            int64_t iAvg;
+            int64_t iMax;
+            int     iSamples;
+        };
+
+        CFrameProfiler();
+
+        void setEnabled(bool enabled);
+        bool isEnabled() const {
+            return fEnabled;
+        }
+
+        //Writes a report to the log every PROFILER_WINDOW frames
+        void setLogging(bool logging) {
+            fLogging = logging;
+        }
+
+        void setOverlay(bool overlay) {
+            fOverlay = overlay;
+        }
+        bool overlayEnabled() const {
+            return fEnabled && fOverlay;
+        }
+
+        //Lets the frontend supply a better timer, see RETRO_ENVIRONMENT_GET_PERF_INTERFACE
+        void setClock(ProfilerClock clock);
+
+        int64_t now() const {
+            return clockSource();
+        }
+
+        void beginFrame();
+        void endFrame();
+
+        void add(ProfilePhase phase, int64_t iMicroseconds);
+
+        void reset();
+
+        bool getStats(ProfilePhase phase, PhaseStats& stats) const;
+
+        //Same numbers over every frame since the last reset instead of the window
+        bool getRunStats(ProfilePhase phase, PhaseStats& stats) const;
+        static const char * phaseName(ProfilePhase phase);
+
+        void logReport() const;
+
+    private:
+        bool fEnabled;
+        bool fLogging;
+        bool fOverlay;
+
+        ProfilerClock clockSource;
+
+        int64_t iFrameTime[PROFILE_LAST];
+        bool    fRanThisFrame[PROFILE_LAST];
+
+        int64_t iSamples[PROFILE_LAST][PROFILER_WINDOW];
+        short   iSampleCount[PROFILE_LAST];
+        short   iNextSample[PROFILE_LAST];
+
+        int64_t iRunTotal[PROFILE_LAST];
+        int64_t iRunMin[PROFILE_LAST];
+        int64_t iRunMax[PROFILE_LAST];
+        int     iRunFrames[PROFILE_LAST];
+
+        int     iFramesSinceReport;
+};
+
+extern CFrameProfiler g_profiler;
+
+//Adds the time until the end of the enclosing block to a phase
+class CProfileScope
+{
+    public:
+        CProfileScope(ProfilePhase phase) {
+            iPhase = phase;
+            fActive = g_profiler.isEnabled();
+
+            if (fActive)
+                iStart = g_profiler.now();
+        }
+
+        ~CProfileScope() {
+            if (fActive)
+                g_profiler.add(iPhase, g_profiler.now() - iStart);
+        }
+
+    private:
+        ProfilePhase    iPhase;
+        bool            fActive;
+        int64_t         iStart;
+
+        CProfileScope(CProfileScope const&);
+        void operator=(CProfileScope const&);
+};
+
+#endif // FRAMEPROFILER_H
@@ -158,6 +158,7 @@ void CGameValues::init()
     teamcollision   = 0;
     screencrunch    = true;
     screenshaketimer  = 0;
+    screenshakeleft   = false;
     screenshakeplayerid = -1;
     screenshaketeamid = -1;
     toplayer      = true;
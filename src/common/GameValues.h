@@ -222,6 +222,7 @@ public:
     short		colorids[4];
 
     short		screenshaketimer;
+    bool		screenshakeleft;
     short		screenshakeplayerid;
     short		screenshaketeamid;
     bool		screenshakekillinair;
@@ -0,0 +1,101 @@
+#include "GameplayHeap.h"
+
+alignas(GAMEPLAYHEAP_GRANULARITY) static uint8_t objectpool[OBJECTHEAP_SIZE];
+alignas(GAMEPLAYHEAP_GRANULARITY) static uint8_t eyecandypool[EYECANDYHEAP_SIZE];
+alignas(GAMEPLAYHEAP_GRANULARITY) static uint8_t gameplaypool[GAMEPLAYHEAP_SIZE];
+
+CGameplayHeap g_objectheap(objectpool, OBJECTHEAP_SIZE);
+CGameplayHeap g_eyecandyheap(eyecandypool, EYECANDYHEAP_SIZE);
+CGameplayHeap g_gameplayheap(gameplaypool, GAMEPLAYHEAP_SIZE);
+
+//------------------------------------------------------------------------------
+// class gameplay heap
+//------------------------------------------------------------------------------
+CGameplayHeap::CGameplayHeap(uint8_t * buffer, size_t capacity)
+{
+    pool = buffer;
+    iCapacity = capacity;
+
+    for (short i = 0; i < GAMEPLAYHEAP_SIZECLASSES; i++)
+        freelist[i] = NULL;
+
+    iTop = 0;
+
+    iLiveCount = 0;
+    iPeakLiveCount = 0;
+    iAllocationCount = 0;
+    iOverflowCount = 0;
+    iOverflowAllocationCount = 0;
+}
+
+void * CGameplayHeap::allocate(size_t size)
+{
+    iAllocationCount++;
+
+    if (++iLiveCount > iPeakLiveCount)
+        iPeakLiveCount = iLiveCount;
+
+    //Size class n holds payloads of up to (n + 1) * granularity bytes
+    size_t iSizeClass = size == 0 ? 0 : (size - 1) / GAMEPLAYHEAP_GRANULARITY;
+
+    if (iSizeClass < GAMEPLAYHEAP_SIZECLASSES) {
+        FreeBlock * block = freelist[iSizeClass];
+
+        if (block) {
+            freelist[iSizeClass] = block->next;
+            return block;
+        }
+
+        size_t iBlockSize = sizeof(BlockHeader) + (iSizeClass + 1) * GAMEPLAYHEAP_GRANULARITY;
+
+        if (iTop + iBlockSize <= iCapacity) {
+            BlockHeader * header = (BlockHeader *)(pool + iTop);
+            header->iSizeClass = (uint32_t)iSizeClass;
+            iTop += iBlockSize;
+
+            return header + 1;
+        }
+    }
+
+    //Arena is full (or the request is too big to pool), let the system heap take it
+    iOverflowCount++;
+    iOverflowAllocationCount++;
+    return ::operator new(size);
+}
+
+void CGameplayHeap::release(void * ptr)
+{
+    if (!ptr)
+        return;
+
+    iLiveCount--;
+
+    if (!contains(ptr)) {
+        iOverflowCount--;
+        ::operator delete(ptr);
+        return;
+    }
+
+    BlockHeader * header = (BlockHeader *)ptr - 1;
+
+    FreeBlock * block = (FreeBlock *)ptr;
+    block->next = freelist[header->iSizeClass];
+    freelist[header->iSizeClass] = block;
+}
+
+bool CGameplayHeap::reset()
+{
+    if (iLiveCount > 0)
+        return false;
+
+    for (short i = 0; i < GAMEPLAYHEAP_SIZECLASSES; i++)
+        freelist[i] = NULL;
+
+    iTop = 0;
+
+    iPeakLiveCount = 0;
+    iAllocationCount = 0;
+    iOverflowAllocationCount = 0;
+
+    return true;
+}
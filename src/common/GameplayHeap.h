@@ -0,0 +1,174 @@
+#ifndef GAMEPLAYHEAP_H
+#define GAMEPLAYHEAP_H
+
+#include "GlobalConstants.h"
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GAMEPLAYHEAP_GRANULARITY    16
+#define GAMEPLAYHEAP_SIZECLASSES    256   //Largest pooled block is 4KB
+
+//Per slot budgets include the block header. The largest objects (shells,
+//flags, sledge brothers) are about 200 bytes, the largest eyecandy is an
+//announcement at 128 bytes plus its text.
+#define OBJECTHEAP_SLOTSIZE         256
+#define EYECANDYHEAP_SLOTSIZE       192
+
+//Objects live in the non colliding container and the three layered ones
+#define OBJECTHEAP_SIZE             (4 * MAXOBJECTS * OBJECTHEAP_SLOTSIZE)
+#define EYECANDYHEAP_SIZE           (3 * MAXEYECANDY * EYECANDYHEAP_SLOTSIZE)
+
+//Players, AI state, spotlights and whatever else a match creates
+#define GAMEPLAYHEAP_SIZE           (256 * 1024)
+
+//Fixed arena for things that are created and destroyed during a match. There
+//is one for objects, one for eyecandy and one for the rest, so the churn of
+//short lived eyecandy never fragments the object arena. Because all of it
+//lives in a few blocks of memory at fixed addresses, a save state can capture
+//the simulation with a straight copy instead of walking and rebuilding every
+//object graph.
+//
+//Freed blocks go to a free list per size class and are reused first, new ones
+//are cut from the top of the arena. Requests the arena can't serve fall back
+//to the system heap; save states refuse to run while any of those are alive.
+class CGameplayHeap
+{
+    public:
+        CGameplayHeap(uint8_t * buffer, size_t capacity);
+
+        void * allocate(size_t size);
+        void release(void * ptr);
+
+        //Drops every block at once. Only happens when nothing is alive, so a
+        //leak shows up as a failed reset instead of a dangling pointer.
+        bool reset();
+
+        bool contains(const void * ptr) const {
+            return (const uint8_t *)ptr >= pool && (const uint8_t *)ptr < pool + iCapacity;
+        }
+
+        size_t capacity() const {
+            return iCapacity;
+        }
+
+        //Bytes between the start of the arena and the high water mark
+        size_t used() const {
+            return iTop;
+        }
+
+        //Blocks currently handed out, from the arena or the system heap
+        unsigned int liveCount() const {
+            return iLiveCount;
+        }
+
+        unsigned int peakLiveCount() const {
+            return iPeakLiveCount;
+        }
+
+        //Allocations since the last reset
+        unsigned int allocationCount() const {
+            return iAllocationCount;
+        }
+
+        //Live blocks that were served by the system heap
+        unsigned int overflowCount() const {
+            return iOverflowCount;
+        }
+
+        //Allocations since the last reset that had to go to the system heap
+        unsigned int overflowAllocationCount() const {
+            return iOverflowAllocationCount;
+        }
+
+    private:
+        struct FreeBlock {
+            FreeBlock * next;
+        };
+
+        //Keeps the header a multiple of the granularity so payloads stay aligned
+        union BlockHeader {
+            uint32_t iSizeClass;
+            uint8_t  pad[GAMEPLAYHEAP_GRANULARITY];
+        };
+
+        FreeBlock *     freelist[GAMEPLAYHEAP_SIZECLASSES];
+        size_t          iTop;
+
+        unsigned int    iLiveCount;
+        unsigned int    iPeakLiveCount;
+        unsigned int    iAllocationCount;
+        unsigned int    iOverflowCount;
+        unsigned int    iOverflowAllocationCount;
+
+        uint8_t *       pool;
+        size_t          iCapacity;
+
+        CGameplayHeap(CGameplayHeap const&);
+        void operator=(CGameplayHeap const&);
+
+    friend class SaveState;
+};
+
+extern CGameplayHeap g_objectheap;
+extern CGameplayHeap g_eyecandyheap;
+extern CGameplayHeap g_gameplayheap;
+
+//STL allocator so containers owned by arena objects keep their nodes in the arena too
+template <class T>
+class GameplayHeapAllocator
+{
+    public:
+        typedef T           value_type;
+        typedef T *         pointer;
+        typedef const T *   const_pointer;
+        typedef T &         reference;
+        typedef const T &   const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        template <class U> struct rebind {
+            typedef GameplayHeapAllocator<U> other;
+        };
+
+        GameplayHeapAllocator() {}
+        template <class U> GameplayHeapAllocator(const GameplayHeapAllocator<U>&) {}
+
+        pointer address(reference value) const {
+            return &value;
+        }
+        const_pointer address(const_reference value) const {
+            return &value;
+        }
+
+        pointer allocate(size_type n, const void * = 0) {
+            return (pointer)g_gameplayheap.allocate(n * sizeof(T));
+        }
+        void deallocate(pointer p, size_type) {
+            g_gameplayheap.release(p);
+        }
+
+        size_type max_size() const {
+            return GAMEPLAYHEAP_SIZE / sizeof(T);
+        }
+
+        void construct(pointer p, const T& value) {
+            new ((void *)p) T(value);
+        }
+        void destroy(pointer p) {
+            p->~T();
+        }
+};
+
+template <class T, class U>
+bool operator == (const GameplayHeapAllocator<T>&, const GameplayHeapAllocator<U>&) {
+    return true;
+}
+
+template <class T, class U>
+bool operator != (const GameplayHeapAllocator<T>&, const GameplayHeapAllocator<U>&) {
+    return false;
+}
+
+#endif // GAMEPLAYHEAP_H
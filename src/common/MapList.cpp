@@ -1,6 +1,7 @@
 #include "MapList.h"
 
 #include "dirlist.h"
+#include "FileIO.h"
 #include "FileList.h"
 #include "GameValues.h"
 #include "linfunc.h"
@@ -13,6 +14,11 @@
 #include <iostream>
 #include <stdexcept>
 
+#ifdef SMW_HAVE_THREADS
+    #include <atomic>
+    #include <thread>
+#endif
+
 extern void libretro_printf(const char *fmt, ...);
 
 #ifdef __LIBRETRO__
@@ -34,11 +40,28 @@ extern void libretro_printf(const char *fmt, ...);
 #endif
 #endif
 
+//The libretro file layer only knows file sizes; read modification times
+//directly where the platform has stat()
+#if !defined(__LIBRETRO__) || defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+#define MAPLIST_FILE_TIMES
+#include <sys/stat.h>
+#endif
+
+#ifdef __LIBRETRO__
+    #include <file/file_path.h>
+#endif
+
+#define MAPSUMMARY_INDEX    "maps/cache/mapsummary.bin"
+#define MAPSUMMARY_MAGIC    0x534d5349     //"SMSI"
+#define MAPSUMMARY_VERSION  1
+#define MAPSUMMARY_THREADS  8           //Most threads used to read maps missing from the index
+
 using std::string;
 
 extern int32_t g_iVersion[];
 
-extern CMap* g_map;
+extern CResourceManager* rm;
+extern CTilesetManager* g_tilesetmanager;
 extern FiltersList* filterslist;
 extern CGameValues game_values;
 
@@ -53,6 +76,11 @@ MapListNode::MapListNode(std::string fullName)
     iIndex = 0;
 
     fReadFromCache = false;
+    fSummarized = false;
+
+    iFileSize = 0;
+    iFileTime = 0;
+    iContentHash = 0;
 
     iShortNameLength = strlen(stripCreatorAndDotMap(fullName).c_str());
 
@@ -484,6 +512,159 @@ void MapList::WriteFilters()
     }
 }
 
+struct MapSummary {
+    int32_t iFileSize;
+    int32_t iFileTime;
+    uint64_t iContentHash;
+    bool fFilters[NUM_AUTO_FILTERS];
+};
+
+//Maps are stored by their path below the maps directory, so the index
+//survives the data directory moving
+static std::string summaryName(const std::string& filename)
+{
+    std::string mapdir = convertPath("maps/");
+
+    if (filename.compare(0, mapdir.size(), mapdir) == 0)
+        return filename.substr(mapdir.size());
+
+    return filename;
+}
+
+static void getMapFileInfo(const std::string& filename, int32_t& iSize, int32_t& iTime)
+{
+    iSize = -1;
+    iTime = 0;
+
+#ifdef MAPLIST_FILE_TIMES
+    struct stat fileinfo;
+
+    if (stat(filename.c_str(), &fileinfo) == 0) {
+        iSize = (int32_t)fileinfo.st_size;
+        iTime = (int32_t)fileinfo.st_mtime;
+        return;
+    }
+#endif
+
+#ifdef __LIBRETRO__
+    iSize = path_get_size(filename.c_str());
+#endif
+}
+
+//Reads the auto filters from the map file itself and remembers which version of the file they came from
+void MapList::summarizeMap(CMap * map, MapListNode * mln)
+{
+    getMapFileInfo(mln->filename, mln->iFileSize, mln->iFileTime);
+    mln->iContentHash = File_Hash(mln->filename);
+
+    //The map is reused for many files, so nothing may be left over from the last one
+    memset(mln->pfFilters, 0, sizeof(bool) * NUM_AUTO_FILTERS);
+    memset(map->fAutoFilter, 0, sizeof(bool) * NUM_AUTO_FILTERS);
+    mln->fSummarized = false;
+
+    //A broken map keeps its filters cleared rather than taking the scan down
+    try {
+        if (!map->loadMap(mln->filename, read_type_summary))
+            return;
+    } catch (std::exception const&) {
+        return;
+    }
+
+    memcpy(mln->pfFilters, map->fAutoFilter, sizeof(bool) * NUM_AUTO_FILTERS);
+    mln->fSummarized = true;
+}
+
+//Reads the maps on as many threads as there are cores. Each thread has a map
+//of its own and writes only to the nodes it took, so nothing is locked.
+void MapList::summarizeMaps(const std::vector<MapListNode*>& nodes)
+{
+    if (nodes.empty())
+        return;
+
+#ifdef SMW_HAVE_THREADS
+    size_t iThreads = std::thread::hardware_concurrency();
+
+    if (iThreads < 1)
+        iThreads = 1;
+    if (iThreads > MAPSUMMARY_THREADS)
+        iThreads = MAPSUMMARY_THREADS;
+    if (iThreads > nodes.size())
+        iThreads = nodes.size();
+
+    std::atomic<size_t> iNextNode(0);
+
+    auto scan = [&nodes, &iNextNode]() {
+        CMap * summarymap = new CMap(rm, g_tilesetmanager);
+
+        size_t iNode;
+        while ((iNode = iNextNode++) < nodes.size())
+            summarizeMap(summarymap, nodes[iNode]);
+
+        delete summarymap;
+    };
+
+    //The calling thread takes a share too
+    std::vector<std::thread> threads;
+    for (size_t iThread = 1; iThread < iThreads; iThread++)
+        threads.push_back(std::thread(scan));
+
+    scan();
+
+    for (size_t iThread = 0; iThread < threads.size(); iThread++)
+        threads[iThread].join();
+#else
+    CMap * summarymap = new CMap(rm, g_tilesetmanager);
+
+    for (size_t iNode = 0; iNode < nodes.size(); iNode++)
+        summarizeMap(summarymap, nodes[iNode]);
+
+    delete summarymap;
+#endif
+}
+
+static bool readMapSummaryIndex(std::map<std::string, MapSummary>& summaries)
+{
+    BinaryFile index(convertPath(MAPSUMMARY_INDEX).c_str(), "rb");
+
+    if (!index.is_open())
+        return false;
+
+    try {
+        if (index.read_i32() != MAPSUMMARY_MAGIC || index.read_i32() != MAPSUMMARY_VERSION || index.read_i32() != NUM_AUTO_FILTERS)
+            return false;
+
+        int32_t iCount = index.read_i32();
+
+        for (int32_t iMap = 0; iMap < iCount; iMap++) {
+            char szName[256];
+            index.read_string(szName, sizeof(szName));
+
+            MapSummary summary;
+            summary.iFileSize = index.read_i32();
+            summary.iFileTime = index.read_i32();
+
+            uint32_t iHashHigh = (uint32_t)index.read_i32();
+            uint32_t iHashLow = (uint32_t)index.read_i32();
+            summary.iContentHash = ((uint64_t)iHashHigh << 32) | iHashLow;
+
+            uint8_t iBits = 0;
+            for (short iFilter = 0; iFilter < NUM_AUTO_FILTERS; iFilter++) {
+                if ((iFilter & 7) == 0)
+                    iBits = index.read_u8();
+
+                summary.fFilters[iFilter] = (iBits & (1 << (iFilter & 7))) != 0;
+            }
+
+            summaries[szName] = summary;
+        }
+    } catch (std::exception const&) {
+        summaries.clear();
+        return false;
+    }
+
+    return true;
+}
+
 void MapList::ReadFilters()
 {
     char buffer[256];
@@ -491,45 +672,55 @@ void MapList::ReadFilters()
     //Get auto filters from maps
     current = maps.begin();
 
-    //Used cached summary before trying to read the actual map file (to speed up load time)
-    FILE * mfp = fopen(convertPath("maps/cache/mapsummary.txt").c_str(), "r");
-
-    if (mfp) {
-        while (fgets(buffer, 256, mfp)) {
-            char * pszMapName = strtok(buffer, ",\n");
-            MapListNode * node = maps.find(pszMapName)->second;
-
-            if (maps.find(pszMapName) != maps.end()) {
-                bool fErrorReading = false;
-                for (short iFilter = 0; iFilter < NUM_AUTO_FILTERS; iFilter++) {
-                    char * psz = strtok(NULL, ",\n");
-
-                    if (psz) {
-                        node->pfFilters[iFilter] = strcmp(psz, "0") != 0;
-                    } else {
-                        fErrorReading = true;
-                        break;
-                    }
-                }
+    //Use the summary index before trying to read the actual map files (to speed up load time)
+    std::map<std::string, MapSummary> summaries;
+    bool fIndexChanged = !readMapSummaryIndex(summaries);
+    size_t iIndexedMaps = 0;
 
-                if (!fErrorReading)
-                    node->fReadFromCache = true;
+    //Maps that aren't in the index, or changed since, are read afterwards all at once
+    std::vector<MapListNode*> unsummarized;
+
+    while (current != maps.end()) {
+        MapListNode * mln = current->second;
+        std::map<std::string, MapSummary>::iterator summary = summaries.find(summaryName(mln->filename));
+
+        int32_t iSize, iTime;
+        getMapFileInfo(mln->filename, iSize, iTime);
+
+        bool fUpToDate = false;
+        if (summary != summaries.end() && iSize >= 0 && summary->second.iFileSize == iSize) {
+            iIndexedMaps++;
+
+            if (summary->second.iFileTime == iTime) {
+                fUpToDate = true;
+            } else if (File_Hash(mln->filename) == summary->second.iContentHash) {
+                //Copied or touched, but the same map
+                fUpToDate = true;
+                fIndexChanged = true;
             }
         }
 
-        fclose(mfp);
-    }
-
-    while (current != maps.end()) {
-        if (!current->second->fReadFromCache) {
-            MapListNode * mln = current->second;
-            g_map->loadMap(mln->filename, read_type_summary);
-            memcpy(mln->pfFilters, g_map->fAutoFilter, sizeof(bool) * NUM_AUTO_FILTERS);
+        if (fUpToDate) {
+            memcpy(mln->pfFilters, summary->second.fFilters, sizeof(bool) * NUM_AUTO_FILTERS);
+            mln->iFileSize = iSize;
+            mln->iFileTime = iTime;
+            mln->iContentHash = summary->second.iContentHash;
+            mln->fReadFromCache = true;
+            mln->fSummarized = true;
+        } else {
+            unsummarized.push_back(mln);
+            fIndexChanged = true;
         }
 
         current++;
     }
 
+    summarizeMaps(unsummarized);
+
+    //Maps were added, changed or removed since the index was written
+    if (fIndexChanged || iIndexedMaps != summaries.size())
+        WriteMapSummaryCache();
+
     current = maps.begin();
     //Get user defined filters from files in filters directory
     for (short iFilter = 0; iFilter < filterslist->GetCount(); iFilter++) {
@@ -588,39 +779,70 @@ void MapList::ReadFilters()
 void MapList::ReloadMapAutoFilters()
 {
     std::multimap<std::string, MapListNode*>::iterator itr = maps.begin(), lim = maps.end();
+    std::vector<MapListNode*> nodes;
 
     while (itr != lim) {
-        MapListNode * mln = itr->second;
-        g_map->loadMap(mln->filename, read_type_summary);
-        memcpy(mln->pfFilters, g_map->fAutoFilter, sizeof(bool) * NUM_AUTO_FILTERS);
-
+        nodes.push_back(itr->second);
         itr++;
     }
+
+    summarizeMaps(nodes);
 }
 
 void MapList::WriteMapSummaryCache()
 {
-    FILE * fp = fopen(convertPath("maps/cache/mapsummary.txt").c_str(), "w");
+    std::multimap<std::string, MapListNode*>::iterator itr, lim = maps.end();
+
+    //Names that don't fit a short string are left out and read from the map every time,
+    //as are maps that couldn't be read
+    int32_t iCount = 0;
+    for (itr = maps.begin(); itr != lim; itr++) {
+        if (itr->second->fSummarized && summaryName(itr->second->filename).length() < 254)
+            iCount++;
+    }
 
-    if (!fp)
-        return;
+    try {
+        BinaryFile index(convertPath(MAPSUMMARY_INDEX).c_str(), "wb");
 
-    std::multimap<std::string, MapListNode*>::iterator itr = maps.begin(), lim = maps.end();
+        if (!index.is_open())
+            return;
 
-    while (itr != lim) {
-        fprintf(fp, "%s", itr->first.c_str());
+        index.write_i32(MAPSUMMARY_MAGIC);
+        index.write_i32(MAPSUMMARY_VERSION);
+        index.write_i32(NUM_AUTO_FILTERS);
+        index.write_i32(iCount);
 
-        for (short iFilter = 0; iFilter < NUM_AUTO_FILTERS; iFilter++)
-            fprintf(fp, ",%d", itr->second->pfFilters[iFilter]);
+        for (itr = maps.begin(); itr != lim; itr++) {
+            MapListNode * mln = itr->second;
+            std::string name = summaryName(mln->filename);
 
-        fprintf(fp, "\n");
-        itr++;
-    }
+            if (!mln->fSummarized || name.length() >= 254)
+                continue;
+
+            index.write_string(name.c_str());
+            index.write_i32(mln->iFileSize);
+            index.write_i32(mln->iFileTime);
+            index.write_i32((int32_t)(uint32_t)(mln->iContentHash >> 32));
+            index.write_i32((int32_t)(uint32_t)mln->iContentHash);
 
-    fclose(fp);
+            uint8_t iBits = 0;
+            for (short iFilter = 0; iFilter < NUM_AUTO_FILTERS; iFilter++) {
+                if (mln->pfFilters[iFilter])
+                    iBits |= 1 << (iFilter & 7);
+
+                if ((iFilter & 7) == 7 || iFilter == NUM_AUTO_FILTERS - 1) {
+                    index.write_u8(iBits);
+                    iBits = 0;
+                }
+            }
+        }
+    } catch (std::exception const& error) {
+        libretro_printf("[maplist] Couldn't write the map summary index: %s\n", error.what());
+        return;
+    }
 
 #if defined(__APPLE__) && !defined(__LIBRETRO__)
-    chmod(convertPath("maps/cache/mapsummary.txt").c_str(), S_IRWXU | S_IRWXG | S_IROTH);
+    chmod(convertPath(MAPSUMMARY_INDEX).c_str(), S_IRWXU | S_IRWXG | S_IROTH);
 #endif
 }
 
@@ -2,7 +2,11 @@
 #define MAPLIST_H
 
 #include <map>
+#include <stdint.h>
 #include <string>
+#include <vector>
+
+class CMap;
 
 class MapListNode
 {
@@ -20,6 +24,15 @@ class MapListNode
 
 		bool fReadFromCache;
 
+		//Whether the auto filters came from the index or the map file, a map
+		//that couldn't be read isn't written to the index
+		bool fSummarized;
+
+		//What the map file looked like when its auto filters were read
+		int32_t iFileSize;
+		int32_t iFileTime;
+		uint64_t iContentHash;
+
 		bool fValid;
 };
 
@@ -115,6 +128,9 @@ class MapList
 
     private:
 
+		static void summarizeMap(CMap * map, MapListNode * mln);
+		static void summarizeMaps(const std::vector<MapListNode*>& nodes);
+
         std::multimap<std::string, MapListNode*> maps;
 		std::multimap<std::string, MapListNode*> worldmaps;
 
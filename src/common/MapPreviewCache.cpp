@@ -0,0 +1,189 @@
+#include "MapPreviewCache.h"
+
+#include "FileList.h"
+#include "Game.h"
+#include "GameValues.h"
+#include "map.h"
+#include "MapThumbnails.h"
+#include "path.h"
+
+#include "SDL_image.h"
+
+#include <cstdio>
+
+extern void libretro_printf(const char *fmt, ...);
+
+extern CGameValues game_values;
+extern CGame* smw;
+extern CResourceManager* rm;
+extern CTilesetManager* g_tilesetmanager;
+extern GraphicsList *gamegraphicspacklist;
+
+CMapPreviewCache g_mappreviews;
+
+MapPreview::MapPreview()
+{
+    fTopLayer = false;
+
+    map = NULL;
+    background = NULL;
+    blocklayer = NULL;
+    foreground = NULL;
+}
+
+MapPreview::~MapPreview()
+{
+    delete map;
+
+    if (background)
+        SDL_FreeSurface(background);
+    if (blocklayer)
+        SDL_FreeSurface(blocklayer);
+    if (foreground)
+        SDL_FreeSurface(foreground);
+}
+
+CMapPreviewCache::CMapPreviewCache()
+{}
+
+CMapPreviewCache::~CMapPreviewCache()
+{
+    clear();
+}
+
+MapPreviewPtr CMapPreviewCache::find(const std::string& path)
+{
+    std::list<MapPreviewPtr>::iterator itr = previews.begin(), lim = previews.end();
+
+    while (itr != lim) {
+        if ((*itr)->path == path && (*itr)->fTopLayer == game_values.toplayer) {
+            previews.splice(previews.begin(), previews, itr);
+            return previews.front();
+        }
+
+        ++itr;
+    }
+
+    return MapPreviewPtr();
+}
+
+void CMapPreviewCache::request(const std::string& path)
+{
+    if (path == sLoading || find(path))
+        return;
+
+    if (worker.pending() > 0) {
+        sNext = path;
+        return;
+    }
+
+    sNext.clear();
+    start(path);
+}
+
+void CMapPreviewCache::update()
+{
+    worker.pump();
+
+    if (worker.pending() > 0 || sNext.empty())
+        return;
+
+    std::string sPath;
+    sPath.swap(sNext);
+
+    if (!find(sPath))
+        start(sPath);
+}
+
+void CMapPreviewCache::cancel()
+{
+    worker.cancel();
+
+    sLoading.clear();
+    sNext.clear();
+}
+
+void CMapPreviewCache::clear()
+{
+    cancel();
+    previews.clear();
+}
+
+void CMapPreviewCache::start(const std::string& path)
+{
+    MapPreviewPtr preview(new MapPreview());
+    preview->path = path;
+    preview->map = new CMap(rm, g_tilesetmanager);
+    preview->fTopLayer = game_values.toplayer;
+
+    sLoading = path;
+
+    worker.push([preview]() {
+        load(preview.get());
+    }, [this, preview]() {
+        finish(preview);
+    });
+}
+
+//Draws the map into the layers on the main thread, the worker only loaded it
+void CMapPreviewCache::finish(MapPreviewPtr preview)
+{
+    if (preview->path == sLoading)
+        sLoading.clear();
+
+    CMap * map = preview->map;
+    preview->fTopLayer = game_values.toplayer;
+
+    map->preDrawPreviewPlatforms();
+    map->preDrawPreviewBackground(preview->background, false);
+    map->preDrawPreviewBlocks(preview->blocklayer, false);
+    map->preDrawPreviewMapItems(preview->background, false);
+    map->preDrawPreviewForeground(preview->foreground, false);
+    map->preDrawPreviewWarps(preview->fTopLayer ? preview->foreground : preview->background, false);
+
+    previews.push_front(preview);
+
+    while (previews.size() > MAPPREVIEWCACHE_SIZE)
+        previews.pop_back();
+}
+
+//Runs on the worker. Loads the map and scales its background, which only
+//touches surfaces of the preview's own. Platform tiles are drawn by finish().
+void CMapPreviewCache::load(MapPreview * preview)
+{
+    CMap * map = preview->map;
+
+    WorkerLock lock(g_maploadmutex);
+
+    map->loadMap(preview->path, read_type_preview);
+
+    short iWidth = smw->ScreenWidth / 2;
+    short iHeight = smw->ScreenHeight / 2;
+
+    preview->background = SDL_CreateRGBSurface(0, iWidth, iHeight, 16, 0, 0, 0, 0);
+    preview->blocklayer = SDL_CreateRGBSurface(0, iWidth, iHeight, 16, 0, 0, 0, 0);
+    preview->foreground = SDL_CreateRGBSurface(0, iWidth, iHeight, 16, 0, 0, 0, 0);
+
+    //Same lookup as LoadCurrentMapBackground(), without touching rm->spr_background
+    char szBackgroundFile[256];
+    sprintf(szBackgroundFile, "gfx/packs/backgrounds/%s", map->szBackgroundFile);
+    std::string sBackground = convertPath(szBackgroundFile, gamegraphicspacklist->current_name());
+
+    if (!File_Exists(sBackground))
+        sBackground = convertPath("gfx/packs/backgrounds/Land_Classic.png", gamegraphicspacklist->current_name());
+
+    SDL_Surface * temp = IMG_Load(sBackground.c_str());
+    SDL_Surface * background = NULL;
+
+    if (temp) {
+        background = SDL_DisplayFormat(temp);
+        SDL_FreeSurface(temp);
+    }
+
+    if (background) {
+        map->scalePreviewBackground(background, preview->background, false);
+        SDL_FreeSurface(background);
+    } else {
+        libretro_printf("ERROR: Couldn't load preview background: %s\n", sBackground.c_str());
+    }
+}
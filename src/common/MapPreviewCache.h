@@ -0,0 +1,81 @@
+#ifndef MAPPREVIEWCACHE_H
+#define MAPPREVIEWCACHE_H
+
+#include "WorkerThread.h"
+
+#include "SDL.h"
+
+#include <list>
+#include <memory>
+#include <string>
+
+class CMap;
+
+#define MAPPREVIEWCACHE_SIZE    6   //Previews kept for going back and forth in the map list
+
+//A map loaded for the menu preview together with its prerendered layers. It
+//owns its CMap, so the platforms and hazards of the preview come from here
+//and not from g_map.
+struct MapPreview {
+    MapPreview();
+    ~MapPreview();
+
+    std::string path;
+    bool fTopLayer;
+
+    CMap * map;
+    SDL_Surface * background;
+    SDL_Surface * blocklayer;
+    SDL_Surface * foreground;
+
+private:
+    MapPreview(MapPreview const&);
+    void operator=(MapPreview const&);
+};
+
+typedef std::shared_ptr<MapPreview> MapPreviewPtr;
+
+//Recently shown map previews, most recent first. Missing ones are loaded on
+//the worker thread and drawn on the main thread once they're back, because
+//drawing them blits from the shared tileset and sprite surfaces. Controls keep
+//a reference to the preview they show, so one that falls out of the cache
+//stays alive until it's replaced.
+//
+//cancel() drops previews that would be drawn with graphics that are about to
+//change (starting a game, reloading graphics).
+class CMapPreviewCache
+{
+    public:
+        CMapPreviewCache();
+        ~CMapPreviewCache();
+
+        //The preview of a map if it's ready, which also marks it as recently used
+        MapPreviewPtr find(const std::string& path);
+
+        //Loads a map on the worker. While one is loading only the latest request
+        //is kept, so scrolling through the list only loads where it stops.
+        void request(const std::string& path);
+
+        //Collects a finished preview and starts the next request, once a frame
+        void update();
+
+        void cancel();
+        void clear();
+
+    private:
+        void start(const std::string& path);
+        void finish(MapPreviewPtr preview);
+
+        static void load(MapPreview * preview);
+
+        std::list<MapPreviewPtr> previews;
+
+        std::string sLoading;
+        std::string sNext;
+
+        CWorkerThread worker;
+};
+
+extern CMapPreviewCache g_mappreviews;
+
+#endif // MAPPREVIEWCACHE_H
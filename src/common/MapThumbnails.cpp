@@ -0,0 +1,243 @@
+#include "MapThumbnails.h"
+
+#include "map.h"
+#include "path.h"
+
+#include "SDL_image.h"
+
+#include <cstring>
+#include <memory>
+
+extern CResourceManager* rm;
+extern CTilesetManager* g_tilesetmanager;
+
+WorkerMutex g_maploadmutex;
+
+CMapThumbnails::Job::Job()
+{
+    map = NULL;
+    surface = NULL;
+    fDrawn = false;
+}
+
+CMapThumbnails::Job::~Job()
+{
+    if (surface)
+        SDL_FreeSurface(surface);
+}
+
+CMapThumbnails::CMapThumbnails()
+{
+    fCancelling = false;
+}
+
+CMapThumbnails::~CMapThumbnails()
+{
+    clear();
+
+    for (size_t iMap = 0; iMap < maps.size(); iMap++)
+        delete maps[iMap];
+
+    maps.clear();
+    freemaps.clear();
+}
+
+std::string CMapThumbnails::thumbnailPath(const std::string& mapfile)
+{
+    char szThumbnail[256];
+    strcpy(szThumbnail, "maps/cache/");
+    char * pszThumbnail = szThumbnail + strlen(szThumbnail);
+    GetNameFromFileName(pszThumbnail, mapfile.c_str());
+
+#ifdef PNG_SAVE_FORMAT
+    strcat(szThumbnail, ".png");
+#else
+    strcat(szThumbnail, ".bmp");
+#endif
+
+    return convertPath(szThumbnail);
+}
+
+void CMapThumbnails::want(const std::vector<std::string>& mapfiles)
+{
+    wanted = mapfiles;
+
+    std::map<std::string, Thumbnail>::iterator itr = thumbnails.begin(), lim = thumbnails.end();
+    while (itr != lim) {
+        itr->second.fWanted = false;
+        ++itr;
+    }
+
+    for (size_t iMap = 0; iMap < wanted.size(); iMap++)
+        thumbnails[wanted[iMap]].fWanted = true;
+
+    //Ones still being made are dropped when they come back
+    itr = thumbnails.begin();
+    while (itr != lim) {
+        if (itr->second.fWanted || itr->second.fPending) {
+            ++itr;
+            continue;
+        }
+
+        if (itr->second.surface)
+            SDL_FreeSurface(itr->second.surface);
+
+        thumbnails.erase(itr++);
+    }
+}
+
+void CMapThumbnails::update()
+{
+    worker.pump();
+
+    for (size_t iMap = 0; iMap < wanted.size() && worker.pending() < THUMBNAILS_IN_FLIGHT; iMap++) {
+        Thumbnail& thumbnail = thumbnails[wanted[iMap]];
+
+        if (thumbnail.surface || thumbnail.fPending || thumbnail.fFailed)
+            continue;
+
+        start(wanted[iMap]);
+    }
+}
+
+SDL_Surface * CMapThumbnails::get(const std::string& mapfile) const
+{
+    std::map<std::string, Thumbnail>::const_iterator itr = thumbnails.find(mapfile);
+
+    if (itr == thumbnails.end())
+        return NULL;
+
+    return itr->second.surface;
+}
+
+void CMapThumbnails::cancel()
+{
+    //Jobs that already loaded their map end here instead of going on to the save
+    fCancelling = true;
+    worker.cancel();
+    fCancelling = false;
+
+    //Nothing is in flight anymore, including the jobs that were dropped
+    freemaps = maps;
+
+    //Whatever is still marked pending was dropped before it started
+    std::map<std::string, Thumbnail>::iterator itr = thumbnails.begin(), lim = thumbnails.end();
+    while (itr != lim) {
+        itr->second.fPending = false;
+        ++itr;
+    }
+}
+
+void CMapThumbnails::clear()
+{
+    cancel();
+
+    std::map<std::string, Thumbnail>::iterator itr = thumbnails.begin(), lim = thumbnails.end();
+    while (itr != lim) {
+        if (itr->second.surface)
+            SDL_FreeSurface(itr->second.surface);
+
+        ++itr;
+    }
+
+    thumbnails.clear();
+    wanted.clear();
+}
+
+void CMapThumbnails::start(const std::string& mapfile)
+{
+    if (freemaps.empty()) {
+        maps.push_back(new CMap(rm, g_tilesetmanager));
+        freemaps.push_back(maps.back());
+    }
+
+    thumbnails[mapfile].fPending = true;
+
+    JobPtr job(new Job());
+    job->mapfile = mapfile;
+    job->map = freemaps.back();
+    freemaps.pop_back();
+
+    worker.push([job]() {
+        load(job.get());
+    }, [this, job]() {
+        loaded(job);
+    });
+}
+
+//Draws a freshly made thumbnail on the main thread and sends it back to be saved
+void CMapThumbnails::loaded(JobPtr job)
+{
+    if (job->fDrawn || !job->surface || fCancelling) {
+        finish(job);
+        return;
+    }
+
+    job->map->drawThumbnail(job->surface);
+    job->fDrawn = true;
+
+    freemaps.push_back(job->map);
+    job->map = NULL;
+
+    worker.push([job]() {
+        save(job.get());
+    }, [this, job]() {
+        finish(job);
+    });
+}
+
+void CMapThumbnails::finish(JobPtr job)
+{
+    if (job->map) {
+        freemaps.push_back(job->map);
+        job->map = NULL;
+    }
+
+    std::map<std::string, Thumbnail>::iterator itr = thumbnails.find(job->mapfile);
+
+    //Cancelled before it was drawn, it's made again when it's still wanted
+    if (!job->fDrawn && job->surface) {
+        if (itr != thumbnails.end())
+            itr->second.fPending = false;
+
+        return;
+    }
+
+    if (itr == thumbnails.end() || !itr->second.fWanted) {
+        if (itr != thumbnails.end())
+            thumbnails.erase(itr);
+
+        return;
+    }
+
+    itr->second.surface = job->surface;
+    itr->second.fPending = false;
+    itr->second.fFailed = job->surface == NULL;
+
+    job->surface = NULL;
+}
+
+//Runs on the worker. Loads the saved thumbnail, or the map and the background
+//a new one gets drawn on. The preview read leaves the platform tiles undrawn,
+//which thumbnails don't show anyway.
+void CMapThumbnails::load(Job * job)
+{
+    std::string sThumbnail = thumbnailPath(job->mapfile);
+
+    if (File_Exists(sThumbnail)) {
+        job->surface = IMG_Load(sThumbnail.c_str());
+        job->fDrawn = true;
+        return;
+    }
+
+    WorkerLock lock(g_maploadmutex);
+
+    job->map->loadMap(job->mapfile, read_type_preview);
+    job->surface = job->map->createThumbnailBackground(false);
+}
+
+//Runs on the worker
+void CMapThumbnails::save(Job * job)
+{
+    CMap::saveThumbnailSurface(job->surface, thumbnailPath(job->mapfile));
+}
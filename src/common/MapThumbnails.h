@@ -0,0 +1,91 @@
+#ifndef MAPTHUMBNAILS_H
+#define MAPTHUMBNAILS_H
+
+#include "WorkerThread.h"
+
+#include "SDL.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CMap;
+
+#define THUMBNAILS_IN_FLIGHT    2   //Keeps the worker busy while a finished one waits for pump
+
+//Held while a worker loads a map, so the thumbnail and the map preview workers
+//never do it at the same time
+extern WorkerMutex g_maploadmutex;
+
+//Loads map thumbnails for the map browser, writing the ones missing from
+//maps/cache/ first. The worker reads and writes the files and loads each map
+//into a CMap of its own. Drawing the map blits from the shared tileset and
+//sprite surfaces, and SDL changes a surface it blits from, so that part runs
+//on the main thread between loading the map and saving the thumbnail.
+class CMapThumbnails
+{
+    public:
+        CMapThumbnails();
+        ~CMapThumbnails();
+
+        //Maps whose thumbnails should be loaded, most urgent first. Thumbnails
+        //of maps that are no longer on the list are freed.
+        void want(const std::vector<std::string>& mapfiles);
+
+        //Collects finished thumbnails and starts the next ones, once a frame
+        void update();
+
+        //The thumbnail of a wanted map, NULL while it's still being made
+        SDL_Surface * get(const std::string& mapfile) const;
+
+        void cancel();
+        void clear();
+
+        static std::string thumbnailPath(const std::string& mapfile);
+
+    private:
+        struct Thumbnail {
+            SDL_Surface * surface;
+            bool fWanted;
+            bool fPending;
+            bool fFailed;
+        };
+
+        //One thumbnail on its way through the worker. A surface that was
+        //never handed over is freed with the job.
+        struct Job {
+            Job();
+            ~Job();
+
+            std::string mapfile;
+            CMap * map;
+            SDL_Surface * surface;
+            bool fDrawn;
+        };
+
+        typedef std::shared_ptr<Job> JobPtr;
+
+        void start(const std::string& mapfile);
+        void loaded(JobPtr job);
+        void finish(JobPtr job);
+
+        //On the worker
+        static void load(Job * job);
+        static void save(Job * job);
+
+        std::map<std::string, Thumbnail> thumbnails;
+        std::vector<std::string> wanted;
+
+        //One map for each job that can be in flight, all free between jobs
+        std::vector<CMap *> maps;
+        std::vector<CMap *> freemaps;
+
+        CWorkerThread worker;
+        bool fCancelling;
+
+        CMapThumbnails(CMapThumbnails const&);
+        void operator=(CMapThumbnails const&);
+};
+
+#endif // MAPTHUMBNAILS_H
@@ -0,0 +1,351 @@
+#include "MusicStream.h"
+
+#ifdef SDL2_USE_MIXERX
+  #include "SDL_mixer_ext.h"
+#else
+  #include "SDL_mixer.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef __LIBRETRO__
+    #include <streams/file_stream_transforms.h>
+#endif
+
+extern void libretro_printf(const char *fmt, ...);
+
+CMusicStream g_musicstream;
+
+//Without threads a decode job runs on the main thread at the next pump, so
+//it only decodes about a frame's worth of music instead of filling the buffer
+#ifdef SMW_HAVE_THREADS
+    #define MUSICSTREAM_JOB_READS   0   //Until the buffer is full
+#else
+    #define MUSICSTREAM_JOB_READS   2
+#endif
+
+#ifdef OGG_MUSIC
+static size_t stream_read(void * ptr, size_t size, size_t nmemb, void * datasource)
+{
+    return fread(ptr, size, nmemb, (FILE *)datasource);
+}
+
+static int stream_seek(void * datasource, ogg_int64_t offset, int whence)
+{
+    return fseek((FILE *)datasource, (long)offset, whence);
+}
+
+static int stream_close(void * datasource)
+{
+    return fclose((FILE *)datasource);
+}
+
+static long stream_tell(void * datasource)
+{
+    return ftell((FILE *)datasource);
+}
+
+static const ov_callbacks stream_callbacks = {stream_read, stream_seek, stream_close, stream_tell};
+#endif
+
+CMusicStream::CMusicStream() :
+    buffer(MUSICSTREAM_BUFFER_SIZE)
+{
+    fOpen = false;
+    iSection = 0;
+    memset(&cvt, 0, sizeof(cvt));
+
+    iFrequency = 0;
+    iFormat = 0;
+    iChannels = 0;
+
+    fLoop = false;
+    fEnded = false;
+    fDrained = false;
+    fStarted = false;
+
+    fPaused = false;
+    iVolume = MIX_MAX_VOLUME;
+
+    fPlaying = false;
+    finishedHook = NULL;
+
+    iTrackUnderruns = 0;
+    iTotalUnderruns = 0;
+}
+
+CMusicStream::~CMusicStream()
+{
+    //The mixer is gone by now, sfx_close() stopped the music before closing it
+    worker.cancel();
+    close();
+}
+
+bool CMusicStream::canPlay(const std::string& filename)
+{
+#ifdef OGG_MUSIC
+    int iFrequency, iChannels;
+    Uint16 iFormat;
+
+    //The hook scales the volume itself and only knows 16 bit samples
+    if (!Mix_QuerySpec(&iFrequency, &iFormat, &iChannels) || iFormat != AUDIO_S16SYS)
+        return false;
+
+    FILE * fp = fopen(filename.c_str(), "rb");
+
+    if (!fp)
+        return false;
+
+    //Only reads the headers
+    OggVorbis_File test;
+    if (ov_test_callbacks(fp, &test, NULL, 0, stream_callbacks) < 0) {
+        fclose(fp);
+        return false;
+    }
+
+    ov_clear(&test);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CMusicStream::play(const std::string& filename, bool fPlayonce)
+{
+    stop();
+
+    if (!Mix_QuerySpec(&iFrequency, &iFormat, &iChannels))
+        return;
+
+    this->filename = filename;
+    fLoop = !fPlayonce;
+
+    fEnded = false;
+    fDrained = false;
+    fStarted = false;
+    fPaused = false;
+    iTrackUnderruns = 0;
+
+    fPlaying = true;
+
+    worker.push([this]() { decode(MUSICSTREAM_JOB_READS); }, WorkerJob());
+
+#ifndef SMW_HAVE_THREADS
+    //Without a worker the first part is decoded right away, so the track
+    //doesn't start with an underrun
+    worker.pump();
+#endif
+
+    Mix_HookMusic(&CMusicStream::mix, this);
+}
+
+void CMusicStream::stop()
+{
+    if (!fPlaying)
+        return;
+
+    Mix_HookMusic(NULL, NULL);
+
+    worker.cancel();
+    close();
+    buffer.clear();
+
+    fPlaying = false;
+
+    if (iTrackUnderruns > 0)
+        libretro_printf("[music] %s ran out of decoded music %u times\n", filename.c_str(), (unsigned int)iTrackUnderruns);
+}
+
+void CMusicStream::setPaused(bool paused)
+{
+    SDL_LockAudio();
+    fPaused = paused;
+    SDL_UnlockAudio();
+}
+
+void CMusicStream::setVolume(int volume)
+{
+    if (volume < 0)
+        volume = 0;
+    else if (volume > MIX_MAX_VOLUME)
+        volume = MIX_MAX_VOLUME;
+
+    SDL_LockAudio();
+    iVolume = volume;
+    SDL_UnlockAudio();
+}
+
+void CMusicStream::update()
+{
+    if (!fPlaying)
+        return;
+
+    worker.pump();
+
+    if (fDrained) {
+        stop();
+
+        if (finishedHook)
+            finishedHook();
+
+        return;
+    }
+
+    //One job at a time, each decodes until the buffer is full or it did its reads
+    if (worker.pending() == 0 && !fEnded && buffer.writable() >= buffer.capacity() / 4)
+        worker.push([this]() { decode(MUSICSTREAM_JOB_READS); }, WorkerJob());
+}
+
+void CMusicStream::mix(void * udata, Uint8 * stream, int len)
+{
+    CMusicStream * music = (CMusicStream *)udata;
+
+    if (music->fPaused || music->fDrained) {
+        memset(stream, 0, len);
+        return;
+    }
+
+    size_t iRead = music->buffer.read(stream, len);
+
+    if (music->iVolume < MIX_MAX_VOLUME) {
+        Sint16 * samples = (Sint16 *)stream;
+
+        for (size_t iSample = 0; iSample < iRead / sizeof(Sint16); iSample++)
+            samples[iSample] = (Sint16)(samples[iSample] * music->iVolume / MIX_MAX_VOLUME);
+    }
+
+    if (iRead < (size_t)len) {
+        memset(stream + iRead, 0, len - iRead);
+
+        //The worker writes the last samples before saying the track ended
+        if (!music->fEnded) {
+            if (music->fStarted) {
+                music->iTrackUnderruns++;
+                music->iTotalUnderruns++;
+            }
+        } else if (music->buffer.readable() == 0) {
+            music->fDrained = true;
+        }
+    }
+
+    if (iRead > 0)
+        music->fStarted = true;
+}
+
+//Decodes up to iMaxReads reads into the buffer, or until it is full if 0
+void CMusicStream::decode(int iMaxReads)
+{
+#ifdef OGG_MUSIC
+    if (!fOpen && !open()) {
+        fEnded = true;
+        return;
+    }
+
+    bool fRewound = false;
+
+    for (int iReads = 0; buffer.writable() >= converted.size(); iReads++) {
+        if (iMaxReads > 0 && iReads >= iMaxReads)
+            return;
+
+        int iReadSection = iSection;
+
+#ifdef OGG_USE_TREMOR
+        long iRead = ov_read(&vorbis, (char *)&converted[0], MUSICSTREAM_READ_SIZE, &iReadSection);
+#else
+        long iRead = ov_read(&vorbis, (char *)&converted[0], MUSICSTREAM_READ_SIZE, SDL_BYTEORDER == SDL_BIG_ENDIAN, 2, 1, &iReadSection);
+#endif
+
+        //A gap in the data, decoding goes on after it
+        if (iRead == OV_HOLE)
+            continue;
+
+        if (iRead <= 0) {
+            //Loops from the start, unless the start has nothing to play either
+            if (iRead == 0 && fLoop && !fRewound && ov_raw_seek(&vorbis, 0) == 0) {
+                fRewound = true;
+                continue;
+            }
+
+            fEnded = true;
+            return;
+        }
+
+        fRewound = false;
+
+        //Chained files can change the format from one link to the next
+        if (iReadSection != iSection && !setFormat(iReadSection)) {
+            fEnded = true;
+            return;
+        }
+
+        size_t iSize = iRead;
+
+        if (cvt.needed) {
+            cvt.buf = &converted[0];
+            cvt.len = (int)iRead;
+            SDL_ConvertAudio(&cvt);
+            iSize = cvt.len_cvt;
+        }
+
+        buffer.write(&converted[0], iSize);
+    }
+#else
+    fEnded = true;
+#endif
+}
+
+bool CMusicStream::open()
+{
+#ifdef OGG_MUSIC
+    FILE * fp = fopen(filename.c_str(), "rb");
+
+    if (!fp)
+        return false;
+
+    if (ov_open_callbacks(fp, &vorbis, NULL, 0, stream_callbacks) < 0) {
+        fclose(fp);
+        return false;
+    }
+
+    fOpen = true;
+
+    if (!setFormat(0)) {
+        close();
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//Sets up converting the samples of the current link to the mixer format
+bool CMusicStream::setFormat(int iLink)
+{
+#ifdef OGG_MUSIC
+    vorbis_info * info = ov_info(&vorbis, -1);
+
+    if (!info || SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, info->channels, info->rate, iFormat, iChannels, iFrequency) < 0)
+        return false;
+
+    //Room for what a read turns into after converting
+    converted.resize(MUSICSTREAM_READ_SIZE * cvt.len_mult);
+    iSection = iLink;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CMusicStream::close()
+{
+#ifdef OGG_MUSIC
+    if (fOpen)
+        ov_clear(&vorbis);
+#endif
+
+    fOpen = false;
+}
@@ -0,0 +1,132 @@
+#ifndef MUSICSTREAM_H
+#define MUSICSTREAM_H
+
+#include "RingBuffer.h"
+#include "WorkerThread.h"
+
+#include "SDL.h"
+
+#ifdef OGG_MUSIC
+#ifdef OGG_USE_TREMOR
+    #include "ivorbisfile.h"
+#else
+    #include <vorbis/vorbisfile.h>
+#endif
+#endif
+
+#include <string>
+#include <vector>
+
+#ifdef SMW_HAVE_THREADS
+    #include <atomic>
+    typedef std::atomic<bool> MusicStreamFlag;
+    typedef std::atomic<unsigned int> MusicStreamCounter;
+#else
+    typedef volatile bool MusicStreamFlag;
+    typedef volatile unsigned int MusicStreamCounter;
+#endif
+
+#define MUSICSTREAM_BUFFER_SIZE     (64 * 1024) //Decoded ahead, about a third of a second
+#define MUSICSTREAM_READ_SIZE       4096        //Asked from the decoder at a time
+
+//Plays OGG music through a mixer hook instead of Mix_Music. SDL_mixer decodes
+//its music inside the mixer callback, which the libretro audio driver runs at
+//the end of retro_run, so a slow Vorbis frame made the whole frame slow. Here
+//a worker decodes and converts ahead into a ring buffer and the hook only
+//copies out of it. When the worker falls behind the hook plays silence and
+//counts an underrun instead of waiting.
+//
+//Only one track plays at a time, like with Mix_Music.
+class CMusicStream
+{
+    public:
+        CMusicStream();
+        ~CMusicStream();
+
+        //Whether filename is music the stream can play
+        static bool canPlay(const std::string& filename);
+
+        void play(const std::string& filename, bool fPlayonce);
+        void stop();
+
+        void setPaused(bool paused);
+        void setVolume(int volume);
+
+        bool playing() const {
+            return fPlaying;
+        }
+        bool playing(const std::string& file) const {
+            return fPlaying && filename == file;
+        }
+
+        //Called on the main thread once a frame, and once a track played
+        //once has run out
+        void update();
+        void setFinishedHook(void (*hook)()) {
+            finishedHook = hook;
+        }
+
+        //Mixer callbacks that found less music decoded than they needed,
+        //since the start of the track and in total
+        unsigned int trackUnderruns() const {
+            return iTrackUnderruns;
+        }
+        unsigned int totalUnderruns() const {
+            return iTotalUnderruns;
+        }
+
+    private:
+        static void mix(void * udata, Uint8 * stream, int len);
+
+        //On the worker
+        void decode(int iMaxReads);
+        bool open();
+        bool setFormat(int iLink);
+        void close();
+
+        CWorkerThread worker;
+        CRingBuffer buffer;
+
+        //The mixer format, set before the worker starts on a track
+        int iFrequency;
+        Uint16 iFormat;
+        int iChannels;
+
+        //Only touched by the worker while the track plays
+#ifdef OGG_MUSIC
+        OggVorbis_File vorbis;
+#endif
+        bool fOpen;
+        int iSection;
+        SDL_AudioCVT cvt;
+        std::vector<Uint8> converted;
+
+        std::string filename;
+        bool fLoop;
+
+        //Set by the worker when the track ended or couldn't be read, and by
+        //the mixer once it played the rest
+        MusicStreamFlag fEnded;
+        MusicStreamFlag fDrained;
+
+        //Whether the mixer got anything yet, underruns before that are the
+        //worker starting up
+        bool fStarted;
+
+        //Read by the mixer, changed with the audio locked
+        bool fPaused;
+        int iVolume;
+
+        bool fPlaying;
+        void (*finishedHook)();
+
+        MusicStreamCounter iTrackUnderruns;
+        MusicStreamCounter iTotalUnderruns;
+
+        CMusicStream(CMusicStream const&);
+        void operator=(CMusicStream const&);
+};
+
+extern CMusicStream g_musicstream;
+
+#endif // MUSICSTREAM_H
@@ -1,6 +1,7 @@
 #ifndef OBJECT_BASE_H
 #define OBJECT_BASE_H
 
+#include "GameplayHeap.h"
 #include "gfx/gfxSprite.h"
 
 class CPlayer;
@@ -24,7 +25,8 @@ enum ObjectType {
     object_pathhazard = 13,
     object_pipe_coin = 14,
     object_pipe_bonus = 15,
-    object_phanto = 16
+    object_phanto = 16,
+    OBJECTTYPE_LAST
 };
 
 float CapFallingVelocity(float vel);
@@ -38,6 +40,9 @@ class CObject
 		CObject(gfxSprite *nspr, short x, short y);
 		virtual ~CObject(){};
 
+		static void * operator new(size_t size) { return g_objectheap.allocate(size); }
+		static void operator delete(void * ptr) { g_objectheap.release(ptr); }
+
 		virtual void draw(){};
 		virtual void update() = 0;
 		virtual bool collide(CPlayer *){return false;}
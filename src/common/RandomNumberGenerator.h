@@ -65,6 +65,8 @@ public:
     Well512RandomNumberGenerator();
     void reseed(unsigned seed);
     int getInteger(int rMin, int rMax);
+
+    friend class SaveState;
 };
 
 #endif // RANDOMNUMBERGENERATOR_H
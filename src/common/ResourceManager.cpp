@@ -4,6 +4,7 @@
 #include "Game.h"
 #include "GameValues.h"
 #include "TilesetManager.h"
+#include "gfx/gfxImageBatch.h"
 
 extern SkinList *skinlist;
 extern GraphicsList *menugraphicspacklist;
@@ -20,6 +21,12 @@ extern CGame* smw;
 extern void _load_drawmsg(const std::string& f);
 extern void _load_waitforkey();
 
+CResourceManager::CResourceManager()
+{
+    fWorldGraphicsLoaded = false;
+    fMatchGraphicsLoaded = false;
+}
+
 bool CResourceManager::LoadMenuSkin(short playerID, short skinID, short colorID, bool fLoadBothDirections)
 {
     return gfx_loadmenuskin(spr_player[playerID], skinlist->GetIndex(skinID), 255, 0, 255, colorID, fLoadBothDirections);
@@ -40,9 +47,178 @@ bool CResourceManager::LoadFullSkin(gfxSprite ** sprites, short skinID, short co
     return LoadFullSkin(sprites, skinlist->GetIndex(skinID), colorID);
 }
 
-void CResourceManager::LoadAllSprites() {
+//Game pack sprites that the menus draw too: map previews, mode and powerup
+//options, the tournament scoreboard
+void CResourceManager::LoadSharedSprites()
+{
+    const char * graphicspack = gamegraphicspacklist->current_name();
+
+    gfx_loadimage(&menu_survival, convertPath("gfx/packs/modeobjects/menu_survival.png", graphicspack), false);
+    gfx_loadimage(&menu_stomp, convertPath("gfx/packs/modeobjects/menu_stomp.png", graphicspack), false);
+    gfx_loadimage(&menu_egg, convertPath("gfx/packs/modeobjects/menu_egg.png", graphicspack), false);
+
+    gfx_loadimage(&spr_tileanimation[0], convertPath("gfx/packs/tilesets/tile_animation.png", graphicspack), false);
+    gfx_loadimage(&spr_tileanimation[1], convertPath("gfx/packs/tilesets/tile_animation_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_tileanimation[2], convertPath("gfx/packs/tilesets/tile_animation_thumbnail.png", graphicspack), false);
+    gfx_loadimage(&spr_blocks[0], convertPath("gfx/packs/tilesets/blocks.png", graphicspack), false);
+    gfx_loadimage(&spr_blocks[1], convertPath("gfx/packs/tilesets/blocks_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_blocks[2], convertPath("gfx/packs/tilesets/blocks_thumbnail.png", graphicspack), false);
+    gfx_loadimage(&spr_unknowntile[0], convertPath("gfx/packs/tilesets/unknown_tile.png", graphicspack), false);
+    gfx_loadimage(&spr_unknowntile[1], convertPath("gfx/packs/tilesets/unknown_tile_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_unknowntile[2], convertPath("gfx/packs/tilesets/unknown_tile_thumbnail.png", graphicspack), false);
+
+    gfx_loadimage(&spr_scoretext, convertPath("gfx/packs/fonts/score.png", graphicspack), false);
+    gfx_loadimage(&spr_warplock, convertPath("gfx/packs/eyecandy/warplock.png", graphicspack), false);
+    gfx_loadimage(&spr_phanto, convertPath("gfx/packs/modeobjects/phanto.png", graphicspack), true);
+    gfx_loadimage(&spr_teleportstar, convertPath("gfx/packs/eyecandy/teleportstar.png", graphicspack), false);
+
+    gfx_loadimage(&spr_hazard_fireball[0], convertPath("gfx/packs/hazards/fireball.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_fireball[1], convertPath("gfx/packs/hazards/fireball_preview.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_fireball[2], convertPath("gfx/packs/hazards/fireball_thumbnail.png", graphicspack), true);
+
+    gfx_loadimage(&spr_hazard_rotodisc[0], convertPath("gfx/packs/hazards/rotodisc.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_rotodisc[1], convertPath("gfx/packs/hazards/rotodisc_preview.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_rotodisc[2], convertPath("gfx/packs/hazards/rotodisc_thumbnail.png", graphicspack), true);
+
+    gfx_loadimage(&spr_hazard_bulletbill[0], convertPath("gfx/packs/hazards/bulletbill.png", graphicspack), false);
+    gfx_loadimage(&spr_hazard_bulletbill[1], convertPath("gfx/packs/hazards/bulletbill_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_hazard_bulletbill[2], convertPath("gfx/packs/hazards/bulletbill_thumbnail.png", graphicspack), false);
+
+    gfx_loadimage(&spr_hazard_flame[0], convertPath("gfx/packs/hazards/flame.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_flame[1], convertPath("gfx/packs/hazards/flame_preview.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_flame[2], convertPath("gfx/packs/hazards/flame_thumbnail.png", graphicspack), true);
+
+    gfx_loadimage(&spr_hazard_pirhanaplant[0], convertPath("gfx/packs/hazards/pirhanaplant.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_pirhanaplant[1], convertPath("gfx/packs/hazards/pirhanaplant_preview.png", graphicspack), true);
+    gfx_loadimage(&spr_hazard_pirhanaplant[2], convertPath("gfx/packs/hazards/pirhanaplant_thumbnail.png", graphicspack), true);
+
+    gfx_loadimage(&spr_hazard_bulletbilldead, convertPath("gfx/packs/hazards/bulletbilldead.png", graphicspack), false);
+
+    gfx_loadimage(&spr_fireballexplosion, convertPath("gfx/packs/eyecandy/fireballexplosion.png", graphicspack), 160, true, true);
+    gfx_loadimage(&spr_explosion, convertPath("gfx/packs/eyecandy/explosion.png", graphicspack), true);
+    gfx_loadimage(&spr_fireworks, convertPath("gfx/packs/eyecandy/fireworks.png", graphicspack), true);
+    gfx_loadimage(&spr_poof, convertPath("gfx/packs/eyecandy/poof.png", graphicspack), true);
+    gfx_loadimage(&spr_bonus, convertPath("gfx/packs/eyecandy/bonus.png", graphicspack), true);
+
+    gfx_loadimage(&spr_storedpowerupsmall, convertPath("gfx/packs/powerups/small.png", graphicspack), true);
+    gfx_loadimage(&spr_storedpoweruplarge, convertPath("gfx/packs/powerups/large.png", graphicspack), false);
+    gfx_loadimage(&spr_powerupselector, convertPath("gfx/packs/awards/award.png", graphicspack), false);
+}
+
+bool CResourceManager::LoadMenuGraphics()
+{
+    const char * graphicspack = menugraphicspacklist->current_name();
+
+    gfx_loadimagenocolorkey(&menu_shade, convertPath("gfx/packs/menu/menu_shade.png", graphicspack));
+    menu_shade.setalpha(smw->MenuTransparency);
+
+    g_imagebatch.begin();
+
+    gfx_loadimage(&spr_scoreboard, convertPath("gfx/packs/menu/scoreboard.png", graphicspack), false);
+    gfx_loadimage(&menu_slider_bar, convertPath("gfx/packs/menu/menu_slider_bar.png", graphicspack), false);
+    gfx_loadimage(&menu_plain_field, convertPath("gfx/packs/menu/menu_plain_field.png", graphicspack), false);
+    gfx_loadimage(&menu_player_select, convertPath("gfx/packs/menu/menu_player_select.png", graphicspack), false);
+    gfx_loadimage(&menu_dialog, convertPath("gfx/packs/menu/menu_dialog.png", graphicspack), false);
+    gfx_loadimage(&menu_map_filter, convertPath("gfx/packs/menu/menu_map_filter.png", graphicspack), false);
+    gfx_loadimage(&menu_match_select, convertPath("gfx/packs/menu/menu_match_select.png", graphicspack), false);
+
+    gfx_loadimage(&menu_verticalarrows, convertPath("gfx/packs/menu/menu_vertical_arrows.png", graphicspack), false);
+
+    gfx_loadimage(&menu_mode_small, convertPath("gfx/packs/menu/menu_mode_small.png", graphicspack), false);
+    gfx_loadimage(&menu_mode_large, convertPath("gfx/packs/menu/menu_mode_large.png", graphicspack), false);
+
+    gfx_loadimage(&spr_dialog, convertPath("gfx/packs/menu/dialog.png", graphicspack), false);
+    gfx_loadimage(&spr_dialogbutton, convertPath("gfx/packs/menu/dialog_button.png", graphicspack), false);
+    gfx_loadimage(&spr_tournament_background, convertPath("gfx/packs/menu/tournament_background.png", graphicspack), false);
+    gfx_loadimage(&spr_tournament_powerup_splash, convertPath("gfx/packs/menu/tournament_powerup_splash.png", graphicspack), false);
+    gfx_loadimage(&spr_player_select_background, convertPath("gfx/packs/menu/player_select_background.png", graphicspack), false);
+    gfx_loadimage(&spr_player_select_ready, convertPath("gfx/packs/menu/player_select_ready.png", graphicspack), false);
+    //gfx_loadimage(&spr_ipfield, convertPath("gfx/packs/menu/menu_ipfield.png", graphicspack), false);
+    gfx_loadimage(&spr_selectfield, convertPath("gfx/packs/menu/menu_selectfield.png", graphicspack), false);
+    gfx_loadimage(&spr_selectfielddisabled, convertPath("gfx/packs/menu/menu_selectfield_disabled.png", graphicspack), false);
+    gfx_loadimage(&spr_map_filter_icons, convertPath("gfx/packs/menu/menu_map_flags.png", graphicspack), false);
+    gfx_loadimage(&spr_tour_markers, convertPath("gfx/packs/menu/tour_markers.png", graphicspack), false);
+    gfx_loadimage(&spr_menu_boxed_numbers, convertPath("gfx/packs/menu/menu_boxed_numbers.png", graphicspack), false);
+    gfx_loadimage(&spr_countdown_numbers, convertPath("gfx/packs/menu/game_countdown_numbers.png", graphicspack), false);
+    gfx_loadimage(&spr_thumbnail_warps[0], convertPath("gfx/packs/menu/menu_warp_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_thumbnail_warps[1], convertPath("gfx/packs/menu/menu_warp_thumbnail.png", graphicspack), false);
+    gfx_loadimage(&spr_thumbnail_mapitems[0], convertPath("gfx/packs/menu/menu_mapitems_preview.png", graphicspack), false);
+    gfx_loadimage(&spr_thumbnail_mapitems[1], convertPath("gfx/packs/menu/menu_mapitems_thumbnail.png", graphicspack), false);
+
+    gfx_loadimage(&spr_announcementicons, convertPath("gfx/packs/menu/menu_announcement_icons.png", graphicspack), false);
+
+    gfx_loadimage(&spr_platformstarttile, convertPath("gfx/leveleditor/leveleditor_platformstarttile.png"), 64, true, true);
+    gfx_loadimage(&spr_platformendtile, convertPath("gfx/leveleditor/leveleditor_selectedtile.png"), 64, true, true);
+    gfx_loadimage(&spr_platformpath, convertPath("gfx/leveleditor/leveleditor_platform_path.png"), 128, true, true);
+
+    return g_imagebatch.end();
+}
+
+bool CResourceManager::LoadWorldGraphics()
+{
+    const char * graphicspack = worldgraphicspacklist->current_name();
+
+    g_imagebatch.begin();
+
+    gfx_loadimage(&spr_worldbackground[0], convertPath("gfx/packs/world/world_background.png", graphicspack), false, false);
+    gfx_loadimage(&spr_worldbackground[1], convertPath("gfx/packs/world/preview/world_background.png", graphicspack), false, false);
+
+    gfx_loadimage(&spr_worldforeground[0], convertPath("gfx/packs/world/world_foreground.png", graphicspack), false, false);
+    gfx_loadimage(&spr_worldforeground[1], convertPath("gfx/packs/world/preview/world_foreground.png", graphicspack), false, false);
+
+    gfx_loadimage(&spr_worldforegroundspecial[0], convertPath("gfx/packs/world/world_foreground_special.png", graphicspack), false, false);
+    gfx_loadimage(&spr_worldforegroundspecial[1], convertPath("gfx/packs/world/preview/world_foreground_special.png", graphicspack), false, false);
+
+    gfx_loadimage(&spr_worldpaths[0], convertPath("gfx/packs/world/world_paths.png", graphicspack), false, false);
+    gfx_loadimage(&spr_worldpaths[1], convertPath("gfx/packs/world/preview/world_paths.png", graphicspack), false, false);
+
+    gfx_loadimage(&spr_worldvehicle[0], convertPath("gfx/packs/world/world_vehicles.png", graphicspack), false);
+    gfx_loadimage(&spr_worldvehicle[1], convertPath("gfx/packs/world/preview/world_vehicles.png", graphicspack), false);
+
+    gfx_loadimage(&spr_worlditems, convertPath("gfx/packs/world/world_powerups.png", graphicspack), false);
+    gfx_loadimage(&spr_worlditempopup, convertPath("gfx/packs/world/world_item_popup.png", graphicspack), false);
+    gfx_loadimage(&spr_worlditemssmall, convertPath("gfx/packs/world/world_powerupssmall.png", graphicspack), false);
+    gfx_loadimage(&spr_worlditemsplace, convertPath("gfx/packs/world/world_bonusplace.png", graphicspack), false);
+    gfx_loadimage(&spr_worldbonushouse, convertPath("gfx/packs/world/world_bonushouse.png", graphicspack), false);
+
+    fWorldGraphicsLoaded = true;
+    return g_imagebatch.end();
+}
+
+bool CResourceManager::LoadGameGraphics()
+{
+    const char * graphicspack = gamegraphicspacklist->current_name();
+
+    g_tilesetmanager->Init(graphicspack);
+
+    bool loadok = true;
+    loadok &= game_font_small.init(convertPath("gfx/packs/fonts/font_small.png", graphicspack));
+    loadok &= game_font_large.init(convertPath("gfx/packs/fonts/font_large.png", graphicspack));
+
+    if (!loadok) {
+        _load_drawmsg("ERROR: error loading the fonts!\n");
+        _load_waitforkey();
+        return false;
+    }
+
+    //The tilesets and fonts above use their images right away
+    g_imagebatch.begin();
+
+    LoadSharedSprites();
+
+    //Already loaded ones are from the old pack
+    if (fMatchGraphicsLoaded)
+        LoadMatchGraphics();
+
+    return g_imagebatch.end();
+}
+
+bool CResourceManager::LoadMatchGraphics()
+{
     const char * graphicspack = gamegraphicspacklist->current_name();
 
+    g_imagebatch.begin();
+
     //Just load menu skins for now (just standing right sprite)
     for (short k = 0; k < MAX_PLAYERS; k++) {
         //LoadMenuSkin(k, game_values.skinids[k], game_values.colorids[k], false);
@@ -51,10 +227,6 @@ void CResourceManager::LoadAllSprites() {
         LoadFullSkin(spr_bobomb[k], convertPath("gfx/packs/modeskins/bobomb.png", graphicspack), k);
     }
 
-    gfx_loadimage(&menu_survival, convertPath("gfx/packs/modeobjects/menu_survival.png", graphicspack), false);
-    gfx_loadimage(&menu_stomp, convertPath("gfx/packs/modeobjects/menu_stomp.png", graphicspack), false);
-    gfx_loadimage(&menu_egg, convertPath("gfx/packs/modeobjects/menu_egg.png", graphicspack), false);
-
     gfx_loadimage(&spr_clouds, convertPath("gfx/packs/eyecandy/cloud.png", graphicspack), 255, true, true);
     gfx_loadimage(&spr_ghosts, convertPath("gfx/packs/eyecandy/ghost.png", graphicspack), 128, true, true);
     gfx_loadimage(&spr_fish, convertPath("gfx/packs/eyecandy/fish.png", graphicspack), 128, true, true);
@@ -78,18 +250,6 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_kuriboshoe, convertPath("gfx/packs/powerups/kuriboshoe.png", graphicspack), true);
     gfx_loadimage(&spr_throwbox, convertPath("gfx/packs/powerups/throwbox.png", graphicspack), true);
 
-    gfx_loadimage(&spr_tileanimation[0], convertPath("gfx/packs/tilesets/tile_animation.png", graphicspack), false);
-    gfx_loadimage(&spr_tileanimation[1], convertPath("gfx/packs/tilesets/tile_animation_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_tileanimation[2], convertPath("gfx/packs/tilesets/tile_animation_thumbnail.png", graphicspack), false);
-
-    gfx_loadimage(&spr_blocks[0], convertPath("gfx/packs/tilesets/blocks.png", graphicspack), false);
-    gfx_loadimage(&spr_blocks[1], convertPath("gfx/packs/tilesets/blocks_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_blocks[2], convertPath("gfx/packs/tilesets/blocks_thumbnail.png", graphicspack), false);
-
-    gfx_loadimage(&spr_unknowntile[0], convertPath("gfx/packs/tilesets/unknown_tile.png", graphicspack), false);
-    gfx_loadimage(&spr_unknowntile[1], convertPath("gfx/packs/tilesets/unknown_tile_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_unknowntile[2], convertPath("gfx/packs/tilesets/unknown_tile_thumbnail.png", graphicspack), false);
-
     gfx_loadimage(&spr_brokenyellowblock, convertPath("gfx/packs/eyecandy/brokenyellowblock.png", graphicspack), true);
     gfx_loadimage(&spr_brokenflipblock, convertPath("gfx/packs/eyecandy/brokenflipblock.png", graphicspack), true);
     gfx_loadimage(&spr_brokenblueblock, convertPath("gfx/packs/eyecandy/brokenblueblock.png", graphicspack), true);
@@ -139,7 +299,6 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_scorecoins, convertPath("gfx/packs/menu/score_coins.png", graphicspack), false);
 
     gfx_loadimage(&spr_timershade, convertPath("gfx/packs/eyecandy/timershade.png", graphicspack), 64, false, true);
-    gfx_loadimage(&spr_scoretext, convertPath("gfx/packs/fonts/score.png", graphicspack), false);
     gfx_loadimage(&spr_racetext, convertPath("gfx/packs/fonts/race.png", graphicspack), false);
 
     gfx_loadimage(&spr_crown, convertPath("gfx/packs/eyecandy/crown.png", graphicspack), true);
@@ -147,7 +306,6 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_tail, convertPath("gfx/packs/eyecandy/tail.png", graphicspack), true);
     gfx_loadimage(&spr_wings, convertPath("gfx/packs/eyecandy/wings.png", graphicspack), true);
 
-    gfx_loadimage(&spr_warplock, convertPath("gfx/packs/eyecandy/warplock.png", graphicspack), false);
     gfx_loadimage(&spr_coinsparkle, convertPath("gfx/packs/eyecandy/coinsparks.png", graphicspack), true);
     gfx_loadimage(&spr_shinesparkle, convertPath("gfx/packs/eyecandy/shinesparks.png", graphicspack), true);
     gfx_loadimage(&spr_shellbounce, convertPath("gfx/packs/eyecandy/shellbounce.png", graphicspack), true);
@@ -190,11 +348,9 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_racegoal, convertPath("gfx/packs/modeobjects/racegoal.png", graphicspack), false);
     gfx_loadimage(&spr_pipegamebonus, convertPath("gfx/packs/modeobjects/pipeminigamebonuses.png", graphicspack), true);
 
-    gfx_loadimage(&spr_phanto, convertPath("gfx/packs/modeobjects/phanto.png", graphicspack), true);
     gfx_loadimage(&spr_phantokey, convertPath("gfx/packs/modeobjects/key.png", graphicspack), true);
 
     gfx_loadimage(&spr_bonuschest, convertPath("gfx/packs/modeobjects/bonuschest.png", graphicspack), true);
-    gfx_loadimage(&spr_teleportstar, convertPath("gfx/packs/eyecandy/teleportstar.png", graphicspack), false);
 
     gfx_loadimage(&spr_fireball, convertPath("gfx/packs/projectiles/fireball.png", graphicspack), true);
     gfx_loadimage(&spr_hammer, convertPath("gfx/packs/projectiles/hammer.png", graphicspack), true);
@@ -208,40 +364,13 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_superfireball, convertPath("gfx/packs/modeobjects/superfire.png", graphicspack), true);
     gfx_loadimage(&spr_sledgehammer, convertPath("gfx/packs/modeobjects/sledgehammer.png", graphicspack), true);
 
-    gfx_loadimage(&spr_hazard_fireball[0], convertPath("gfx/packs/hazards/fireball.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_fireball[1], convertPath("gfx/packs/hazards/fireball_preview.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_fireball[2], convertPath("gfx/packs/hazards/fireball_thumbnail.png", graphicspack), true);
-
-    gfx_loadimage(&spr_hazard_rotodisc[0], convertPath("gfx/packs/hazards/rotodisc.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_rotodisc[1], convertPath("gfx/packs/hazards/rotodisc_preview.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_rotodisc[2], convertPath("gfx/packs/hazards/rotodisc_thumbnail.png", graphicspack), true);
-
-    gfx_loadimage(&spr_hazard_bulletbill[0], convertPath("gfx/packs/hazards/bulletbill.png", graphicspack), false);
-    gfx_loadimage(&spr_hazard_bulletbill[1], convertPath("gfx/packs/hazards/bulletbill_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_hazard_bulletbill[2], convertPath("gfx/packs/hazards/bulletbill_thumbnail.png", graphicspack), false);
-
-    gfx_loadimage(&spr_hazard_flame[0], convertPath("gfx/packs/hazards/flame.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_flame[1], convertPath("gfx/packs/hazards/flame_preview.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_flame[2], convertPath("gfx/packs/hazards/flame_thumbnail.png", graphicspack), true);
-
-    gfx_loadimage(&spr_hazard_pirhanaplant[0], convertPath("gfx/packs/hazards/pirhanaplant.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_pirhanaplant[1], convertPath("gfx/packs/hazards/pirhanaplant_preview.png", graphicspack), true);
-    gfx_loadimage(&spr_hazard_pirhanaplant[2], convertPath("gfx/packs/hazards/pirhanaplant_thumbnail.png", graphicspack), true);
-
-    gfx_loadimage(&spr_hazard_bulletbilldead, convertPath("gfx/packs/hazards/bulletbilldead.png", graphicspack), false);
-
-    gfx_loadimage(&spr_fireballexplosion, convertPath("gfx/packs/eyecandy/fireballexplosion.png", graphicspack), 160, true, true);
     gfx_loadimage(&spr_frictionsmoke, convertPath("gfx/packs/eyecandy/frictionsmoke.png", graphicspack), 160, true, true);
     gfx_loadimage(&spr_bobombsmoke, convertPath("gfx/packs/eyecandy/bobombsmoke.png", graphicspack), 160, true, true);
-    gfx_loadimage(&spr_explosion, convertPath("gfx/packs/eyecandy/explosion.png", graphicspack), true);
     gfx_loadimage(&spr_burnup, convertPath("gfx/packs/eyecandy/burnup.png", graphicspack), 192, true, true);
-    gfx_loadimage(&spr_fireworks, convertPath("gfx/packs/eyecandy/fireworks.png", graphicspack), true);
-    gfx_loadimage(&spr_poof, convertPath("gfx/packs/eyecandy/poof.png", graphicspack), true);
 
     gfx_loadimage(&spr_spawnsmoke, convertPath("gfx/packs/eyecandy/spawnsmoke.png", graphicspack), 128, true, true);
     gfx_loadimage(&spr_spawndoor, convertPath("gfx/packs/eyecandy/spawndoor.png", graphicspack), true);
 
-    gfx_loadimage(&spr_bonus, convertPath("gfx/packs/eyecandy/bonus.png", graphicspack), true);
     gfx_loadimage(&spr_extralife, convertPath("gfx/packs/eyecandy/extralife.png", graphicspack), true);
 
     gfx_loadimage(&spr_windmeter, convertPath("gfx/packs/eyecandy/wind_meter.png", graphicspack), 192, true, true);
@@ -258,107 +387,17 @@ void CResourceManager::LoadAllSprites() {
     gfx_loadimage(&spr_flagbases, convertPath("gfx/packs/modeobjects/flagbases.png", graphicspack), 160, true, true);
     gfx_loadimage(&spr_ownedtags, convertPath("gfx/packs/modeobjects/ownedtags.png", graphicspack), 160, true, true);
 
-    gfx_loadimage(&spr_storedpowerupsmall, convertPath("gfx/packs/powerups/small.png", graphicspack), true);
-    gfx_loadimage(&spr_storedpoweruplarge, convertPath("gfx/packs/powerups/large.png", graphicspack), false);
-    gfx_loadimage(&spr_powerupselector, convertPath("gfx/packs/awards/award.png", graphicspack), false);
-
     gfx_loadimage(&spr_abovearrows, convertPath("gfx/packs/eyecandy/abovearrows.png", graphicspack), true);
-}
-
-bool CResourceManager::LoadMenuGraphics()
-{
-    const char * graphicspack = menugraphicspacklist->current_name();
-
-    gfx_loadimagenocolorkey(&menu_shade, convertPath("gfx/packs/menu/menu_shade.png", graphicspack));
-    menu_shade.setalpha(smw->MenuTransparency);
-
-    gfx_loadimage(&spr_scoreboard, convertPath("gfx/packs/menu/scoreboard.png", graphicspack), false);
-    gfx_loadimage(&menu_slider_bar, convertPath("gfx/packs/menu/menu_slider_bar.png", graphicspack), false);
-    gfx_loadimage(&menu_plain_field, convertPath("gfx/packs/menu/menu_plain_field.png", graphicspack), false);
-    gfx_loadimage(&menu_player_select, convertPath("gfx/packs/menu/menu_player_select.png", graphicspack), false);
-    gfx_loadimage(&menu_dialog, convertPath("gfx/packs/menu/menu_dialog.png", graphicspack), false);
-    gfx_loadimage(&menu_map_filter, convertPath("gfx/packs/menu/menu_map_filter.png", graphicspack), false);
-    gfx_loadimage(&menu_match_select, convertPath("gfx/packs/menu/menu_match_select.png", graphicspack), false);
-
-    gfx_loadimage(&menu_verticalarrows, convertPath("gfx/packs/menu/menu_vertical_arrows.png", graphicspack), false);
-
-    gfx_loadimage(&menu_mode_small, convertPath("gfx/packs/menu/menu_mode_small.png", graphicspack), false);
-    gfx_loadimage(&menu_mode_large, convertPath("gfx/packs/menu/menu_mode_large.png", graphicspack), false);
-
-    gfx_loadimage(&spr_dialog, convertPath("gfx/packs/menu/dialog.png", graphicspack), false);
-    gfx_loadimage(&spr_dialogbutton, convertPath("gfx/packs/menu/dialog_button.png", graphicspack), false);
-    gfx_loadimage(&spr_tournament_background, convertPath("gfx/packs/menu/tournament_background.png", graphicspack), false);
-    gfx_loadimage(&spr_tournament_powerup_splash, convertPath("gfx/packs/menu/tournament_powerup_splash.png", graphicspack), false);
-    gfx_loadimage(&spr_player_select_background, convertPath("gfx/packs/menu/player_select_background.png", graphicspack), false);
-    gfx_loadimage(&spr_player_select_ready, convertPath("gfx/packs/menu/player_select_ready.png", graphicspack), false);
-    //gfx_loadimage(&spr_ipfield, convertPath("gfx/packs/menu/menu_ipfield.png", graphicspack), false);
-    gfx_loadimage(&spr_selectfield, convertPath("gfx/packs/menu/menu_selectfield.png", graphicspack), false);
-    gfx_loadimage(&spr_selectfielddisabled, convertPath("gfx/packs/menu/menu_selectfield_disabled.png", graphicspack), false);
-    gfx_loadimage(&spr_map_filter_icons, convertPath("gfx/packs/menu/menu_map_flags.png", graphicspack), false);
-    gfx_loadimage(&spr_tour_markers, convertPath("gfx/packs/menu/tour_markers.png", graphicspack), false);
-    gfx_loadimage(&spr_menu_boxed_numbers, convertPath("gfx/packs/menu/menu_boxed_numbers.png", graphicspack), false);
-    gfx_loadimage(&spr_countdown_numbers, convertPath("gfx/packs/menu/game_countdown_numbers.png", graphicspack), false);
-    gfx_loadimage(&spr_thumbnail_warps[0], convertPath("gfx/packs/menu/menu_warp_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_thumbnail_warps[1], convertPath("gfx/packs/menu/menu_warp_thumbnail.png", graphicspack), false);
-    gfx_loadimage(&spr_thumbnail_mapitems[0], convertPath("gfx/packs/menu/menu_mapitems_preview.png", graphicspack), false);
-    gfx_loadimage(&spr_thumbnail_mapitems[1], convertPath("gfx/packs/menu/menu_mapitems_thumbnail.png", graphicspack), false);
 
-    gfx_loadimage(&spr_announcementicons, convertPath("gfx/packs/menu/menu_announcement_icons.png", graphicspack), false);
+    gfx_loadimagenocolorkey(&spr_backmap[0], convertPath("gfx/packs/backgrounds/Land_Classic.png", graphicspack));
+    gfx_loadimagenocolorkey(&spr_backmap[1], convertPath("gfx/packs/backgrounds/Land_Classic.png", graphicspack));
+    gfx_loadimagenocolorkey(&spr_frontmap[0], convertPath("gfx/packs/backgrounds/Land_Classic.png", graphicspack));
+    gfx_loadimagenocolorkey(&spr_frontmap[1], convertPath("gfx/packs/backgrounds/Land_Classic.png", graphicspack));
 
-    gfx_loadimage(&spr_platformstarttile, convertPath("gfx/leveleditor/leveleditor_platformstarttile.png"), 64, true, true);
-    gfx_loadimage(&spr_platformendtile, convertPath("gfx/leveleditor/leveleditor_selectedtile.png"), 64, true, true);
-    gfx_loadimage(&spr_platformpath, convertPath("gfx/leveleditor/leveleditor_platform_path.png"), 128, true, true);
+    gfx_loadimage(&spr_overlay, convertPath("gfx/packs/menu/menu_shade.png", graphicspack), false, false);
 
-    return true;
-}
-
-bool CResourceManager::LoadWorldGraphics()
-{
-    const char * graphicspack = worldgraphicspacklist->current_name();
-
-    gfx_loadimage(&spr_worldbackground[0], convertPath("gfx/packs/world/world_background.png", graphicspack), false, false);
-    gfx_loadimage(&spr_worldbackground[1], convertPath("gfx/packs/world/preview/world_background.png", graphicspack), false, false);
-
-    gfx_loadimage(&spr_worldforeground[0], convertPath("gfx/packs/world/world_foreground.png", graphicspack), false, false);
-    gfx_loadimage(&spr_worldforeground[1], convertPath("gfx/packs/world/preview/world_foreground.png", graphicspack), false, false);
-
-    gfx_loadimage(&spr_worldforegroundspecial[0], convertPath("gfx/packs/world/world_foreground_special.png", graphicspack), false, false);
-    gfx_loadimage(&spr_worldforegroundspecial[1], convertPath("gfx/packs/world/preview/world_foreground_special.png", graphicspack), false, false);
-
-    gfx_loadimage(&spr_worldpaths[0], convertPath("gfx/packs/world/world_paths.png", graphicspack), false, false);
-    gfx_loadimage(&spr_worldpaths[1], convertPath("gfx/packs/world/preview/world_paths.png", graphicspack), false, false);
-
-    gfx_loadimage(&spr_worldvehicle[0], convertPath("gfx/packs/world/world_vehicles.png", graphicspack), false);
-    gfx_loadimage(&spr_worldvehicle[1], convertPath("gfx/packs/world/preview/world_vehicles.png", graphicspack), false);
-
-    gfx_loadimage(&spr_worlditems, convertPath("gfx/packs/world/world_powerups.png", graphicspack), false);
-    gfx_loadimage(&spr_worlditempopup, convertPath("gfx/packs/world/world_item_popup.png", graphicspack), false);
-    gfx_loadimage(&spr_worlditemssmall, convertPath("gfx/packs/world/world_powerupssmall.png", graphicspack), false);
-    gfx_loadimage(&spr_worlditemsplace, convertPath("gfx/packs/world/world_bonusplace.png", graphicspack), false);
-    gfx_loadimage(&spr_worldbonushouse, convertPath("gfx/packs/world/world_bonushouse.png", graphicspack), false);
-
-    return true;
-}
-
-bool CResourceManager::LoadGameGraphics()
-{
-    const char * graphicspack = gamegraphicspacklist->current_name();
-
-    g_tilesetmanager->Init(graphicspack);
-
-    bool loadok = true;
-    loadok &= game_font_small.init(convertPath("gfx/packs/fonts/font_small.png", graphicspack));
-    loadok &= game_font_large.init(convertPath("gfx/packs/fonts/font_large.png", graphicspack));
-
-    if (!loadok) {
-        _load_drawmsg("ERROR: error loading the fonts!\n");
-        _load_waitforkey();
-        return false;
-    }
-
-    LoadAllSprites();
-
-    return true;
+    fMatchGraphicsLoaded = true;
+    return g_imagebatch.end();
 }
 
 void CResourceManager::LoadAllGraphics()
@@ -384,16 +423,31 @@ void CResourceManager::LoadAllGraphics()
         }
     }
 
+    //World and match graphics wait until a world or a match needs them
     LoadMenuGraphics();
-    LoadWorldGraphics();
     LoadGameGraphics();
+}
 
-    gfx_loadimagenocolorkey(&spr_backmap[0], convertPath("gfx/packs/backgrounds/Land_Classic.png", gamegraphicspacklist->current_name()));
-    gfx_loadimagenocolorkey(&spr_backmap[1], convertPath("gfx/packs/backgrounds/Land_Classic.png", gamegraphicspacklist->current_name()));
-    gfx_loadimagenocolorkey(&spr_frontmap[0], convertPath("gfx/packs/backgrounds/Land_Classic.png", gamegraphicspacklist->current_name()));
-    gfx_loadimagenocolorkey(&spr_frontmap[1], convertPath("gfx/packs/backgrounds/Land_Classic.png", gamegraphicspacklist->current_name()));
+bool CResourceManager::RequireWorldGraphics()
+{
+    if (fWorldGraphicsLoaded)
+        return true;
 
-    gfx_loadimage(&spr_overlay, convertPath("gfx/packs/menu/menu_shade.png", gamegraphicspacklist->current_name()), false, false);
+    return LoadWorldGraphics();
+}
+
+bool CResourceManager::RequireMatchGraphics()
+{
+    if (fMatchGraphicsLoaded)
+        return true;
+
+    return LoadMatchGraphics();
+}
+
+void CResourceManager::PreloadGraphics()
+{
+    RequireWorldGraphics();
+    RequireMatchGraphics();
 }
 
 bool CResourceManager::LoadGameSounds()
@@ -410,6 +464,7 @@ bool CResourceManager::LoadGameSounds()
 
     const char * soundpack = soundpacklist->current_name();
 
+    //Sounds of single game modes, items and the world map are decoded on first play
     sfx_mip.init(convertPath("sfx/packs/mip.ogg", soundpack));
     sfx_deathsound.init(convertPath("sfx/packs/death.ogg", soundpack));
     sfx_jump.init(convertPath("sfx/packs/jump.ogg", soundpack));
@@ -429,36 +484,36 @@ bool CResourceManager::LoadGameSounds()
     sfx_springjump.init(convertPath("sfx/packs/springjump.ogg", soundpack));
     sfx_timewarning.init(convertPath("sfx/packs/timewarning.ogg", soundpack));
     sfx_hit.init(convertPath("sfx/packs/hit.ogg", soundpack));
-    sfx_chicken.init(convertPath("sfx/packs/chicken.ogg", soundpack));
+    sfx_chicken.init(convertPath("sfx/packs/chicken.ogg", soundpack), true);
     sfx_transform.init(convertPath("sfx/packs/transform.ogg", soundpack));
-    sfx_yoshi.init(convertPath("sfx/packs/yoshi.ogg", soundpack));
+    sfx_yoshi.init(convertPath("sfx/packs/yoshi.ogg", soundpack), true);
     sfx_pause.init(convertPath("sfx/packs/pause.ogg", soundpack));
     sfx_bobombsound.init(convertPath("sfx/packs/bob-omb.ogg", soundpack));
     sfx_areatag.init(convertPath("sfx/packs/dcoin.ogg", soundpack));
     sfx_cannon.init(convertPath("sfx/packs/cannon.ogg", soundpack));
     sfx_burnup.init(convertPath("sfx/packs/burnup.ogg", soundpack));
     sfx_pipe.init(convertPath("sfx/packs/warp.ogg", soundpack));
-    sfx_thunder.init(convertPath("sfx/packs/thunder.ogg", soundpack));
+    sfx_thunder.init(convertPath("sfx/packs/thunder.ogg", soundpack), true);
     sfx_slowdownmusic.init(convertPath("sfx/packs/clock.ogg", soundpack));
     sfx_flyingsound.init(convertPath("sfx/packs/slowdown.ogg", soundpack));
     sfx_storedpowerupsound.init(convertPath("sfx/packs/storedpowerup.ogg", soundpack));
     sfx_kicksound.init(convertPath("sfx/packs/kick.ogg", soundpack));
-    sfx_racesound.init(convertPath("sfx/packs/race.ogg", soundpack));
+    sfx_racesound.init(convertPath("sfx/packs/race.ogg", soundpack), true);
     sfx_bulletbillsound.init(convertPath("sfx/packs/bulletbill.ogg", soundpack));
     sfx_boomerang.init(convertPath("sfx/packs/boomerang.ogg", soundpack));
-    sfx_spit.init(convertPath("sfx/packs/spit.ogg", soundpack));
+    sfx_spit.init(convertPath("sfx/packs/spit.ogg", soundpack), true);
     sfx_starwarning.init(convertPath("sfx/packs/starwarning.ogg", soundpack));
     sfx_powerdown.init(convertPath("sfx/packs/powerdown.ogg", soundpack));
     sfx_switchpress.init(convertPath("sfx/packs/switchpress.ogg", soundpack));
     sfx_superspring.init(convertPath("sfx/packs/superspring.ogg", soundpack));
     sfx_stun.init(convertPath("sfx/packs/stun.ogg", soundpack));
     sfx_inventory.init(convertPath("sfx/packs/inventory.ogg", soundpack));
-    sfx_worldmove.init(convertPath("sfx/packs/mapmove.ogg", soundpack));
-    sfx_treasurechest.init(convertPath("sfx/packs/treasurechest.ogg", soundpack));
-    sfx_flamecannon.init(convertPath("sfx/packs/flamecannon.ogg", soundpack));
-    sfx_wand.init(convertPath("sfx/packs/wand.ogg", soundpack));
-    sfx_enterstage.init(convertPath("sfx/packs/enter-stage.ogg", soundpack));
-    sfx_gameover.init(convertPath("sfx/packs/gameover.ogg", soundpack));
+    sfx_worldmove.init(convertPath("sfx/packs/mapmove.ogg", soundpack), true);
+    sfx_treasurechest.init(convertPath("sfx/packs/treasurechest.ogg", soundpack), true);
+    sfx_flamecannon.init(convertPath("sfx/packs/flamecannon.ogg", soundpack), true);
+    sfx_wand.init(convertPath("sfx/packs/wand.ogg", soundpack), true);
+    sfx_enterstage.init(convertPath("sfx/packs/enter-stage.ogg", soundpack), true);
+    sfx_gameover.init(convertPath("sfx/packs/gameover.ogg", soundpack), true);
     sfx_pickup.init(convertPath("sfx/packs/pickup.ogg", soundpack));
 
     game_values.soundcapable = true;
@@ -10,6 +10,8 @@
 
 class CResourceManager {
 public:
+	CResourceManager();
+
 	bool LoadFullSkin(gfxSprite ** sprites, short skinID, short colorID);
 	bool LoadFullSkin(gfxSprite ** sprites, const std::string& filename, short colorID);
 
@@ -19,11 +21,22 @@ public:
 	void LoadAllGraphics();
 	bool LoadMenuGraphics();
 	bool LoadGameGraphics();
+	bool LoadMatchGraphics();
+
+	//Load a group the first time it's needed, later calls do nothing
+	bool RequireWorldGraphics();
+	bool RequireMatchGraphics();
+
+	//Loads every group now instead of on first use
+	void PreloadGraphics();
 
 	bool LoadGameSounds();
 
 private:
-	void LoadAllSprites();
+	void LoadSharedSprites();
+
+	bool fWorldGraphicsLoaded;
+	bool fMatchGraphicsLoaded;
 
 public:
 
@@ -0,0 +1,77 @@
+#include "RingBuffer.h"
+
+#include <cstring>
+
+#ifdef SMW_HAVE_THREADS
+    #define LOAD_OWN(pos)           (pos).load(std::memory_order_relaxed)
+    #define LOAD_OTHER(pos)         (pos).load(std::memory_order_acquire)
+    #define STORE(pos, value)       (pos).store(value, std::memory_order_release)
+#else
+    #define LOAD_OWN(pos)           (pos)
+    #define LOAD_OTHER(pos)         (pos)
+    #define STORE(pos, value)       (pos) = (value)
+#endif
+
+CRingBuffer::CRingBuffer(size_t iRequested)
+{
+    iCapacity = 1;
+    while (iCapacity < iRequested)
+        iCapacity <<= 1;
+
+    buffer = new uint8_t[iCapacity];
+
+    STORE(iReadPos, 0);
+    STORE(iWritePos, 0);
+}
+
+CRingBuffer::~CRingBuffer()
+{
+    delete [] buffer;
+}
+
+size_t CRingBuffer::readable() const
+{
+    return LOAD_OTHER(iWritePos) - LOAD_OTHER(iReadPos);
+}
+
+size_t CRingBuffer::write(const void * data, size_t iSize)
+{
+    size_t iWrite = LOAD_OWN(iWritePos);
+    size_t iFree = iCapacity - (iWrite - LOAD_OTHER(iReadPos));
+
+    if (iSize > iFree)
+        iSize = iFree;
+
+    size_t iStart = iWrite & (iCapacity - 1);
+    size_t iFirst = iCapacity - iStart < iSize ? iCapacity - iStart : iSize;
+
+    memcpy(buffer + iStart, data, iFirst);
+    memcpy(buffer, (const uint8_t *)data + iFirst, iSize - iFirst);
+
+    STORE(iWritePos, iWrite + iSize);
+    return iSize;
+}
+
+size_t CRingBuffer::read(void * data, size_t iSize)
+{
+    size_t iRead = LOAD_OWN(iReadPos);
+    size_t iAvailable = LOAD_OTHER(iWritePos) - iRead;
+
+    if (iSize > iAvailable)
+        iSize = iAvailable;
+
+    size_t iStart = iRead & (iCapacity - 1);
+    size_t iFirst = iCapacity - iStart < iSize ? iCapacity - iStart : iSize;
+
+    memcpy(data, buffer + iStart, iFirst);
+    memcpy((uint8_t *)data + iFirst, buffer, iSize - iFirst);
+
+    STORE(iReadPos, iRead + iSize);
+    return iSize;
+}
+
+void CRingBuffer::clear()
+{
+    STORE(iReadPos, 0);
+    STORE(iWritePos, 0);
+}
@@ -0,0 +1,54 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef SMW_HAVE_THREADS
+    #include <atomic>
+#endif
+
+//A fixed size byte queue between exactly one writing and one reading thread.
+//Neither side locks: each only advances its own position and reads the
+//other's, so a reader never waits on a writer that is busy.
+class CRingBuffer
+{
+    public:
+        //iCapacity is rounded up to a power of two
+        CRingBuffer(size_t iCapacity);
+        ~CRingBuffer();
+
+        //Both copy as much as fits or is there and return how much that was
+        size_t write(const void * data, size_t iSize);
+        size_t read(void * data, size_t iSize);
+
+        size_t readable() const;
+        size_t writable() const {
+            return iCapacity - readable();
+        }
+
+        size_t capacity() const {
+            return iCapacity;
+        }
+
+        //Only while neither side uses the buffer
+        void clear();
+
+    private:
+        uint8_t * buffer;
+        size_t iCapacity;
+
+        //Positions run freely and are masked on access, so full and empty differ
+#ifdef SMW_HAVE_THREADS
+        std::atomic<size_t> iReadPos;
+        std::atomic<size_t> iWritePos;
+#else
+        volatile size_t iReadPos;
+        volatile size_t iWritePos;
+#endif
+
+        CRingBuffer(CRingBuffer const&);
+        void operator=(CRingBuffer const&);
+};
+
+#endif // RINGBUFFER_H
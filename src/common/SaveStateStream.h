@@ -0,0 +1,72 @@
+#ifndef SAVESTATESTREAM_H
+#define SAVESTATESTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//One stream type for both writing and reading save states. The same sync()
+//calls drive both directions, so the save and load layouts can't drift apart.
+class SaveStateStream
+{
+    public:
+        enum Mode {
+            mode_save,
+            mode_load
+        };
+
+        SaveStateStream(Mode mode, uint8_t * buffer, size_t size) {
+            iMode = mode;
+            pBuffer = buffer;
+            iSize = size;
+            iPosition = 0;
+            fFailed = false;
+        }
+
+        bool isLoading() const {
+            return iMode == mode_load;
+        }
+
+        bool failed() const {
+            return fFailed;
+        }
+
+        size_t position() const {
+            return iPosition;
+        }
+
+        void fail() {
+            fFailed = true;
+        }
+
+        void raw(void * data, size_t size) {
+            if (fFailed || iPosition + size > iSize) {
+                fFailed = true;
+                return;
+            }
+
+            if (iMode == mode_save)
+                memcpy(pBuffer + iPosition, data, size);
+            else
+                memcpy(data, pBuffer + iPosition, size);
+
+            iPosition += size;
+        }
+
+        template <class T> void sync(T& value) {
+            raw(&value, sizeof(T));
+        }
+
+        template <class T, size_t N> void sync(T (&values)[N]) {
+            raw(values, sizeof(T) * N);
+        }
+
+    private:
+        Mode        iMode;
+        uint8_t *   pBuffer;
+        size_t      iSize;
+        size_t      iPosition;
+        bool        fFailed;
+};
+
+#endif // SAVESTATESTREAM_H
@@ -0,0 +1,191 @@
+#include "SoundCache.h"
+
+#include "path.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef __LIBRETRO__
+    #include <file/file_path.h>
+    #include <streams/file_stream_transforms.h>
+#else
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
+#endif
+
+#define SOUNDCACHE_MAGIC        0x534d5043     //"SMPC"
+#define SOUNDCACHE_VERSION      1
+
+//Magic, version, stamp size, stamp, sample size, then the samples
+#define SOUNDCACHE_HEADER_SIZE(stamp)   (4 * sizeof(Uint32) + (stamp).size())
+
+CSoundCache g_soundcache;
+
+static void writeU32(std::vector<Uint8>& data, Uint32 value)
+{
+    const Uint8 * bytes = (const Uint8 *)&value;
+    data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+static Uint32 readU32(const Uint8 * data)
+{
+    Uint32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+//The mixer format and the name, size and hash of the file. An entry is valid
+//while this stays the same.
+static bool writeStamp(std::vector<Uint8>& data, const std::string& filename)
+{
+    int iFrequency, iChannels;
+    Uint16 iFormat;
+
+    if (!Mix_QuerySpec(&iFrequency, &iFormat, &iChannels))
+        return false;
+
+    FILE * fp = fopen(filename.c_str(), "rb");
+
+    if (!fp)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long iSize = ftell(fp);
+    fclose(fp);
+
+    uint64_t iHash = File_Hash(filename);
+
+    writeU32(data, iFrequency);
+    writeU32(data, iFormat);
+    writeU32(data, iChannels);
+
+    writeU32(data, (Uint32)filename.length());
+    data.insert(data.end(), filename.begin(), filename.end());
+
+    writeU32(data, (Uint32)iSize);
+    writeU32(data, (Uint32)(iHash >> 32));
+    writeU32(data, (Uint32)iHash);
+
+    return true;
+}
+
+CSoundCache::CSoundCache()
+{}
+
+void CSoundCache::setDirectory(const std::string& directory)
+{
+    sDirectory = directory;
+
+    if (sDirectory.empty())
+        return;
+
+#ifdef __LIBRETRO__
+    if (!path_is_directory(sDirectory.c_str()))
+        path_mkdir(sDirectory.c_str());
+#elif defined(_WIN32)
+    CreateDirectory(sDirectory.c_str(), NULL);
+#else
+    mkdir(sDirectory.c_str(), 0775);
+#endif
+}
+
+std::string CSoundCache::entryPath(const std::string& filename) const
+{
+    uint64_t iHash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < filename.length(); i++)
+        iHash = (iHash ^ (Uint8)filename[i]) * 1099511628211ULL;
+
+    char szName[32];
+    sprintf(szName, "%08x%08x.pcm", (unsigned int)(iHash >> 32), (unsigned int)iHash);
+
+    return sDirectory + szName;
+}
+
+Mix_Chunk * CSoundCache::load(const std::string& filename)
+{
+    if (!enabled())
+        return NULL;
+
+    std::vector<Uint8> stamp;
+    if (!writeStamp(stamp, filename))
+        return NULL;
+
+    FILE * fp = fopen(entryPath(filename).c_str(), "rb");
+
+    if (!fp)
+        return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    long iFileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    size_t iHeaderSize = SOUNDCACHE_HEADER_SIZE(stamp);
+
+    if (iFileSize <= (long)iHeaderSize) {
+        fclose(fp);
+        return NULL;
+    }
+
+    //The whole entry in one read, into the buffer the samples are played from
+    Uint8 * data = (Uint8 *)SDL_malloc(iFileSize);
+    bool fRead = data && fread(data, 1, iFileSize, fp) == (size_t)iFileSize;
+    fclose(fp);
+
+    Uint32 iSampleSize = (Uint32)(iFileSize - iHeaderSize);
+
+    if (!fRead || readU32(data) != SOUNDCACHE_MAGIC || readU32(data + 4) != SOUNDCACHE_VERSION ||
+        readU32(data + 8) != stamp.size() || memcmp(data + 12, &stamp[0], stamp.size()) != 0 ||
+        readU32(data + iHeaderSize - 4) != iSampleSize) {
+        SDL_free(data);
+        return NULL;
+    }
+
+    memmove(data, data + iHeaderSize, iSampleSize);
+
+    Mix_Chunk * chunk = (Mix_Chunk *)SDL_malloc(sizeof(Mix_Chunk));
+
+    if (!chunk) {
+        SDL_free(data);
+        return NULL;
+    }
+
+    //Owns its samples like the chunks from Mix_LoadWAV, so Mix_FreeChunk() frees both
+    chunk->allocated = 1;
+    chunk->abuf = data;
+    chunk->alen = iSampleSize;
+    chunk->volume = MIX_MAX_VOLUME;
+
+    return chunk;
+}
+
+void CSoundCache::store(const std::string& filename, Mix_Chunk * chunk)
+{
+    if (!enabled() || !chunk)
+        return;
+
+    std::vector<Uint8> stamp;
+    if (!writeStamp(stamp, filename))
+        return;
+
+    std::vector<Uint8> header;
+    writeU32(header, SOUNDCACHE_MAGIC);
+    writeU32(header, SOUNDCACHE_VERSION);
+    writeU32(header, (Uint32)stamp.size());
+    header.insert(header.end(), stamp.begin(), stamp.end());
+    writeU32(header, chunk->alen);
+
+    FILE * fp = fopen(entryPath(filename).c_str(), "wb");
+
+    if (!fp)
+        return;
+
+    fwrite(&header[0], 1, header.size(), fp);
+    fwrite(chunk->abuf, 1, chunk->alen, fp);
+    fclose(fp);
+}
@@ -0,0 +1,44 @@
+#ifndef SOUNDCACHE_H
+#define SOUNDCACHE_H
+
+#ifdef SDL2_USE_MIXERX
+  #include "SDL_mixer_ext.h"
+#else
+  #include "SDL_mixer.h"
+#endif
+
+#include <string>
+
+#define SOUNDCACHE_DIRECTORY    "soundcache/"   //Below the home (libretro save) directory
+
+//Keeps sound effects on disk the way the mixer plays them: decoded and
+//converted to its output format. Decoding the OGG files with the integer
+//decoder is a good part of startup on slow boards, reading the samples back
+//is not. An entry is only used while the size and content hash of its file
+//(which belongs to the current sound pack) and the mixer format are what
+//they were when it was written.
+class CSoundCache
+{
+    public:
+        CSoundCache();
+
+        //Empty turns the cache off
+        void setDirectory(const std::string& directory);
+
+        bool enabled() const {
+            return !sDirectory.empty();
+        }
+
+        //A new chunk with the samples of filename if there's a valid entry
+        Mix_Chunk * load(const std::string& filename);
+        void store(const std::string& filename, Mix_Chunk * chunk);
+
+    private:
+        std::string entryPath(const std::string& filename) const;
+
+        std::string sDirectory;
+};
+
+extern CSoundCache g_soundcache;
+
+#endif // SOUNDCACHE_H
@@ -0,0 +1,165 @@
+#include "WorkerThread.h"
+
+CWorkerThread::CWorkerThread()
+{
+    iPending = 0;
+
+#ifdef SMW_HAVE_THREADS
+    fBusy = false;
+    fQuit = false;
+#endif
+}
+
+CWorkerThread::~CWorkerThread()
+{
+    cancel();
+
+#ifdef SMW_HAVE_THREADS
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fQuit = true;
+        }
+
+        wake.notify_one();
+        thread.join();
+    }
+#endif
+}
+
+void CWorkerThread::push(const WorkerJob& work, const WorkerJob& done)
+{
+    Job job;
+    job.work = work;
+    job.done = done;
+
+    iPending++;
+
+#ifdef SMW_HAVE_THREADS
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+    }
+
+    //Started on first use so cores that never queue anything don't pay for it
+    if (!thread.joinable())
+        thread = std::thread(&CWorkerThread::run, this);
+
+    wake.notify_one();
+#else
+    jobs.push_back(job);
+#endif
+}
+
+void CWorkerThread::pump()
+{
+    std::deque<WorkerJob> dones;
+
+#ifdef SMW_HAVE_THREADS
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dones.swap(finished);
+    }
+#else
+    if (jobs.empty())
+        return;
+
+    Job job = jobs.front();
+    jobs.pop_front();
+
+    job.work();
+    dones.push_back(job.done);
+#endif
+
+    finish(dones);
+}
+
+void CWorkerThread::cancel()
+{
+    std::deque<WorkerJob> dones;
+
+#ifdef SMW_HAVE_THREADS
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        iPending -= (int)jobs.size();
+        jobs.clear();
+
+        while (fBusy)
+            idle.wait(lock);
+
+        dones.swap(finished);
+    }
+#else
+    iPending -= (int)jobs.size();
+    jobs.clear();
+#endif
+
+    finish(dones);
+}
+
+void CWorkerThread::wait()
+{
+    std::deque<WorkerJob> dones;
+
+#ifdef SMW_HAVE_THREADS
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (!jobs.empty() || fBusy)
+            idle.wait(lock);
+
+        dones.swap(finished);
+    }
+#else
+    while (!jobs.empty()) {
+        Job job = jobs.front();
+        jobs.pop_front();
+
+        job.work();
+        dones.push_back(job.done);
+    }
+#endif
+
+    finish(dones);
+}
+
+void CWorkerThread::finish(std::deque<WorkerJob>& dones)
+{
+    while (!dones.empty()) {
+        WorkerJob done = dones.front();
+        dones.pop_front();
+
+        iPending--;
+
+        if (done)
+            done();
+    }
+}
+
+#ifdef SMW_HAVE_THREADS
+void CWorkerThread::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        while (!fQuit && jobs.empty())
+            wake.wait(lock);
+
+        if (fQuit)
+            return;
+
+        Job job = jobs.front();
+        jobs.pop_front();
+        fBusy = true;
+
+        lock.unlock();
+        job.work();
+        lock.lock();
+
+        finished.push_back(job.done);
+        fBusy = false;
+        idle.notify_all();
+    }
+}
+#endif
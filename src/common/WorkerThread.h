@@ -0,0 +1,85 @@
+#ifndef WORKERTHREAD_H
+#define WORKERTHREAD_H
+
+#include <deque>
+#include <functional>
+
+#ifdef SMW_HAVE_THREADS
+    #include <condition_variable>
+    #include <mutex>
+    #include <thread>
+#endif
+
+typedef std::function<void()> WorkerJob;
+
+//Held by the work halves of different workers that must not run at the same
+//time. Without threads nothing runs at the same time anyway.
+#ifdef SMW_HAVE_THREADS
+    typedef std::mutex WorkerMutex;
+    typedef std::lock_guard<std::mutex> WorkerLock;
+#else
+    struct WorkerMutex {};
+    struct WorkerLock {
+        explicit WorkerLock(WorkerMutex&) {}
+    };
+#endif
+
+//Runs jobs one after the other away from the frame loop. A job comes in two
+//halves: work runs on the worker and must not touch anything the main thread
+//uses, done runs on the main thread from pump() and picks up the result.
+//Every job whose work has started gets its done called exactly once.
+//
+//Without SMW_HAVE_THREADS (platforms that have none) the jobs wait in the queue
+//and pump() runs one of them per call, so a burst of them is still spread
+//over several frames.
+class CWorkerThread
+{
+    public:
+        CWorkerThread();
+        ~CWorkerThread();
+
+        void push(const WorkerJob& work, const WorkerJob& done);
+
+        //Runs the done half of finished jobs, or one whole job without threads
+        void pump();
+
+        //Drops the jobs that haven't started and waits for the one that has
+        void cancel();
+
+        //Runs every queued job to the end, then their done halves
+        void wait();
+
+        //Number of jobs queued or running whose done hasn't been called yet
+        int pending() const {
+            return iPending;
+        }
+
+    private:
+        struct Job {
+            WorkerJob work;
+            WorkerJob done;
+        };
+
+        void finish(std::deque<WorkerJob>& dones);
+
+        std::deque<Job> jobs;
+        int iPending;
+
+#ifdef SMW_HAVE_THREADS
+        void run();
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+
+        std::deque<WorkerJob> finished;
+        bool fBusy;
+        bool fQuit;
+#endif
+
+        CWorkerThread(CWorkerThread const&);
+        void operator=(CWorkerThread const&);
+};
+
+#endif // WORKERTHREAD_H
@@ -455,7 +455,7 @@ EC_GravText::EC_GravText(gfxFont *nfont, short nx, short ny, const char *ntext,
     y = (float)ny;
     w = (short)font->getWidth(ntext);
 
-    text = new char[strlen(ntext)+1];
+    text = (char *)g_eyecandyheap.allocate(strlen(ntext)+1);
 
     //Test if we got the memory
     if (text)
@@ -491,7 +491,7 @@ void EC_GravText::draw()
 
 EC_GravText::~EC_GravText()
 {
-    delete [] text;
+    g_eyecandyheap.release(text);
     text = NULL;
 }
 
@@ -508,7 +508,7 @@ EC_Announcement::EC_Announcement(gfxFont *nfont, gfxSprite *nsprite, const char
 
     iy = y;
 
-    text = new char[strlen(ntext)+1];
+    text = (char *)g_eyecandyheap.allocate(strlen(ntext)+1);
 
     //Test if we got the memory
     if (text)
@@ -543,7 +543,7 @@ EC_Announcement::EC_Announcement(gfxFont *nfont, gfxSprite *nsprite, const char
 
 EC_Announcement::~EC_Announcement()
 {
-    delete [] text;
+    g_eyecandyheap.release(text);
     text = NULL;
 }
 
@@ -886,8 +886,6 @@ EC_SoulsAward::EC_SoulsAward(gfxSprite *nspr, gfxSprite *nspr2, short nx, short
     if (numSouls > MAXAWARDS)
         numSouls = MAXAWARDS;
 
-    id = new short[numSouls];
-
     for (short k = 0; k < numSouls; k++)
         id[k] = nSoulArray[k];
 
@@ -908,9 +906,7 @@ EC_SoulsAward::EC_SoulsAward(gfxSprite *nspr, gfxSprite *nspr2, short nx, short
 }
 
 EC_SoulsAward::~EC_SoulsAward()
-{
-    delete [] id;
-}
+{}
 
 void EC_SoulsAward::update()
 {
@@ -1,6 +1,7 @@
 #ifndef EYECANDY_H
 #define EYECANDY_H
 
+#include "GameplayHeap.h"
 #include "gfx.h"
 #include "GlobalConstants.h"
 
@@ -19,6 +20,9 @@ public:
     }
     virtual ~CEyecandy() {}
 
+    static void * operator new(size_t size) { return g_eyecandyheap.allocate(size); }
+    static void operator delete(void * ptr) { g_eyecandyheap.release(ptr); }
+
     virtual void update() = 0;
     virtual void draw() = 0;
 
@@ -352,7 +356,7 @@ private:
 
     short x, y;
     short numSouls;
-    short * id;
+    short id[MAXAWARDS];
     short ttl, timer, count;
     float speed;
 
@@ -449,6 +453,9 @@ public:
     Spotlight(short x, short y, short size);
     ~Spotlight() {}
 
+    static void * operator new(size_t size) { return g_gameplayheap.allocate(size); }
+    static void operator delete(void * ptr) { g_gameplayheap.release(ptr); }
+
     void Update();
     void UpdatePosition(short x, short y);
     void Draw();
@@ -482,6 +489,8 @@ public:
 private:
     std::vector<Spotlight*> spotlightList;
 
+    friend class SaveState;
+
 };
 
 #endif // EYECANDY_H
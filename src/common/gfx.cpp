@@ -1,13 +1,18 @@
 #include "gfx.h"
 
+#include "gfx/gfxImageBatch.h"
 #include "gfx/gfxSDL.h"
+#include "gfx/gfxSkinCache.h"
+#include "gfx/gfxSurfaceCache.h"
 
 #include "SDL_image.h"
 #include "sdl12wrapper.h"
 
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 extern void libretro_printf(const char *fmt, ...);
 
@@ -21,6 +26,109 @@ extern short y_shake;
 
 GraphicsSDL gfx;
 
+static bool g_fScreenPreserved = true;
+
+//Team colored images depend on it too
+static std::string g_sPalettePath;
+
+//One gfx_load* call: the files its image is made from and the sprites it
+//ends up in
+struct gfxImageLoad {
+    std::vector<std::string> sources;   //The image, then the palette if it's recolored
+    std::string variant;                //How the image is converted, for the surface cache
+    gfxSprite * sprites[4];
+    short iSprites;
+    bool fWrap;
+    bool fRuns;                         //Sheets nothing draws into, frames can be drawn from runs
+
+    bool fCached;
+    SDL_Surface * cached[4];            //Converted surfaces from the surface cache
+    SDL_Surface * decoded;              //Otherwise the image as decoded from its file
+};
+
+typedef std::shared_ptr<gfxImageLoad> gfxImageLoadPtr;
+
+//Converts a decoded image, NULL if decoding failed, into the load's sprites
+typedef std::function<bool(SDL_Surface *)> gfxImageConvert;
+
+static gfxImageLoadPtr gfx_imageload(const std::string& filename, gfxSprite ** sprites, short iSprites, bool fWrap, bool fRuns, bool fRecolored, const char * szVariant)
+{
+    gfxImageLoadPtr load(new gfxImageLoad());
+
+    load->sources.push_back(filename);
+    if (fRecolored)
+        load->sources.push_back(g_sPalettePath);
+
+    load->variant = szVariant;
+
+    for (short iSprite = 0; iSprite < iSprites; iSprite++)
+        load->sprites[iSprite] = sprites[iSprite];
+
+    load->iSprites = iSprites;
+    load->fWrap = fWrap;
+    load->fRuns = fRuns;
+    load->fCached = false;
+    load->decoded = NULL;
+
+    return load;
+}
+
+//The part that can run on the image batch workers
+static void gfx_readimage(gfxImageLoad * load)
+{
+    load->fCached = g_surfacecache.load(load->sources, load->variant, load->cached, load->iSprites);
+
+    if (!load->fCached)
+        load->decoded = IMG_Load(load->sources[0].c_str());
+}
+
+static bool gfx_finishimage(gfxImageLoad * load, const gfxImageConvert& convert)
+{
+    bool fRet = true;
+
+    if (load->fCached) {
+        for (short iSprite = 0; iSprite < load->iSprites; iSprite++)
+            load->sprites[iSprite]->setSurface(load->cached[iSprite]);
+    } else {
+        fRet = convert(load->decoded);
+
+        if (fRet && g_surfacecache.enabled()) {
+            SDL_Surface * surfaces[4];
+
+            for (short iSprite = 0; iSprite < load->iSprites; iSprite++)
+                surfaces[iSprite] = load->sprites[iSprite]->getSurface();
+
+            g_surfacecache.store(load->sources, load->variant, surfaces, load->iSprites);
+        }
+    }
+
+    if (fRet) {
+        for (short iSprite = 0; iSprite < load->iSprites; iSprite++) {
+            load->sprites[iSprite]->SetWrap(load->fWrap);
+            load->sprites[iSprite]->SetRuns(load->fRuns);
+        }
+    }
+
+    return fRet;
+}
+
+//Loads right away, or later from g_imagebatch.end() if a batch is open
+static bool gfx_loadsprites(const gfxImageLoadPtr& load, const gfxImageConvert& convert)
+{
+    if (g_imagebatch.active()) {
+        g_imagebatch.add([load]() {
+            gfx_readimage(load.get());
+        }, [load, convert]() {
+            return gfx_finishimage(load.get(), convert);
+        });
+
+        return true;
+    }
+
+    gfx_readimage(load.get());
+    return gfx_finishimage(load.get(), convert);
+}
+
 bool gfx_init(int w, int h, bool fullscreen) {
     return gfx.Init(fullscreen);
 }
@@ -45,8 +153,22 @@ void gfx_take_screenshot() {
     gfx.takeScreenshot();
 }
 
-void gfx_close() {}
+void gfx_setscreenpreserved(bool preserved) {
+    g_fScreenPreserved = preserved;
+}
+
+bool gfx_screenpreserved() {
+    return g_fScreenPreserved;
+}
+
+void gfx_close() {
+    g_skincache.clear();
+}
 bool gfx_loadpalette(const std::string& palette_path) {
+    //Cached skins were recolored with the old palette
+    g_skincache.clear();
+    g_sPalettePath = palette_path;
+
     return gfx.getPalette().load(palette_path.c_str());
 }
 
@@ -105,6 +227,8 @@ SDL_Surface * gfx_createskinsurface(
     short iGreenOffset = skin->format->Gshift >> 3;
     short iBlueOffset = skin->format->Bshift >> 3;
 
+    gfxPalette& palette = gfx.getPalette();
+
     for (int j = 0; j < 32; j++) {
         for (int i = 0; i < 32; i++) {
             if (reverse)
@@ -114,24 +238,18 @@ SDL_Surface * gfx_createskinsurface(
             Uint8 iColorByte2 = pixels[skincounter + iGreenOffset];
             Uint8 iColorByte3 = pixels[skincounter + iBlueOffset];
 
-            bool fFoundColor = false;
-            for (unsigned short m = 0; m < gfx.getPalette().colorCount(); m++) {
-                if (gfx.getPalette().matchesColorAtID(m, iColorByte1, iColorByte2, iColorByte3)) {
-                    for (unsigned short k = 0; k < loops; k++) {
-                        unsigned short base = tempcounter + k * byteperframe + reverseoffset;
-                        gfx.getPalette().copyColorSchemeTo(
-                            colorScheme, k, m,
-                            temppixels[base + iRedOffset],
-                            temppixels[base + iGreenOffset],
-                            temppixels[base + iBlueOffset]);
-                    }
-
-                    fFoundColor = true;
-                    break;
-                }
-            }
+            short iColorID = palette.findColorID(iColorByte1, iColorByte2, iColorByte3);
 
-            if (!fFoundColor) {
+            if (iColorID >= 0) {
+                for (unsigned short k = 0; k < loops; k++) {
+                    unsigned short base = tempcounter + k * byteperframe + reverseoffset;
+                    palette.copyColorSchemeTo(
+                        colorScheme, k, iColorID,
+                        temppixels[base + iRedOffset],
+                        temppixels[base + iGreenOffset],
+                        temppixels[base + iBlueOffset]);
+                }
+            } else {
                 for (int k = 0; k < loops; k++) {
                     temppixels[tempcounter + k * byteperframe + reverseoffset + iRedOffset] = iColorByte1;
                     temppixels[tempcounter + k * byteperframe + reverseoffset + iGreenOffset] = iColorByte2;
@@ -172,44 +290,71 @@ SDL_Surface * gfx_createskinsurface(
 }
 
 
-bool gfx_loadmenuskin(gfxSprite ** gSprite, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, short colorScheme, bool fLoadBothDirections)
+//Recolored skin frame from the skin cache, or made from the skin file when it
+//isn't cached. The file is only loaded on the first miss and handed back in
+//skin for the caller to free.
+static SDL_Surface * gfx_getskinsurface(SDL_Surface *& skin, const std::string& filename, short spriteindex, Uint8 r, Uint8 g, Uint8 b, short colorScheme, bool reverse)
 {
-    // Load the BMP file into a surface
-    SDL_Surface * skin = IMG_Load(filename.c_str());
+    gfxSkinKey key;
+    key.path = filename;
+    key.spriteindex = spriteindex;
+    key.colorScheme = colorScheme;
+    key.reverse = reverse;
+    key.colorkey = ((Uint32)r << 16) | ((Uint32)g << 8) | b;
 
-    if (!skin) {
-        libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), SDL_GetError());
-        return false;
-    }
+    SDL_Surface * skinSurface = g_skincache.find(key);
 
-    if (!ValidSkinSurface(skin))
-        return false;
+    if (skinSurface)
+        return skinSurface;
 
-    for (short iSprite = 0; iSprite < 2; iSprite++) {
-        SDL_Surface * skinSurface = gfx_createskinsurface(skin, iSprite, r, g, b, colorScheme, true, false);
+    if (!skin) {
+        // Load the BMP file into a surface
+        skin = IMG_Load(filename.c_str());
 
-        if (skinSurface == NULL) {
-            libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
-            return false;
+        if (!skin) {
+            libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), SDL_GetError());
+            return NULL;
         }
 
-        gSprite[iSprite * 2]->setSurface(skinSurface);
+        if (!ValidSkinSurface(skin)) {
+            SDL_FreeSurface(skin);
+            skin = NULL;
+            return NULL;
+        }
     }
 
-    if (fLoadBothDirections) {
+    skinSurface = gfx_createskinsurface(skin, spriteindex, r, g, b, colorScheme, true, reverse);
+
+    if (skinSurface)
+        g_skincache.insert(key, skinSurface);
+
+    return skinSurface;
+}
+
+bool gfx_loadmenuskin(gfxSprite ** gSprite, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, short colorScheme, bool fLoadBothDirections)
+{
+    SDL_Surface * skin = NULL;
+
+    for (short iDirection = 0; iDirection < (fLoadBothDirections ? 2 : 1); iDirection++) {
         for (short iSprite = 0; iSprite < 2; iSprite++) {
-            SDL_Surface * skinSurface = gfx_createskinsurface(skin, iSprite, r, g, b, colorScheme, true, true);
+            SDL_Surface * skinSurface = gfx_getskinsurface(skin, filename, iSprite, r, g, b, colorScheme, iDirection != 0);
 
             if (skinSurface == NULL) {
                 libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
+
+                if (skin)
+                    SDL_FreeSurface(skin);
+
                 return false;
             }
 
-            gSprite[iSprite * 2 + 1]->setSurface(skinSurface);
+            gSprite[iSprite * 2 + iDirection]->setSurface(skinSurface);
+            gSprite[iSprite * 2 + iDirection]->SetRuns(true);
         }
     }
 
-    SDL_FreeSurface(skin);
+    if (skin)
+        SDL_FreeSurface(skin);
 
     return true;
 }
@@ -217,143 +362,79 @@ bool gfx_loadmenuskin(gfxSprite ** gSprite, const std::string& filename, Uint8 r
 
 bool gfx_loadfullskin(gfxSprite ** gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, short colorScheme)
 {
-    // Load the BMP file into a surface
-    SDL_Surface * skin = IMG_Load(filename.c_str());
+    SDL_Surface * skin = NULL;
 
-    if (!skin) {
-        libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), SDL_GetError());
-        return false;
-    }
+    //Four frames facing both ways, then dead flying and dead stomped
+    for (short iSprite = 0; iSprite < 10; iSprite++) {
+        short iFrame = iSprite < 8 ? iSprite >> 1 : iSprite - 4;
+        bool fReverse = iSprite < 8 && (iSprite & 1) != 0;
 
-    if (!ValidSkinSurface(skin))
-        return false;
+        SDL_Surface * skinSurface = gfx_getskinsurface(skin, filename, iFrame, r, g, b, colorScheme, fReverse);
 
-    for (short k = 0; k < 4; k++) {
-        for (short j = 0; j < 2; j++) {
-            SDL_Surface * skinSurface = gfx_createskinsurface(skin, k, r, g, b, colorScheme, true, j != 0);
+        if (skinSurface == NULL) {
+            libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
 
-            if (skinSurface == NULL) {
-                libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
+            if (skin)
                 SDL_FreeSurface(skin);
-                return false;
-            }
 
-            gSprites[(k * 2) + j]->setSurface(skinSurface);
+            return false;
         }
-    }
 
-    //Dead Flying Sprite
-    SDL_Surface * skinSurface = gfx_createskinsurface(skin, 4, r, g, b, colorScheme, true, false);
-
-    if (skinSurface == NULL) {
-        libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
-        SDL_FreeSurface(skin);
-        return false;
-    }
-
-    gSprites[8]->setSurface(skinSurface);
-
-    //Dead Stomped Sprite
-    skinSurface = gfx_createskinsurface(skin, 5, r, g, b, colorScheme, true, false);
-
-    if (skinSurface == NULL) {
-        libretro_printf("\n ERROR: Couldn't create menu skin from %s: %s\n", filename.c_str(), SDL_GetError());
-        return false;
+        gSprites[iSprite]->setSurface(skinSurface);
+        gSprites[iSprite]->SetRuns(true);
     }
 
-    gSprites[9]->setSurface(skinSurface);
-
-    SDL_FreeSurface(skin);
+    if (skin)
+        SDL_FreeSurface(skin);
 
     return true;
 }
 
-SDL_Surface * gfx_createteamcoloredsurface(SDL_Surface * sImage, short iColor, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+//Recolors sImage for several teams in one pass over its pixels. Team
+//iTeams[k] is written to dstpixels[k]; all destinations share dstpitch.
+static void gfx_recolorteams(SDL_Surface * sImage, Uint8 ** dstpixels, int dstpitch, const short * iTeams, short iTeamCount)
 {
-    SDL_Surface * sTempImage = SDL_CreateRGBSurface(sImage->flags, iColor == -2 ? sImage->w << 2 : sImage->w, iColor == -1 ? sImage->h << 2 : sImage->h, sImage->format->BitsPerPixel, sImage->format->Rmask, sImage->format->Gmask, sImage->format->Bmask, sImage->format->Amask);
-
-    //Take the loaded image and colorize it
-    if (SDL_MUSTLOCK(sTempImage))
-        SDL_LockSurface(sTempImage);
-
-    if (SDL_MUSTLOCK(sImage))
-        SDL_LockSurface(sImage);
-
-    //Need two counters because the pitch of the surfaces could be different
-    int iSrcPixelCounter = 0;
-    int iDstPixelCounter = 0;
-
-    int iNextImageOffset = 0;
-
-    if (iColor == -1)
-        iNextImageOffset = sImage->pitch * sImage->h;
-    else if (iColor == -2)
-        iNextImageOffset = sImage->w * 3;
+    gfxPalette& palette = gfx.getPalette();
 
     Uint8 * pixels = (Uint8*)sImage->pixels;
-    Uint8 * temppixels = (Uint8*)sTempImage->pixels;
 
     //Adjust what order we grab the pixels based on where R, G and B are
     short iRedOffset = sImage->format->Rshift >> 3;
     short iGreenOffset = sImage->format->Gshift >> 3;
     short iBlueOffset = sImage->format->Bshift >> 3;
 
-    for (unsigned short j = 0; j < sImage->w; j++) {
-        for (unsigned short i = 0; i < sImage->h; i++) {
+    for (int j = 0; j < sImage->h; j++) {
+        //Need two counters because the pitch of the surfaces could be different
+        int iSrcPixelCounter = j * sImage->pitch;
+        int iDstPixelCounter = j * dstpitch;
+
+        for (int i = 0; i < sImage->w; i++) {
             Uint8 iColorByte1 = pixels[iSrcPixelCounter + iRedOffset];
             Uint8 iColorByte2 = pixels[iSrcPixelCounter + iGreenOffset];
             Uint8 iColorByte3 = pixels[iSrcPixelCounter + iBlueOffset];
 
-            bool fFoundColor = false;
-            for (unsigned short m = 0; m < gfx.getPalette().colorCount(); m++) {
-                if (gfx.getPalette().matchesColorAtID(m, iColorByte1, iColorByte2, iColorByte3)) {
-                    if (iColor < 0) {
-                        for (unsigned short iTeam = 0; iTeam < 4; iTeam++) {
-                            unsigned short base = iDstPixelCounter + iNextImageOffset * iTeam;
-                            gfx.getPalette().copyColorSchemeTo(
-                                iTeam, 0, m,
-                                temppixels[base + iRedOffset],
-                                temppixels[base + iGreenOffset],
-                                temppixels[base + iBlueOffset]);
-                        }
-                    } else {
-                        gfx.getPalette().copyColorSchemeTo(
-                            iColor, 0, m,
-                            temppixels[iDstPixelCounter + iRedOffset],
-                            temppixels[iDstPixelCounter + iGreenOffset],
-                            temppixels[iDstPixelCounter + iBlueOffset]);
-                    }
-
-                    fFoundColor = true;
-                    break;
-                }
-            }
+            short iColorID = palette.findColorID(iColorByte1, iColorByte2, iColorByte3);
 
-            if (!fFoundColor) {
-                if (iColor < 0) {
-                    for (short iTeam = 0; iTeam < 4; iTeam++) {
-                        temppixels[iDstPixelCounter + iRedOffset + iNextImageOffset * iTeam] = iColorByte1;
-                        temppixels[iDstPixelCounter + iGreenOffset + iNextImageOffset * iTeam] = iColorByte2;
-                        temppixels[iDstPixelCounter + iBlueOffset + iNextImageOffset * iTeam] = iColorByte3;
-                    }
+            for (short k = 0; k < iTeamCount; k++) {
+                Uint8 * dst = dstpixels[k] + iDstPixelCounter;
+
+                if (iColorID >= 0) {
+                    palette.copyColorSchemeTo(iTeams[k], 0, iColorID, dst[iRedOffset], dst[iGreenOffset], dst[iBlueOffset]);
                 } else {
-                    temppixels[iDstPixelCounter + iRedOffset] = iColorByte1;
-                    temppixels[iDstPixelCounter + iGreenOffset] = iColorByte2;
-                    temppixels[iDstPixelCounter + iBlueOffset] = iColorByte3;
+                    dst[iRedOffset] = iColorByte1;
+                    dst[iGreenOffset] = iColorByte2;
+                    dst[iBlueOffset] = iColorByte3;
                 }
             }
 
             iSrcPixelCounter += 3;
             iDstPixelCounter += 3;
         }
-
-        iSrcPixelCounter += sImage->pitch - sImage->w * 3;
-        iDstPixelCounter += sTempImage->pitch - sImage->w * 3;
     }
+}
 
-    SDL_UnlockSurface(sImage);
-    SDL_UnlockSurface(sTempImage);
-
+static SDL_Surface * gfx_finishteamcoloredsurface(SDL_Surface * sTempImage, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
     if ( SDL_SETCOLORKEY(sTempImage, SDL_TRUE, SDL_MapRGB(sTempImage->format, r, g, b)) < 0 ) {
         libretro_printf("\n ERROR: Couldn't set ColorKey + RLE for new team colored surface: %s\n", SDL_GetError());
         return NULL;
@@ -380,40 +461,126 @@ SDL_Surface * gfx_createteamcoloredsurface(SDL_Surface * sImage, short iColor, U
     return sFinalImage;
 }
 
-bool gfx_loadteamcoloredimage(gfxSprite ** gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fWrap)
+SDL_Surface * gfx_createteamcoloredsurface(SDL_Surface * sImage, short iColor, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    SDL_Surface * sTempImage = SDL_CreateRGBSurface(sImage->flags, iColor == -2 ? sImage->w << 2 : sImage->w, iColor == -1 ? sImage->h << 2 : sImage->h, sImage->format->BitsPerPixel, sImage->format->Rmask, sImage->format->Gmask, sImage->format->Bmask, sImage->format->Amask);
+
+    //Take the loaded image and colorize it
+    if (SDL_MUSTLOCK(sTempImage))
+        SDL_LockSurface(sTempImage);
+
+    if (SDL_MUSTLOCK(sImage))
+        SDL_LockSurface(sImage);
+
+    Uint8 * temppixels = (Uint8*)sTempImage->pixels;
+
+    if (iColor < 0) {
+        //All four teams stacked below or next to each other
+        int iNextImageOffset = iColor == -1 ? sTempImage->pitch * sImage->h : sImage->w * 3;
+
+        short iTeams[4] = {0, 1, 2, 3};
+        Uint8 * dstpixels[4];
+
+        for (short iTeam = 0; iTeam < 4; iTeam++)
+            dstpixels[iTeam] = temppixels + iNextImageOffset * iTeam;
+
+        gfx_recolorteams(sImage, dstpixels, sTempImage->pitch, iTeams, 4);
+    } else {
+        gfx_recolorteams(sImage, &temppixels, sTempImage->pitch, &iColor, 1);
+    }
+
+    SDL_UnlockSurface(sImage);
+    SDL_UnlockSurface(sTempImage);
+
+    return gfx_finishteamcoloredsurface(sTempImage, r, g, b, a);
+}
+
+//Same as calling gfx_createteamcoloredsurface() for teams 0 to 3, but reads
+//sImage only once
+static bool gfx_createteamcoloredsurfaces(SDL_Surface * sImage, SDL_Surface * sTeamImages[4], Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
-    //Load the image into a surface
-    SDL_Surface * sImage = IMG_Load(filename.c_str());
+    SDL_Surface * sTempImages[4];
+    Uint8 * dstpixels[4];
+    short iTeams[4] = {0, 1, 2, 3};
+
+    for (short iTeam = 0; iTeam < 4; iTeam++) {
+        sTeamImages[iTeam] = NULL;
+        sTempImages[iTeam] = SDL_CreateRGBSurface(sImage->flags, sImage->w, sImage->h, sImage->format->BitsPerPixel, sImage->format->Rmask, sImage->format->Gmask, sImage->format->Bmask, sImage->format->Amask);
+
+        if (SDL_MUSTLOCK(sTempImages[iTeam]))
+            SDL_LockSurface(sTempImages[iTeam]);
+
+        dstpixels[iTeam] = (Uint8*)sTempImages[iTeam]->pixels;
+    }
+
+    if (SDL_MUSTLOCK(sImage))
+        SDL_LockSurface(sImage);
+
+    //The four surfaces were created alike, so they share a pitch
+    gfx_recolorteams(sImage, dstpixels, sTempImages[0]->pitch, iTeams, 4);
 
+    SDL_UnlockSurface(sImage);
+
+    bool fSuccess = true;
+    for (short iTeam = 0; iTeam < 4; iTeam++) {
+        SDL_UnlockSurface(sTempImages[iTeam]);
+
+        if (fSuccess) {
+            sTeamImages[iTeam] = gfx_finishteamcoloredsurface(sTempImages[iTeam], r, g, b, a);
+            fSuccess = sTeamImages[iTeam] != NULL;
+        } else {
+            SDL_FreeSurface(sTempImages[iTeam]);
+        }
+    }
+
+    if (!fSuccess) {
+        for (short iTeam = 0; iTeam < 4; iTeam++) {
+            if (sTeamImages[iTeam])
+                SDL_FreeSurface(sTeamImages[iTeam]);
+
+            sTeamImages[iTeam] = NULL;
+        }
+    }
+
+    return fSuccess;
+}
+
+static bool gfx_convertteamcoloredimage(SDL_Surface * sImage, gfxSprite ** gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
     if (sImage == NULL) {
         libretro_printf("\n ERROR: Couldn't load %s : %s\n", filename.c_str() , SDL_GetError());
         return false;
     }
 
-    for (short k = 0; k < 4; k++) {
-        SDL_Surface * sTeamColoredSurface = gfx_createteamcoloredsurface(sImage, k, r, g, b, a);
-
-        if (sTeamColoredSurface == NULL) {
-            libretro_printf("\n ERROR: Couldn't create menu skin from %s : %s\n", filename.c_str() , SDL_GetError());
-            SDL_FreeSurface(sTeamColoredSurface);
-            return false;
-        }
+    SDL_Surface * sTeamColoredSurfaces[4];
 
-        gSprites[k]->setSurface(sTeamColoredSurface);
-        gSprites[k]->SetWrap(fWrap);
+    if (!gfx_createteamcoloredsurfaces(sImage, sTeamColoredSurfaces, r, g, b, a)) {
+        libretro_printf("\n ERROR: Couldn't create menu skin from %s : %s\n", filename.c_str() , SDL_GetError());
+        SDL_FreeSurface(sImage);
+        return false;
     }
 
+    for (short k = 0; k < 4; k++)
+        gSprites[k]->setSurface(sTeamColoredSurfaces[k]);
+
     SDL_FreeSurface(sImage);
 
 
     return true;
 }
 
-bool gfx_loadteamcoloredimage(gfxSprite * gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fVertical, bool fWrap)
+bool gfx_loadteamcoloredimage(gfxSprite ** gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fWrap)
 {
-    //Load the image into a surface
-    SDL_Surface * sImage = IMG_Load(filename.c_str());
+    char szVariant[64];
+    sprintf(szVariant, "teams %02x%02x%02x %d", r, g, b, a);
+
+    return gfx_loadsprites(gfx_imageload(filename, gSprites, 4, fWrap, true, true, szVariant), [=](SDL_Surface * sImage) {
+        return gfx_convertteamcoloredimage(sImage, gSprites, filename, r, g, b, a);
+    });
+}
 
+static bool gfx_convertteamcoloredimage(SDL_Surface * sImage, gfxSprite * gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fVertical)
+{
     if (sImage == NULL) {
         libretro_printf("\n ERROR: Couldn't load %s : %s\n", filename.c_str() , SDL_GetError());
         return false;
@@ -428,13 +595,22 @@ bool gfx_loadteamcoloredimage(gfxSprite * gSprites, const std::string& filename,
     }
 
     gSprites->setSurface(sTeamColoredSurface);
-    gSprites->SetWrap(fWrap);
 
     SDL_FreeSurface(sImage);
 
     return true;
 }
 
+bool gfx_loadteamcoloredimage(gfxSprite * gSprites, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fVertical, bool fWrap)
+{
+    char szVariant[64];
+    sprintf(szVariant, "team %02x%02x%02x %d %s", r, g, b, a, fVertical ? "vertical" : "horizontal");
+
+    return gfx_loadsprites(gfx_imageload(filename, &gSprites, 1, fWrap, true, true, szVariant), [=](SDL_Surface * sImage) {
+        return gfx_convertteamcoloredimage(sImage, gSprites, filename, r, g, b, a, fVertical);
+    });
+}
+
 void gfx_setrect(SDL_Rect * rect, short x, short y, short w, short h)
 {
     rect->x = x;
@@ -604,7 +780,9 @@ bool gfx_loadteamcoloredimage(gfxSprite * gSprites, const std::string& filename,
 
 bool gfx_loadimagenocolorkey(gfxSprite * gSprite, const std::string& f)
 {
-    return gSprite->init(f);
+    return gfx_loadsprites(gfx_imageload(f, &gSprite, 1, gSprite->GetWrap(), false, false, "plain"), [=](SDL_Surface * image) {
+        return gSprite->init(image, f);
+    });
 }
 
 bool gfx_loadimage(gfxSprite * gSprite, const std::string& f, bool fWrap, bool fUseAccel)
@@ -614,20 +792,20 @@ bool gfx_loadimage(gfxSprite * gSprite, const std::string& f, bool fWrap, bool f
 
 bool gfx_loadimage(gfxSprite * gSprite, const std::string& f, Uint8 alpha, bool fWrap, bool fUseAccel)
 {
-    bool fRet = gSprite->init(f, 255, 0, 255, alpha, fUseAccel);
-
-    if (fRet)
-        gSprite->SetWrap(fWrap);
+    char szVariant[64];
+    sprintf(szVariant, "key ff00ff alpha %d %s", alpha, fUseAccel ? "rle" : "");
 
-    return fRet;
+    return gfx_loadsprites(gfx_imageload(f, &gSprite, 1, fWrap, false, false, szVariant), [=](SDL_Surface * image) {
+        return gSprite->init(image, f, 255, 0, 255, alpha, fUseAccel);
+    });
 }
 
 bool gfx_loadimage(gfxSprite * gSprite, const std::string& f, Uint8 r, Uint8 g, Uint8 b, bool fWrap, bool fUseAccel)
 {
-    bool fRet = gSprite->init(f, r, g, b, fUseAccel);
+    char szVariant[64];
+    sprintf(szVariant, "key %02x%02x%02x %s", r, g, b, fUseAccel ? "rle" : "");
 
-    if (fRet)
-        gSprite->SetWrap(fWrap);
-
-    return fRet;
+    return gfx_loadsprites(gfx_imageload(f, &gSprite, 1, fWrap, true, false, szVariant), [=](SDL_Surface * image) {
+        return gSprite->init(image, f, r, g, b, fUseAccel);
+    });
 }
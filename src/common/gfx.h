@@ -34,6 +34,11 @@ void gfx_settitle(const char*);
 void gfx_show_error(const char*);
 void gfx_take_screenshot();
 
+//The frontend may hand out a fresh buffer to draw each frame into, so what
+//was drawn the frame before is not always still on the screen
+void gfx_setscreenpreserved(bool preserved);
+bool gfx_screenpreserved();
+
 void gfx_close();
 bool gfx_loadpalette(const std::string& palette_path);
 
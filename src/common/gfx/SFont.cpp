@@ -26,6 +26,7 @@
 */
 
 #include "SFont.h"
+#include "gfxDirtyRects.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -153,6 +154,7 @@ void SFont_Write(SDL_Surface *Surface, const SFont_Font *Font,
 		dstrect.y = (Sint16)(y + y_shake);
 
 		SDL_BlitSurface(Font->Surface, &srcrect, Surface, &dstrect);
+		g_dirtyrects.mark(Surface, dstrect);
 
 		x += Font->CharPos[charoffset+1] - Font->CharPos[charoffset];
     }
@@ -275,6 +277,7 @@ void SFont_WriteChopRight(SDL_Surface *Surface, const SFont_Font *Font,
 		dstrect.y = (Sint16)(y + y_shake);
 
 		SDL_BlitSurface(Font->Surface, &srcrect, Surface, &dstrect);
+		g_dirtyrects.mark(Surface, dstrect);
 
 		x += width;
     }
@@ -332,6 +335,7 @@ void SFont_WriteChopLeft(SDL_Surface *Surface, const SFont_Font *Font,
 		//x -= (width - srcrect.w);
 
 		SDL_BlitSurface(Font->Surface, &srcrect, Surface, &dstrect);
+		g_dirtyrects.mark(Surface, dstrect);
 
     }
 }
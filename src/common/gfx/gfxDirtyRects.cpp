@@ -0,0 +1,89 @@
+#include "gfxDirtyRects.h"
+
+gfxDirtyRects g_dirtyrects;
+
+gfxDirtyRects::gfxDirtyRects()
+{
+    fEnabled = false;
+    fTracking = false;
+    fFullRestore = true;
+
+    pTarget = NULL;
+
+    iCount = 0;
+    iArea = 0;
+}
+
+void gfxDirtyRects::setEnabled(bool enabled)
+{
+    //Nothing was recorded while it was off
+    if (enabled && !fEnabled)
+        fFullRestore = true;
+
+    fEnabled = enabled;
+
+    if (!fEnabled)
+        fTracking = false;
+}
+
+bool gfxDirtyRects::restore(SDL_Surface * backmap, SDL_Surface * target, bool fTrackable)
+{
+    if (!fEnabled || !fTrackable || fFullRestore || target != pTarget)
+        return false;
+
+    for (short i = 0; i < iCount; i++) {
+        SDL_Rect src = rects[i];
+        SDL_Rect dst = rects[i];
+
+        SDL_BlitSurface(backmap, &src, target, &dst);
+    }
+
+    return true;
+}
+
+void gfxDirtyRects::beginFrame(SDL_Surface * target, bool fTrackable)
+{
+    pTarget = target;
+
+    iCount = 0;
+    iArea = 0;
+
+    //Whatever this frame does outside of mark() has to be wiped with a full copy
+    fFullRestore = !fTrackable;
+    fTracking = fEnabled && fTrackable;
+}
+
+void gfxDirtyRects::add(const SDL_Rect& rect)
+{
+    int iLeft = rect.x < 0 ? 0 : rect.x;
+    int iTop = rect.y < 0 ? 0 : rect.y;
+    int iRight = rect.x + rect.w > pTarget->w ? pTarget->w : rect.x + rect.w;
+    int iBottom = rect.y + rect.h > pTarget->h ? pTarget->h : rect.y + rect.h;
+
+    if (iLeft >= iRight || iTop >= iBottom)
+        return;
+
+    //Sprites that are drawn in several pieces (scoreboard, platforms) usually
+    //hit the same spot twice in a row
+    if (iCount > 0) {
+        SDL_Rect& last = rects[iCount - 1];
+
+        if (iLeft >= last.x && iTop >= last.y && iRight <= last.x + last.w && iBottom <= last.y + last.h)
+            return;
+    }
+
+    iArea += (iRight - iLeft) * (iBottom - iTop);
+
+    //Past this point a single full copy is cheaper than the pieces
+    if (iCount >= DIRTYRECTS_MAX || iArea >= pTarget->w * pTarget->h) {
+        fFullRestore = true;
+        fTracking = false;
+        return;
+    }
+
+    SDL_Rect& dirty = rects[iCount++];
+    dirty.x = (Sint16)iLeft;
+    dirty.y = (Sint16)iTop;
+    dirty.w = (Uint16)(iRight - iLeft);
+    dirty.h = (Uint16)(iBottom - iTop);
+}
@@ -0,0 +1,53 @@
+#ifndef GFX_DIRTYRECTS
+#define GFX_DIRTYRECTS
+
+#include "SDL.h"
+
+#define DIRTYRECTS_MAX 512
+
+//Remembers which parts of the screen were drawn over since the last frame, so
+//the next frame only has to copy the back map into those places instead of
+//over the whole screen. The drawing code reports every blit to the screen with
+//mark(). Frames that can't be followed this way (screen shake, tile animation
+//flips, effects that paint the screen directly) are drawn with a full copy, and
+//so is the frame after them.
+class gfxDirtyRects
+{
+public:
+    gfxDirtyRects();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return fEnabled; }
+
+    //Forces the next frame to copy the whole back map
+    void invalidate() { fFullRestore = true; }
+
+    //Copies the back map into everything marked since the last beginFrame().
+    //Returns false if that is not enough and the caller has to copy all of it.
+    bool restore(SDL_Surface * backmap, SDL_Surface * target, bool fTrackable);
+
+    //Starts collecting the rectangles of a new frame drawn into target
+    void beginFrame(SDL_Surface * target, bool fTrackable);
+
+    void mark(SDL_Surface * dst, const SDL_Rect& rect) {
+        if (fTracking && dst == pTarget)
+            add(rect);
+    }
+
+private:
+    void add(const SDL_Rect& rect);
+
+    bool fEnabled;
+    bool fTracking;
+    bool fFullRestore;
+
+    SDL_Surface * pTarget;
+
+    SDL_Rect rects[DIRTYRECTS_MAX];
+    short iCount;
+    int iArea;
+};
+
+extern gfxDirtyRects g_dirtyrects;
+
+#endif // GFX_DIRTYRECTS
@@ -0,0 +1,64 @@
+#include "gfxImageBatch.h"
+
+#ifdef SMW_HAVE_THREADS
+    #include <thread>
+#endif
+
+gfxImageBatch g_imagebatch;
+
+gfxImageBatch::gfxImageBatch()
+{
+    iDepth = 0;
+    iNextWorker = 0;
+    iWorkers = 1;
+
+#ifdef SMW_HAVE_THREADS
+    unsigned int iCores = std::thread::hardware_concurrency();
+
+    if (iCores > IMAGEBATCH_THREADS)
+        iCores = IMAGEBATCH_THREADS;
+
+    if (iCores > 1)
+        iWorkers = (short)iCores;
+#endif
+}
+
+gfxImageBatch::~gfxImageBatch()
+{
+    for (short iWorker = 0; iWorker < iWorkers; iWorker++)
+        workers[iWorker].cancel();
+}
+
+void gfxImageBatch::begin()
+{
+    iDepth++;
+}
+
+bool gfxImageBatch::end()
+{
+    if (iDepth == 0 || --iDepth > 0)
+        return true;
+
+    for (short iWorker = 0; iWorker < iWorkers; iWorker++)
+        workers[iWorker].wait();
+
+    bool fSuccess = true;
+
+    while (!finishes.empty()) {
+        gfxImageFinish finish = finishes.front();
+        finishes.pop_front();
+
+        fSuccess &= finish();
+    }
+
+    iNextWorker = 0;
+    return fSuccess;
+}
+
+void gfxImageBatch::add(const gfxImageRead& read, const gfxImageFinish& finish)
+{
+    finishes.push_back(finish);
+    workers[iNextWorker].push(read, WorkerJob());
+
+    iNextWorker = (iNextWorker + 1) % iWorkers;
+}
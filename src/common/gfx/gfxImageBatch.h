@@ -0,0 +1,57 @@
+#ifndef GFX_IMAGEBATCH
+#define GFX_IMAGEBATCH
+
+#include "WorkerThread.h"
+
+#include <deque>
+#include <functional>
+
+#define IMAGEBATCH_THREADS  4   //Past this the disk is the bottleneck, not the decoder
+
+//Reads an image from disk, on a worker while a batch is open
+typedef std::function<void()> gfxImageRead;
+
+//Makes sprites of what was read, always on the main thread. Returns whether
+//the image could be used.
+typedef std::function<bool()> gfxImageFinish;
+
+//Reads the images of a run of gfx_load* calls on several threads. Between
+//begin() and end() the loaders only queue their image and return right away,
+//then end() waits for the readers and finishes the images (converting them
+//to the display format) on the main thread, in the order they were queued.
+//
+//A sprite loaded inside a batch has no surface before end(), so the loads
+//that use a sprite right after loading it (tilesets, setalpha) stay outside.
+//Batches nest, only the outermost end() finishes the images.
+class gfxImageBatch
+{
+public:
+    gfxImageBatch();
+    ~gfxImageBatch();
+
+    void begin();
+
+    //Returns false if any of the images failed to load
+    bool end();
+
+    bool active() const {
+        return iDepth > 0;
+    }
+
+    void add(const gfxImageRead& read, const gfxImageFinish& finish);
+
+private:
+    std::deque<gfxImageFinish> finishes;
+    short iDepth;
+
+    CWorkerThread workers[IMAGEBATCH_THREADS];
+    short iWorkers;
+    short iNextWorker;
+
+    gfxImageBatch(gfxImageBatch const&);
+    void operator=(gfxImageBatch const&);
+};
+
+extern gfxImageBatch g_imagebatch;
+
+#endif // GFX_IMAGEBATCH
@@ -9,6 +9,9 @@ extern void libretro_printf(const char *fmt, ...);
 
 gfxPalette::gfxPalette()
     : numcolors(0)
+    , lookupkeys(NULL)
+    , lookupids(NULL)
+    , lookupmask(0)
 {
     for (int k = 0; k < 3; k++) {
         colorcodes[k] = NULL;
@@ -37,6 +40,42 @@ void gfxPalette::clear()
             }
         }
     }
+
+    delete [] lookupkeys;
+    lookupkeys = NULL;
+
+    delete [] lookupids;
+    lookupids = NULL;
+
+    lookupmask = 0;
+}
+
+void gfxPalette::buildLookup()
+{
+    uint32_t size = 16;
+    while (size < (uint32_t)numcolors * 2)
+        size <<= 1;
+
+    lookupkeys = new uint32_t[size];
+    lookupids = new unsigned short[size];
+    lookupmask = size - 1;
+
+    for (uint32_t slot = 0; slot < size; slot++)
+        lookupkeys[slot] = PALETTE_EMPTY_SLOT;
+
+    for (unsigned short id = 0; id < numcolors; id++) {
+        uint32_t key = ((uint32_t)colorcodes[0][id] << 16) | ((uint32_t)colorcodes[1][id] << 8) | colorcodes[2][id];
+        uint32_t slot = hashColor(key) & lookupmask;
+
+        while (lookupkeys[slot] != PALETTE_EMPTY_SLOT && lookupkeys[slot] != key)
+            slot = (slot + 1) & lookupmask;
+
+        //Same as scanning the palette: the first of two equal colors wins
+        if (lookupkeys[slot] == PALETTE_EMPTY_SLOT) {
+            lookupkeys[slot] = key;
+            lookupids[slot] = id;
+        }
+    }
 }
 
 bool gfxPalette::matchesColorAtID(unsigned short id, uint8_t r, uint8_t g, uint8_t b)
@@ -111,5 +150,7 @@ bool gfxPalette::load(const char* palette_path)
 
     SDL_FreeSurface(palette);
 
+    buildLookup();
+
     return true;
 }
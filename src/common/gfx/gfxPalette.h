@@ -5,6 +5,8 @@
 
 #define NUM_SCHEMES 9
 
+#define PALETTE_EMPTY_SLOT 0xFFFFFFFF
+
 class gfxPalette {
 public:
     gfxPalette();
@@ -14,16 +16,44 @@ public:
     void clear();
     unsigned short colorCount() { return numcolors; }
     bool matchesColorAtID(unsigned short id, uint8_t r, uint8_t g, uint8_t b);
+
+    //Index of the palette color r, g, b or -1 if it isn't in the palette
+    short findColorID(uint8_t r, uint8_t g, uint8_t b) const {
+        if (!lookupkeys)
+            return -1;
+
+        uint32_t key = ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+
+        for (uint32_t slot = hashColor(key) & lookupmask; ; slot = (slot + 1) & lookupmask) {
+            if (lookupkeys[slot] == key)
+                return lookupids[slot];
+
+            if (lookupkeys[slot] == PALETTE_EMPTY_SLOT)
+                return -1;
+        }
+    }
+
     void copyColorSchemeTo(
         unsigned short teamID, unsigned short schemeID, unsigned short colorID,
         uint8_t& r, uint8_t& g, uint8_t& b);
 
 private:
+    static uint32_t hashColor(uint32_t key) {
+        return (key * 2654435761u) >> 8;
+    }
+
+    void buildLookup();
+
     uint8_t* colorcodes[3]; //[colorcomponents][numcolors]
 
     //[numplayers][colorscheme][colorcomponents][numcolors]
     uint8_t* colorschemes[4][NUM_SCHEMES][3];
     unsigned short numcolors;
+
+    //Open addressing table from packed rgb to color id, at most half full
+    uint32_t* lookupkeys;
+    unsigned short* lookupids;
+    uint32_t lookupmask;
 };
 
 #endif // GFX_PALETTE
@@ -0,0 +1,96 @@
+#include "gfxSkinCache.h"
+
+gfxSkinCache g_skincache;
+
+bool gfxSkinKey::operator<(const gfxSkinKey& other) const
+{
+    if (spriteindex != other.spriteindex)
+        return spriteindex < other.spriteindex;
+
+    if (colorScheme != other.colorScheme)
+        return colorScheme < other.colorScheme;
+
+    if (reverse != other.reverse)
+        return reverse < other.reverse;
+
+    if (colorkey != other.colorkey)
+        return colorkey < other.colorkey;
+
+    return path < other.path;
+}
+
+gfxSkinCache::gfxSkinCache()
+    : iBudget(SKINCACHE_DEFAULT_BUDGET)
+    , iSize(0)
+{}
+
+gfxSkinCache::~gfxSkinCache()
+{
+    clear();
+}
+
+void gfxSkinCache::setBudget(size_t bytes)
+{
+    iBudget = bytes;
+    trim();
+}
+
+SDL_Surface * gfxSkinCache::find(const gfxSkinKey& key)
+{
+    std::map<gfxSkinKey, EntryList::iterator>::iterator found = index.find(key);
+
+    if (found == index.end())
+        return NULL;
+
+    //Move it to the front, the iterator in the index stays valid
+    entries.splice(entries.begin(), entries, found->second);
+
+    SDL_Surface * surface = found->second->surface;
+    surface->refcount++;
+    return surface;
+}
+
+void gfxSkinCache::insert(const gfxSkinKey& key, SDL_Surface * surface)
+{
+    size_t size = (size_t)surface->pitch * surface->h;
+
+    if (size > iBudget || index.find(key) != index.end())
+        return;
+
+    Entry entry;
+    entry.key = key;
+    entry.surface = surface;
+    entry.size = size;
+
+    surface->refcount++;
+
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    iSize += size;
+
+    trim();
+}
+
+void gfxSkinCache::trim()
+{
+    while (iSize > iBudget && !entries.empty()) {
+        Entry& oldest = entries.back();
+
+        //Sprites still drawing it keep their own reference
+        SDL_FreeSurface(oldest.surface);
+        iSize -= oldest.size;
+
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+}
+
+void gfxSkinCache::clear()
+{
+    for (EntryList::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+        SDL_FreeSurface(iter->surface);
+
+    entries.clear();
+    index.clear();
+    iSize = 0;
+}
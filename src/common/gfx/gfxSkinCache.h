@@ -0,0 +1,62 @@
+#ifndef GFX_SKINCACHE
+#define GFX_SKINCACHE
+
+#include "SDL.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+#define SKINCACHE_DEFAULT_BUDGET (8 * 1024 * 1024)
+
+//Cached frames are always made expanded, so that isn't part of the key
+struct gfxSkinKey {
+    std::string path;
+    short spriteindex;
+    short colorScheme;
+    bool reverse;
+    Uint32 colorkey;
+
+    bool operator<(const gfxSkinKey& other) const;
+};
+
+//Keeps recently recolored skin frames so flipping through skins or starting
+//another match doesn't decode and recolor the same files again. Surfaces are
+//shared through SDL's reference count: a surface returned by find() holds a
+//reference for the caller, which gives it back with SDL_FreeSurface() as
+//usual (gfxSprite does so when it lets go of its surface).
+class gfxSkinCache
+{
+public:
+    gfxSkinCache();
+    ~gfxSkinCache();
+
+    //Bytes of surfaces to hold on to, 0 turns the cache off
+    void setBudget(size_t bytes);
+
+    SDL_Surface * find(const gfxSkinKey& key);
+    void insert(const gfxSkinKey& key, SDL_Surface * surface);
+
+    void clear();
+
+private:
+    struct Entry {
+        gfxSkinKey key;
+        SDL_Surface * surface;
+        size_t size;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    void trim();
+
+    EntryList entries; //most recently used first
+    std::map<gfxSkinKey, EntryList::iterator> index;
+
+    size_t iBudget;
+    size_t iSize;
+};
+
+extern gfxSkinCache g_skincache;
+
+#endif // GFX_SKINCACHE
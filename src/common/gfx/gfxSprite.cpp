@@ -1,6 +1,7 @@
 #include "gfxSprite.h"
 
 #include "gfx.h"
+#include "gfxDirtyRects.h"
 
 #include "SDL_image.h"
 #include "sdl12wrapper.h"
@@ -42,6 +43,9 @@ void gfxSprite::clearSurface()
     iHiddenValue = 0;
 
     fWrap = false;
+
+    fRuns = false;
+    fRunsBuilt = false;
 }
 
 void gfxSprite::freeSurface()
@@ -50,22 +54,26 @@ void gfxSprite::freeSurface()
         SDL_FreeSurface(m_picture);
         m_picture = NULL;
     }
+
+    m_runs.clear();
+    fRunsBuilt = false;
 }
 
 //
 // Color keyed without alpha
 //
 bool gfxSprite::init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, bool fUseAccel)
+{
+    return init(IMG_Load(filename.c_str()), filename, r, g, b, fUseAccel);
+}
+
+bool gfxSprite::init(SDL_Surface * image, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, bool fUseAccel)
 {
     libretro_printf("loading sprite (mode 1) %s...",filename.c_str());
 
-    if (m_picture) {
-        SDL_FreeSurface(m_picture);
-        m_picture = NULL;
-    }
+    freeSurface();
 
-    // Load the BMP file into a surface
-    m_picture = IMG_Load(filename.c_str());
+    m_picture = image;
     if (!m_picture) {
         libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), IMG_GetError());
         return false;
@@ -101,16 +109,17 @@ bool gfxSprite::init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, boo
 // Color keyed + alpha
 //
 bool gfxSprite::init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fUseAccel)
+{
+    return init(IMG_Load(filename.c_str()), filename, r, g, b, a, fUseAccel);
+}
+
+bool gfxSprite::init(SDL_Surface * image, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fUseAccel)
 {
     libretro_printf("loading sprite (mode 2) %s...",filename.c_str());
 
-    if (m_picture) {
-        SDL_FreeSurface(m_picture);
-        m_picture = NULL;
-    }
+    freeSurface();
 
-    // Load the BMP file into a surface
-    m_picture = IMG_Load(filename.c_str());
+    m_picture = image;
     if (!m_picture) {
         libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), IMG_GetError());
         return false;
@@ -149,16 +158,17 @@ bool gfxSprite::init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uin
 // Non color keyed
 //
 bool gfxSprite::init(const std::string& filename)
+{
+    return init(IMG_Load(filename.c_str()), filename);
+}
+
+bool gfxSprite::init(SDL_Surface * image, const std::string& filename)
 {
     libretro_printf("loading sprite (mode 3) %s...",filename.c_str());
 
-    if (m_picture) {
-        SDL_FreeSurface(m_picture);
-        m_picture = NULL;
-    }
+    freeSurface();
 
-    // Load the BMP file into a surface
-    m_picture = IMG_Load(filename.c_str());
+    m_picture = image;
 
     if (!m_picture) {
         libretro_printf("\n ERROR: Couldn't load %s: %s\n", filename.c_str(), IMG_GetError());
@@ -202,6 +212,8 @@ bool gfxSprite::draw(short x, short y)
         return false;
     }
 
+    g_dirtyrects.mark(blitdest, m_bltrect);
+
     if (fWrap) {
         if (x + m_picture->w >= iWrapSize) {
             m_bltrect.x = x - iWrapSize + x_shake;
@@ -211,6 +223,8 @@ bool gfxSprite::draw(short x, short y)
                 libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
                 return false;
             }
+
+            g_dirtyrects.mark(blitdest, m_bltrect);
         } else if (x < 0) {
             m_bltrect.x = x + iWrapSize + x_shake;
             m_bltrect.y = y + y_shake;
@@ -219,12 +233,39 @@ bool gfxSprite::draw(short x, short y)
                 libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
                 return false;
             }
+
+            g_dirtyrects.mark(blitdest, m_bltrect);
         }
     }
 
     return true;
 }
 
+//Blits m_srcrect of the sprite to m_bltrect like SDL_BlitSurface does, through
+//the runs when the sprite uses them and they suit the target. The runs are
+//made here, so sheets only ever drawn whole never get any.
+bool gfxSprite::blitRect()
+{
+#ifndef USE_SDL2
+    if (fRuns && !fRunsBuilt) {
+        m_runs.build(m_picture);
+        fRunsBuilt = true;
+    }
+
+    if (m_runs.usable(m_picture, blitdest)) {
+        m_runs.blit(m_srcrect, blitdest, m_bltrect);
+        return true;
+    }
+#endif
+
+    if (SDL_BlitSurface(m_picture, &m_srcrect, blitdest, &m_bltrect) < 0) {
+        libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
 //TODO Perf Optimization: Set w/h once when sprite is initialized, set srcx/srcy just when animation frame advance happens
 bool gfxSprite::draw(short x, short y, short srcx, short srcy, short w, short h, short sHiddenDirection, short sHiddenValue)
 {
@@ -246,10 +287,10 @@ bool gfxSprite::draw(short x, short y, short srcx, short srcy, short w, short h,
     }
 
     // Blit onto the screen surface
-    if (SDL_BlitSurface(m_picture, &m_srcrect, blitdest, &m_bltrect) < 0) {
-        libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
+    if (!blitRect())
         return false;
-    }
+
+    g_dirtyrects.mark(blitdest, m_bltrect);
 
     if (fWrap) {
         if (x + w >= iWrapSize) {
@@ -261,10 +302,10 @@ bool gfxSprite::draw(short x, short y, short srcx, short srcy, short w, short h,
                     return true;
             }
 
-            if (SDL_BlitSurface(m_picture, &m_srcrect, blitdest, &m_bltrect) < 0) {
-                libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
+            if (!blitRect())
                 return false;
-            }
+
+            g_dirtyrects.mark(blitdest, m_bltrect);
         } else if (x < 0) {
             gfx_setrect(&m_srcrect, srcx, srcy, w, h);
             gfx_setrect(&m_bltrect, x + iWrapSize + x_shake, y + y_shake, w, h);
@@ -274,10 +315,10 @@ bool gfxSprite::draw(short x, short y, short srcx, short srcy, short w, short h,
                     return true;
             }
 
-            if (SDL_BlitSurface(m_picture, &m_srcrect, blitdest, &m_bltrect) < 0) {
-                libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
+            if (!blitRect())
                 return false;
-            }
+
+            g_dirtyrects.mark(blitdest, m_bltrect);
         }
     }
 
@@ -305,6 +346,8 @@ bool gfxSprite::drawStretch(short x, short y, short w, short h, short srcx, shor
         return false;
     }
 
+    g_dirtyrects.mark(blitdest, m_bltrect);
+
     return true;
 }
 
@@ -339,6 +382,17 @@ void gfxSprite::setSurface(SDL_Surface * surface)
     m_bltrect.h = (Uint16)m_picture->h;
 }
 
+void gfxSprite::SetRuns(bool runs)
+{
+    if (fRuns == runs)
+        return;
+
+    fRuns = runs;
+
+    m_runs.clear();
+    fRunsBuilt = false;
+}
+
 bool gfxSprite::GetWrap() {
     return fWrap;
 }
@@ -2,6 +2,7 @@
 #define GFX_SPRITE
 
 #include "SDL.h"
+#include "gfxSpriteRuns.h"
 
 #include <string>
 
@@ -16,6 +17,12 @@ public:
     bool init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, bool fUseAccel = true); //color keyed
     bool init(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fUseAccel = true); //color keyed + alpha
     bool init(const std::string& filename); //non color keyed
+
+    //Same as above with an image that was already decoded from filename, NULL
+    //if that failed. The sprite takes the image over.
+    bool init(SDL_Surface * image, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, bool fUseAccel = true);
+    bool init(SDL_Surface * image, const std::string& filename, Uint8 r, Uint8 g, Uint8 b, Uint8 a, bool fUseAccel = true);
+    bool init(SDL_Surface * image, const std::string& filename);
     bool initskin(const std::string& filename, Uint8 r, Uint8 g, Uint8 b, short colorscheme, bool expand);
 
     bool draw(short x, short y);
@@ -30,11 +37,18 @@ public:
     void setSurface(SDL_Surface * surface);
     SDL_Surface *getSurface();
 
+    //Lets frame draws go through opaque runs of the surface, made on the first
+    //one. The runs don't see later changes, so only for sheets loaded from a
+    //file that nothing draws into.
+    void SetRuns(bool runs);
+
     bool GetWrap();
     void SetWrap(bool wrap);
     void SetWrap(bool wrap, short wrapsize);
 
 private:
+    bool blitRect();
+
     SDL_Surface *m_picture;
     SDL_Rect m_bltrect;
     SDL_Rect m_srcrect;
@@ -45,6 +59,11 @@ private:
 
     bool fWrap;
     short iWrapSize;
+
+    //Opaque spans of color keyed sprites, made by the first frame draw
+    gfxSpriteRuns m_runs;
+    bool fRuns;
+    bool fRunsBuilt;
 };
 
 #endif // GFX_SPRITE
@@ -0,0 +1,175 @@
+#include "gfxSpriteRuns.h"
+
+#include <cstring>
+
+gfxSpriteRuns::gfxSpriteRuns()
+{
+    iWidth = 0;
+    iHeight = 0;
+
+    iColorKey = 0;
+    iRmask = 0;
+    iGmask = 0;
+    iBmask = 0;
+}
+
+void gfxSpriteRuns::clear()
+{
+    //swap() to give the memory back, clear() would keep it
+    std::vector<Run>().swap(runs);
+    std::vector<Uint32>().swap(rowstarts);
+    std::vector<Uint16>().swap(pixels);
+
+    iWidth = 0;
+    iHeight = 0;
+}
+
+void gfxSpriteRuns::build(SDL_Surface * surface)
+{
+    clear();
+
+    if (!surface || surface->format->BytesPerPixel != 2 || surface->w > 0xFFFF)
+        return;
+
+    if ((surface->flags & (SDL_SRCCOLORKEY | SDL_SRCALPHA)) != SDL_SRCCOLORKEY)
+        return;
+
+    //Decodes the surface again if SDL already RLE encoded it
+    if (SDL_LockSurface(surface) < 0)
+        return;
+
+    iWidth = surface->w;
+    iHeight = surface->h;
+
+    iColorKey = surface->format->colorkey;
+    iRmask = surface->format->Rmask;
+    iGmask = surface->format->Gmask;
+    iBmask = surface->format->Bmask;
+
+    Uint16 iKey = (Uint16)iColorKey;
+
+    rowstarts.reserve(iHeight + 1);
+
+    for (int iRow = 0; iRow < iHeight; iRow++) {
+        const Uint16 * row = (const Uint16 *)((const Uint8 *)surface->pixels + iRow * surface->pitch);
+
+        rowstarts.push_back((Uint32)runs.size());
+
+        int iCol = 0;
+        while (iCol < iWidth) {
+            while (iCol < iWidth && row[iCol] == iKey)
+                iCol++;
+
+            if (iCol == iWidth)
+                break;
+
+            Run run;
+            run.x = (Uint16)iCol;
+            run.offset = (Uint32)pixels.size();
+
+            while (iCol < iWidth && row[iCol] != iKey)
+                pixels.push_back(row[iCol++]);
+
+            run.length = (Uint16)(iCol - run.x);
+            runs.push_back(run);
+        }
+    }
+
+    rowstarts.push_back((Uint32)runs.size());
+
+    SDL_UnlockSurface(surface);
+}
+
+void gfxSpriteRuns::blit(const SDL_Rect& srcrect, SDL_Surface * dst, SDL_Rect& dstrect) const
+{
+    //Same clipping as SDL_UpperBlit(): first to the source, then to the clip rect
+    int srcx = srcrect.x;
+    int srcy = srcrect.y;
+    int w = srcrect.w;
+    int h = srcrect.h;
+
+    if (srcx < 0) {
+        w += srcx;
+        dstrect.x -= srcx;
+        srcx = 0;
+    }
+
+    if (w > iWidth - srcx)
+        w = iWidth - srcx;
+
+    if (srcy < 0) {
+        h += srcy;
+        dstrect.y -= srcy;
+        srcy = 0;
+    }
+
+    if (h > iHeight - srcy)
+        h = iHeight - srcy;
+
+    const SDL_Rect& clip = dst->clip_rect;
+
+    int dx = clip.x - dstrect.x;
+    if (dx > 0) {
+        w -= dx;
+        dstrect.x += dx;
+        srcx += dx;
+    }
+
+    dx = dstrect.x + w - clip.x - clip.w;
+    if (dx > 0)
+        w -= dx;
+
+    int dy = clip.y - dstrect.y;
+    if (dy > 0) {
+        h -= dy;
+        dstrect.y += dy;
+        srcy += dy;
+    }
+
+    dy = dstrect.y + h - clip.y - clip.h;
+    if (dy > 0)
+        h -= dy;
+
+    dstrect.w = 0;
+    dstrect.h = 0;
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    dstrect.w = w;
+    dstrect.h = h;
+
+    if (SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) < 0)
+        return;
+
+    int srcright = srcx + w;
+    Uint8 * dstrow = (Uint8 *)dst->pixels + dstrect.y * dst->pitch + dstrect.x * 2;
+
+    for (int iRow = srcy; iRow < srcy + h; iRow++, dstrow += dst->pitch) {
+        const Run * run = runs.data() + rowstarts[iRow];
+        const Run * end = runs.data() + rowstarts[iRow + 1];
+
+        //First run that reaches into the frame
+        int iCount = (int)(end - run);
+        while (iCount > 0) {
+            int iHalf = iCount >> 1;
+
+            if (run[iHalf].x + run[iHalf].length <= srcx) {
+                run += iHalf + 1;
+                iCount -= iHalf + 1;
+            } else {
+                iCount = iHalf;
+            }
+        }
+
+        for (; run < end && run->x < srcright; run++) {
+            int iLeft = run->x > srcx ? run->x : srcx;
+            int iRight = run->x + run->length < srcright ? run->x + run->length : srcright;
+
+            memcpy(dstrow + ((iLeft - srcx) << 1), &pixels[run->offset + iLeft - run->x], (iRight - iLeft) << 1);
+        }
+    }
+
+    if (SDL_MUSTLOCK(dst))
+        SDL_UnlockSurface(dst);
+}
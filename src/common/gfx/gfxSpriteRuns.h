@@ -0,0 +1,55 @@
+#ifndef GFX_SPRITERUNS
+#define GFX_SPRITERUNS
+
+#include "SDL.h"
+
+#include <vector>
+
+//The opaque pixels of a 16 bit color keyed surface as runs per row, with a
+//copy of their pixels. Drawing a frame out of a sprite sheet then copies only
+//the runs inside the frame, instead of testing every pixel against the key.
+//
+//The runs are made once when a sprite first draws a frame of its surface, so
+//they only suit surfaces that aren't drawn into afterwards. Sprites only use
+//them when the loader says so (gfxSprite::SetRuns()). Having a copy of the pixels
+//keeps them valid when SDL RLE encodes the surface and drops its own.
+class gfxSpriteRuns
+{
+public:
+    gfxSpriteRuns();
+
+    //Leaves the runs empty if surface isn't 16 bit, color keyed and without alpha
+    void build(SDL_Surface * surface);
+    void clear();
+
+    //Whether blit() can draw surface, the one the runs were made of, into dst
+    bool usable(SDL_Surface * surface, SDL_Surface * dst) const {
+        return !rowstarts.empty() && (surface->flags & (SDL_SRCCOLORKEY | SDL_SRCALPHA)) == SDL_SRCCOLORKEY &&
+            surface->format->colorkey == iColorKey && dst->format->BytesPerPixel == 2 &&
+            dst->format->Rmask == iRmask && dst->format->Gmask == iGmask && dst->format->Bmask == iBmask;
+    }
+
+    //Clips like SDL_BlitSurface and leaves the drawn area in dstrect
+    void blit(const SDL_Rect& srcrect, SDL_Surface * dst, SDL_Rect& dstrect) const;
+
+private:
+    struct Run {
+        Uint16 x;
+        Uint16 length;
+        Uint32 offset;  //Of its first pixel in pixels
+    };
+
+    std::vector<Run> runs;
+    std::vector<Uint32> rowstarts;  //First run of each row, then the end of the last row
+    std::vector<Uint16> pixels;
+
+    int iWidth;
+    int iHeight;
+
+    Uint32 iColorKey;
+    Uint32 iRmask;
+    Uint32 iGmask;
+    Uint32 iBmask;
+};
+
+#endif // GFX_SPRITERUNS
@@ -0,0 +1,286 @@
+#include "gfxSurfaceCache.h"
+
+#include "path.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef __LIBRETRO__
+    #include <file/file_path.h>
+    #include <streams/file_stream_transforms.h>
+#else
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
+#endif
+
+#define SURFACECACHE_MAGIC      0x534d5343     //"SMSC"
+#define SURFACECACHE_VERSION    1
+
+//Surface flags that are part of how a sprite was converted
+#define SURFACECACHE_FLAGS      (SDL_SRCCOLORKEY | SDL_RLEACCELOK | SDL_SRCALPHA)
+
+extern SDL_Surface * screen;
+
+gfxSurfaceCache g_surfacecache;
+
+static void writeU32(std::vector<Uint8>& data, Uint32 value)
+{
+    const Uint8 * bytes = (const Uint8 *)&value;
+    data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+static void writeBytes(std::vector<Uint8>& data, const void * bytes, size_t iSize)
+{
+    data.insert(data.end(), (const Uint8 *)bytes, (const Uint8 *)bytes + iSize);
+}
+
+static bool readU32(const std::vector<Uint8>& data, size_t& iPos, Uint32& value)
+{
+    if (data.size() - iPos < sizeof(value))
+        return false;
+
+    memcpy(&value, &data[iPos], sizeof(value));
+    iPos += sizeof(value);
+    return true;
+}
+
+static bool readBytes(const std::vector<Uint8>& data, size_t& iPos, const Uint8 *& bytes, size_t iSize)
+{
+    if (data.size() - iPos < iSize)
+        return false;
+
+    bytes = data.empty() ? NULL : &data[iPos];
+    iPos += iSize;
+    return true;
+}
+
+static long getFileSize(const std::string& filename)
+{
+    FILE * fp = fopen(filename.c_str(), "rb");
+
+    if (!fp)
+        return -1;
+
+    fseek(fp, 0, SEEK_END);
+    long iSize = ftell(fp);
+    fclose(fp);
+
+    return iSize;
+}
+
+static std::string entryKey(const std::vector<std::string>& sources, const std::string& variant)
+{
+    std::string key = variant;
+
+    for (size_t iSource = 0; iSource < sources.size(); iSource++)
+        key += "\n" + sources[iSource];
+
+    return key;
+}
+
+//Names, sizes and hashes of the files an entry was made from, and the screen
+//format it was converted to. An entry is valid while this stays the same.
+static bool writeStamp(std::vector<Uint8>& data, const std::vector<std::string>& sources, const std::string& variant)
+{
+    writeU32(data, screen->format->BitsPerPixel);
+    writeU32(data, screen->format->Rmask);
+    writeU32(data, screen->format->Gmask);
+    writeU32(data, screen->format->Bmask);
+
+    std::string key = entryKey(sources, variant);
+
+    writeU32(data, (Uint32)key.length());
+    writeBytes(data, key.c_str(), key.length());
+
+    for (size_t iSource = 0; iSource < sources.size(); iSource++) {
+        long iSize = getFileSize(sources[iSource]);
+
+        if (iSize < 0)
+            return false;
+
+        uint64_t iHash = File_Hash(sources[iSource]);
+
+        writeU32(data, (Uint32)iSize);
+        writeU32(data, (Uint32)(iHash >> 32));
+        writeU32(data, (Uint32)iHash);
+    }
+
+    return true;
+}
+
+gfxSurfaceCache::gfxSurfaceCache()
+{}
+
+void gfxSurfaceCache::setDirectory(const std::string& directory)
+{
+    sDirectory = directory;
+
+    if (sDirectory.empty())
+        return;
+
+#ifdef __LIBRETRO__
+    if (!path_is_directory(sDirectory.c_str()))
+        path_mkdir(sDirectory.c_str());
+#elif defined(_WIN32)
+    CreateDirectory(sDirectory.c_str(), NULL);
+#else
+    mkdir(sDirectory.c_str(), 0775);
+#endif
+}
+
+std::string gfxSurfaceCache::entryPath(const std::vector<std::string>& sources, const std::string& variant) const
+{
+    uint64_t iHash = 14695981039346656037ULL;
+
+    std::string key = entryKey(sources, variant);
+
+    for (size_t i = 0; i < key.length(); i++)
+        iHash = (iHash ^ (Uint8)key[i]) * 1099511628211ULL;
+
+    char szName[32];
+    sprintf(szName, "%08x%08x.bin", (unsigned int)(iHash >> 32), (unsigned int)iHash);
+
+    return sDirectory + szName;
+}
+
+bool gfxSurfaceCache::load(const std::vector<std::string>& sources, const std::string& variant, SDL_Surface ** surfaces, short iSurfaces)
+{
+#ifdef USE_SDL2
+    return false;
+#else
+    if (!enabled() || !screen)
+        return false;
+
+    //The whole entry in one read
+    FILE * fp = fopen(entryPath(sources, variant).c_str(), "rb");
+
+    if (!fp)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long iFileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    std::vector<Uint8> data(iFileSize > 0 ? iFileSize : 0);
+    bool fRead = !data.empty() && fread(&data[0], 1, data.size(), fp) == data.size();
+    fclose(fp);
+
+    if (!fRead)
+        return false;
+
+    std::vector<Uint8> stamp;
+    if (!writeStamp(stamp, sources, variant))
+        return false;
+
+    size_t iPos = 0;
+    Uint32 iMagic, iVersion, iStampSize, iCount;
+    const Uint8 * entrystamp;
+
+    if (!readU32(data, iPos, iMagic) || iMagic != SURFACECACHE_MAGIC ||
+        !readU32(data, iPos, iVersion) || iVersion != SURFACECACHE_VERSION ||
+        !readU32(data, iPos, iStampSize) || iStampSize != stamp.size() ||
+        !readBytes(data, iPos, entrystamp, iStampSize) || memcmp(entrystamp, &stamp[0], iStampSize) != 0 ||
+        !readU32(data, iPos, iCount) || iCount != (Uint32)iSurfaces)
+        return false;
+
+    short iLoaded = 0;
+
+    for (; iLoaded < iSurfaces; iLoaded++) {
+        Uint32 iWidth, iHeight, iPitch, iBpp, iRmask, iGmask, iBmask, iAmask, iFlags, iColorKey, iAlpha;
+        const Uint8 * pixels;
+
+        if (!readU32(data, iPos, iWidth) || !readU32(data, iPos, iHeight) || !readU32(data, iPos, iPitch) ||
+            !readU32(data, iPos, iBpp) || !readU32(data, iPos, iRmask) || !readU32(data, iPos, iGmask) ||
+            !readU32(data, iPos, iBmask) || !readU32(data, iPos, iAmask) || !readU32(data, iPos, iFlags) ||
+            !readU32(data, iPos, iColorKey) || !readU32(data, iPos, iAlpha) ||
+            !readBytes(data, iPos, pixels, (size_t)iPitch * iHeight))
+            break;
+
+        SDL_Surface * surface = SDL_CreateRGBSurface(SDL_SWSURFACE, iWidth, iHeight, iBpp, iRmask, iGmask, iBmask, iAmask);
+
+        if (!surface)
+            break;
+
+        Uint32 iRowSize = iWidth * surface->format->BytesPerPixel;
+
+        if (iRowSize > iPitch || iRowSize > surface->pitch) {
+            SDL_FreeSurface(surface);
+            break;
+        }
+
+        for (Uint32 iRow = 0; iRow < iHeight; iRow++)
+            memcpy((Uint8 *)surface->pixels + iRow * surface->pitch, pixels + iRow * iPitch, iRowSize);
+
+        Uint32 iAccel = (iFlags & SDL_RLEACCELOK) ? SDL_RLEACCEL : 0;
+        SDL_SetColorKey(surface, (iFlags & SDL_SRCCOLORKEY) | iAccel, iColorKey);
+        SDL_SetAlpha(surface, (iFlags & SDL_SRCALPHA) | iAccel, (Uint8)iAlpha);
+
+        surfaces[iLoaded] = surface;
+    }
+
+    if (iLoaded == iSurfaces)
+        return true;
+
+    while (iLoaded > 0)
+        SDL_FreeSurface(surfaces[--iLoaded]);
+
+    return false;
+#endif
+}
+
+void gfxSurfaceCache::store(const std::vector<std::string>& sources, const std::string& variant, SDL_Surface ** surfaces, short iSurfaces)
+{
+#ifndef USE_SDL2
+    if (!enabled() || !screen)
+        return;
+
+    std::vector<Uint8> stamp;
+    if (!writeStamp(stamp, sources, variant))
+        return;
+
+    std::vector<Uint8> data;
+    writeU32(data, SURFACECACHE_MAGIC);
+    writeU32(data, SURFACECACHE_VERSION);
+    writeU32(data, (Uint32)stamp.size());
+    writeBytes(data, &stamp[0], stamp.size());
+    writeU32(data, iSurfaces);
+
+    for (short iSurface = 0; iSurface < iSurfaces; iSurface++) {
+        SDL_Surface * surface = surfaces[iSurface];
+
+        if (!surface)
+            return;
+
+        //Decodes the surface again if it was RLE encoded by a blit
+        if (SDL_LockSurface(surface) < 0)
+            return;
+
+        writeU32(data, surface->w);
+        writeU32(data, surface->h);
+        writeU32(data, surface->pitch);
+        writeU32(data, surface->format->BitsPerPixel);
+        writeU32(data, surface->format->Rmask);
+        writeU32(data, surface->format->Gmask);
+        writeU32(data, surface->format->Bmask);
+        writeU32(data, surface->format->Amask);
+        writeU32(data, surface->flags & SURFACECACHE_FLAGS);
+        writeU32(data, surface->format->colorkey);
+        writeU32(data, surface->format->alpha);
+        writeBytes(data, surface->pixels, (size_t)surface->pitch * surface->h);
+
+        SDL_UnlockSurface(surface);
+    }
+
+    FILE * fp = fopen(entryPath(sources, variant).c_str(), "wb");
+
+    if (!fp)
+        return;
+
+    fwrite(&data[0], 1, data.size(), fp);
+    fclose(fp);
+#endif
+}
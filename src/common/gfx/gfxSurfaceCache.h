@@ -0,0 +1,42 @@
+#ifndef GFX_SURFACECACHE
+#define GFX_SURFACECACHE
+
+#include "SDL.h"
+
+#include <string>
+#include <vector>
+
+#define SURFACECACHE_DIRECTORY  "spritecache/"  //Below the home (libretro save) directory
+
+//Keeps sprites on disk the way they are after loading: converted to the
+//display format, recolored, with their color key and alpha set. An entry is
+//found by the files it was made from and how it was converted (variant), and
+//is only used while the size and content hash of every one of those files
+//and the display format are what they were when it was written.
+//
+//load() may run on the image batch workers, store() runs on the main thread.
+class gfxSurfaceCache
+{
+public:
+    gfxSurfaceCache();
+
+    //Empty turns the cache off
+    void setDirectory(const std::string& directory);
+
+    bool enabled() const {
+        return !sDirectory.empty();
+    }
+
+    //Fills surfaces with iSurfaces new surfaces if there's a valid entry
+    bool load(const std::vector<std::string>& sources, const std::string& variant, SDL_Surface ** surfaces, short iSurfaces);
+    void store(const std::vector<std::string>& sources, const std::string& variant, SDL_Surface ** surfaces, short iSurfaces);
+
+private:
+    std::string entryPath(const std::vector<std::string>& sources, const std::string& variant) const;
+
+    std::string sDirectory;
+};
+
+extern gfxSurfaceCache g_surfacecache;
+
+#endif // GFX_SURFACECACHE
@@ -14,6 +14,7 @@
 #include "SDL_image.h"
 #include "sdl12wrapper.h"
 
+#include <algorithm>
 #include <cmath>
 
 #if defined(__APPLE__)
@@ -54,9 +55,6 @@ extern SDL_Surface* screen;
 extern SDL_Surface* blitdest;
 
 extern CGameValues game_values;
-extern CMap* g_map;
-extern CTilesetManager* g_tilesetmanager;
-extern CResourceManager* rm;
 extern CGame* smw;
 
 extern GraphicsList* gamegraphicspacklist;
@@ -138,7 +136,17 @@ float dBulletBillFrequency[3] = {10.0f, 5.0f, 2.5f};
 
 short iPirhanaPlantOffsetY[4][3] = {{0, 0, 0}, {48, 24, 12}, {96, 48, 24}, {160, 80, 40}};
 
-void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
+//Like gfxSprite::draw(), but into the given surface and without touching any
+//shared state, so thumbnails can be drawn away from the main thread
+static void drawPreviewSprite(SDL_Surface * targetSurface, gfxSprite& sprite, short x, short y, short srcx, short srcy, short w, short h)
+{
+    SDL_Rect rSrc = {srcx, srcy, (Uint16)w, (Uint16)h};
+    SDL_Rect rDst = {x, y, (Uint16)w, (Uint16)h};
+
+    SDL_BlitSurface(sprite.getSurface(), &rSrc, targetSurface, &rDst);
+}
+
+void CMap::DrawMapHazard(SDL_Surface * targetSurface, MapHazard * hazard, short iSize, bool fDrawCenter)
 {
     short iSizeShift = 5 - iSize;
     short iTileSize = 1 << iSizeShift;
@@ -150,7 +158,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
 
     if (fDrawCenter) {
         if (hazard->itype <= 1) {
-            SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+            SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
         }
     }
 
@@ -163,7 +171,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
             rDotDst.y = (short)(dRadius * sin(dAngle)) + rPathDst.y + (iTileSize >> 1) - (iPlatformPathDotSize[iSize] >> 1);
             rDotDst.h = rDotDst.w = iPlatformPathDotSize[iSize];
 
-            rm->spr_platformpath.draw(rDotDst.x, rDotDst.y, rDotSrc.x, rDotSrc.y, rDotDst.w, rDotDst.h);
+            drawPreviewSprite(targetSurface, resources->spr_platformpath, rDotDst.x, rDotDst.y, rDotSrc.x, rDotSrc.y, rDotDst.w, rDotDst.h);
             dAngle += TWO_PI / iNumDots;
         }
 
@@ -172,7 +180,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
             short x = (hazard->ix << (iSizeShift - 1)) + (short)((float)(iFireball * (24 >> iSize)) * cos(hazard->dparam[1])) + (iTileSize >> 1) - (iFireballHazardSize[iSize] >> 1);
             short y = (hazard->iy << (iSizeShift - 1)) + (short)((float)(iFireball * (24 >> iSize)) * sin(hazard->dparam[1])) + (iTileSize >> 1) - (iFireballHazardSize[iSize] >> 1);
 
-            rm->spr_hazard_fireball[iSize].draw(x, y, 0, 0, iFireballHazardSize[iSize], iFireballHazardSize[iSize]);
+            drawPreviewSprite(targetSurface, resources->spr_hazard_fireball[iSize], x, y, 0, 0, iFireballHazardSize[iSize], iFireballHazardSize[iSize]);
         }
     } else if (hazard->itype == 1) { //rotodisc
         short iNumDots = 16;
@@ -183,7 +191,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
             rDotDst.y = (short)(dRadius * sin(dAngle)) + rPathDst.y + (iTileSize >> 1) - (iPlatformPathDotSize[iSize] >> 1);
             rDotDst.h = rDotDst.w = iPlatformPathDotSize[iSize];
 
-            rm->spr_platformpath.draw(rDotDst.x, rDotDst.y, rDotSrc.x, rDotSrc.y, rDotDst.w, rDotDst.h);
+            drawPreviewSprite(targetSurface, resources->spr_platformpath, rDotDst.x, rDotDst.y, rDotSrc.x, rDotSrc.y, rDotDst.w, rDotDst.h);
             dAngle += TWO_PI / iNumDots;
         }
 
@@ -195,12 +203,12 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
             short x = rPathDst.x + (short)(dRadius * cos(dAngle));
             short y = rPathDst.y + (short)(dRadius * sin(dAngle));
 
-            rm->spr_hazard_rotodisc[iSize].draw(x, y, 0, 0, iTileSize, iTileSize);
+            drawPreviewSprite(targetSurface, resources->spr_hazard_rotodisc[iSize], x, y, 0, 0, iTileSize, iTileSize);
 
             dAngle += dSector;
         }
     } else if (hazard->itype == 2) { //bullet bill
-        rm->spr_hazard_bulletbill[iSize].draw(rPathDst.x, rPathDst.y, 0, hazard->dparam[0] < 0.0f ? 0 : iTileSize, iTileSize, iTileSize);
+        drawPreviewSprite(targetSurface, resources->spr_hazard_bulletbill[iSize], rPathDst.x, rPathDst.y, 0, hazard->dparam[0] < 0.0f ? 0 : iTileSize, iTileSize, iTileSize);
 
         short iBulletPathX = rPathDst.x - iPlatformPathDotSize[iSize];
         if (hazard->dparam[0] > 0.0f)
@@ -209,7 +217,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
         short iBulletPathSpacing = (short)(hazard->dparam[0] * dBulletBillFrequency[iSize]);
         while (iBulletPathX >= 0 && iBulletPathX < smw->GetScreenWidth(iSize)) {
             gfx_setrect(&rDotDst, iBulletPathX, rPathDst.y + ((iTileSize - iPlatformPathDotSize[iSize]) >> 1), iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-            SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rDotSrc, blitdest, &rDotDst);
+            SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rDotSrc, targetSurface, &rDotDst);
 
             iBulletPathX += hazard->iparam[0] < 0.0f ? -iBulletPathSpacing : iBulletPathSpacing;
         }
@@ -225,7 +233,7 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
             iOffsetY = -(iTileSize << 1);
         }
 
-        rm->spr_hazard_flame[iSize].draw(rPathDst.x + iOffsetX, rPathDst.y + iOffsetY, rect->x >> iSize, rect->y >> iSize, rect->w >> iSize, rect->h >> iSize);
+        drawPreviewSprite(targetSurface, resources->spr_hazard_flame[iSize], rPathDst.x + iOffsetX, rPathDst.y + iOffsetY, rect->x >> iSize, rect->y >> iSize, rect->w >> iSize, rect->h >> iSize);
     } else if (hazard->itype >= 4 && hazard->itype <= 7) { //pirhana plants
         SDL_Rect * rect = &g_rPirhanaRects[hazard->itype - 4][hazard->iparam[1]][0];
         short iOffsetX = 0;
@@ -243,11 +251,11 @@ void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter)
                 iOffsetX = -(iTileSize >> 1);
         }
 
-        rm->spr_hazard_pirhanaplant[iSize].draw(rPathDst.x + iOffsetX, rPathDst.y + iOffsetY, rect->x >> iSize, rect->y >> iSize, rect->w >> iSize, rect->h >> iSize);
+        drawPreviewSprite(targetSurface, resources->spr_hazard_pirhanaplant[iSize], rPathDst.x + iOffsetX, rPathDst.y + iOffsetY, rect->x >> iSize, rect->y >> iSize, rect->w >> iSize, rect->h >> iSize);
     }
 }
 
-void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short startY, short endX, short endY, float angle, float radiusX, float radiusY, short iSize, short iPlatformWidth, short iPlatformHeight, bool fDrawPlatform, bool fDrawShadow)
+void CMap::DrawPlatform(SDL_Surface * targetSurface, short pathtype, TilesetTile ** tiles, short startX, short startY, short endX, short endY, float angle, float radiusX, float radiusY, short iSize, short iPlatformWidth, short iPlatformHeight, bool fDrawPlatform, bool fDrawShadow)
 {
     short iStartX = startX >> iSize;
     short iStartY = startY >> iSize;
@@ -276,14 +284,14 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
                     iDstY = iStartY + (iPlatformY << iSizeShift) - (iPlatformHeight << (iSizeShift - 1));
                 }
 
-                SDL_Rect bltrect = {iDstX, iDstY, iTileSize, iTileSize};
+                SDL_Rect rTileDst = {iDstX, iDstY, iTileSize, iTileSize};
                 if (tile->iID >= 0) {
-                    SDL_BlitSurface(g_tilesetmanager->GetTileset(tile->iID)->GetSurface(iSize), &g_tilesetmanager->rRects[iSize][tile->iCol][tile->iRow], blitdest, &bltrect);
+                    SDL_BlitSurface(tilesetmanager->GetTileset(tile->iID)->GetSurface(iSize), &tilesetmanager->rRects[iSize][tile->iCol][tile->iRow], targetSurface, &rTileDst);
                 } else if (tile->iID == TILESETANIMATED) {
-                    SDL_BlitSurface(rm->spr_tileanimation[iSize].getSurface(), &g_tilesetmanager->rRects[iSize][tile->iCol << 2][tile->iRow], blitdest, &bltrect);
+                    SDL_BlitSurface(resources->spr_tileanimation[iSize].getSurface(), &tilesetmanager->rRects[iSize][tile->iCol << 2][tile->iRow], targetSurface, &rTileDst);
                 } else if (tile->iID == TILESETUNKNOWN) {
                     //Draw unknown tile
-                    SDL_BlitSurface(rm->spr_unknowntile[iSize].getSurface(), &g_tilesetmanager->rRects[iSize][0][0], blitdest, &bltrect);
+                    SDL_BlitSurface(resources->spr_unknowntile[iSize].getSurface(), &tilesetmanager->rRects[iSize][0][0], targetSurface, &rTileDst);
                 }
 
                 bool fNeedWrap = false;
@@ -296,17 +304,17 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
                 }
 
                 if (fNeedWrap) {
-                    bltrect.x = iDstX;
-                    bltrect.y = iDstY;
-                    bltrect.w = iTileSize;
-                    bltrect.h = iTileSize;
+                    rTileDst.x = iDstX;
+                    rTileDst.y = iDstY;
+                    rTileDst.w = iTileSize;
+                    rTileDst.h = iTileSize;
 
                     if (tile->iID >= 0)
-                        SDL_BlitSurface(g_tilesetmanager->GetTileset(tile->iID)->GetSurface(iSize), &g_tilesetmanager->rRects[iSize][tile->iCol][tile->iRow], blitdest, &bltrect);
+                        SDL_BlitSurface(tilesetmanager->GetTileset(tile->iID)->GetSurface(iSize), &tilesetmanager->rRects[iSize][tile->iCol][tile->iRow], targetSurface, &rTileDst);
                     else if (tile->iID == TILESETANIMATED)
-                        SDL_BlitSurface(rm->spr_tileanimation[iSize].getSurface(), &g_tilesetmanager->rRects[iSize][tile->iCol << 2][tile->iRow], blitdest, &bltrect);
+                        SDL_BlitSurface(resources->spr_tileanimation[iSize].getSurface(), &tilesetmanager->rRects[iSize][tile->iCol << 2][tile->iRow], targetSurface, &rTileDst);
                     else if (tile->iID == TILESETUNKNOWN)
-                        SDL_BlitSurface(rm->spr_unknowntile[iSize].getSurface(), &g_tilesetmanager->rRects[iSize][0][0], blitdest, &bltrect);
+                        SDL_BlitSurface(resources->spr_unknowntile[iSize].getSurface(), &tilesetmanager->rRects[iSize][0][0], targetSurface, &rTileDst);
                 }
             }
         }
@@ -319,14 +327,14 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
             for (short iCol = 0; iCol < iPlatformWidth; iCol++) {
                 for (short iRow = 0; iRow < iPlatformHeight; iRow++) {
                     if (tiles[iCol][iRow].iID != -2)
-                        rm->spr_platformstarttile.draw(iStartX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iStartY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
+                        drawPreviewSprite(targetSurface, resources->spr_platformstarttile, iStartX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iStartY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
                 }
             }
 
             for (short iCol = 0; iCol < iPlatformWidth; iCol++) {
                 for (short iRow = 0; iRow < iPlatformHeight; iRow++) {
                     if (tiles[iCol][iRow].iID != -2)
-                        rm->spr_platformendtile.draw(iEndX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iEndY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
+                        drawPreviewSprite(targetSurface, resources->spr_platformendtile, iEndX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iEndY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
                 }
             }
         }
@@ -346,7 +354,7 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
 
         for (short iSpot = 0; iSpot < iNumSpots + 1; iSpot++) {
             gfx_setrect(&rPathDst, (short)dX, (short)dY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-            SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+            SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
 
             dX += dIncrementX;
             dY += dIncrementY;
@@ -356,7 +364,7 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
             for (short iCol = 0; iCol < iPlatformWidth; iCol++) {
                 for (short iRow = 0; iRow < iPlatformHeight; iRow++) {
                     if (tiles[iCol][iRow].iID != -2)
-                        rm->spr_platformstarttile.draw(iStartX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iStartY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
+                        drawPreviewSprite(targetSurface, resources->spr_platformstarttile, iStartX - (iPlatformWidth << (iSizeShift - 1)) + (iCol << iSizeShift), iStartY - (iPlatformHeight << (iSizeShift - 1)) + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
                 }
             }
         }
@@ -369,7 +377,7 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
 
         for (short iSpot = 0; iSpot < 50; iSpot++) {
             gfx_setrect(&rPathDst, (short)dX, (short)dY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-            SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+            SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
 
             short iWrapX = (short)dX;
             short iWrapY = (short)dY;
@@ -392,7 +400,7 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
 
             if (fNeedWrap) {
                 gfx_setrect(&rPathDst, iWrapX, iWrapY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-                SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+                SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
             }
 
             dX += dIncrementX;
@@ -407,7 +415,7 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
             for (short iCol = 0; iCol < iPlatformWidth; iCol++) {
                 for (short iRow = 0; iRow < iPlatformHeight; iRow++) {
                     if (tiles[iCol][iRow].iID != -2)
-                        rm->spr_platformstarttile.draw(iEllipseStartX + (iCol << iSizeShift), iEllipseStartY + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
+                        drawPreviewSprite(targetSurface, resources->spr_platformstarttile, iEllipseStartX + (iCol << iSizeShift), iEllipseStartY + (iRow << iSizeShift), 0, 0, iTileSize, iTileSize);
                 }
             }
         }
@@ -418,14 +426,14 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
             short iY = (short)(fRadiusY * sin(fAngle)) - (iPlatformPathDotSize[iSize] >> 1) + iStartY;
 
             gfx_setrect(&rPathDst, iX, iY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-            SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+            SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
 
             if (iX + iPlatformPathDotSize[iSize] >= smw->GetScreenWidth(iSize)) {
                 gfx_setrect(&rPathDst, iX - smw->GetScreenWidth(iSize), iY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-                SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+                SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
             } else if (iX < 0) {
                 gfx_setrect(&rPathDst, iX + smw->GetScreenWidth(iSize), iY, iPlatformPathDotSize[iSize], iPlatformPathDotSize[iSize]);
-                SDL_BlitSurface(rm->spr_platformpath.getSurface(), &rPathSrc, blitdest, &rPathDst);
+                SDL_BlitSurface(resources->spr_platformpath.getSurface(), &rPathSrc, targetSurface, &rPathDst);
             }
 
             fAngle += TWO_PI / 32.0f;
@@ -434,11 +442,15 @@ void DrawPlatform(short pathtype, TilesetTile ** tiles, short startX, short star
 }
 
 
-CMap::CMap()
+CMap::CMap(CResourceManager * nresources, CTilesetManager * ntilesetmanager)
     : iNumMapItems(0)
     , iNumMapHazards(0)
+    , resources(nresources)
+    , tilesetmanager(ntilesetmanager)
     , platforms(nullptr)
     , iNumPlatforms(0)
+    , fPlatformIndexValid(false)
+    , numwarpexits(0)
     , warpexits()
     , maxConnection(0)
     , tilebltrect()
@@ -455,11 +467,13 @@ CMap::CMap()
     , animatedBackmapSurface(nullptr)
     , animatedTilesSurface(nullptr)
     , iAnimatedTileCount(0)
-    , numwarpexits(0)
 {}
 
 CMap::~CMap()
-{}
+{
+    clearPlatforms();
+    ClearAnimatedTiles();
+}
 
 
 //With the new 32x30 tile set, we need to convert old maps to use the
@@ -565,6 +579,7 @@ void CMap::clearPlatforms()
     }
 
     tempPlatforms.clear();
+    fPlatformIndexValid = false;
 }
 
 void CMap::ClearAnimatedTiles()
@@ -579,7 +594,7 @@ void CMap::ClearAnimatedTiles()
     animatedtiles.clear();
 }
 
-void CMap::loadMap(const std::string& file, ReadType iReadType)
+bool CMap::loadMap(const std::string& file, ReadType iReadType)
 {
     iTileAnimationTimer = 0;
     iTileAnimationFrame = 0;
@@ -606,7 +621,7 @@ void CMap::loadMap(const std::string& file, ReadType iReadType)
     BinaryFile mapfile(file.c_str(), "rb");
     if (!mapfile.is_open()) {
         libretro_printf("\n ERROR: Couldn't open map %s\n", file.c_str());
-        return;
+        return false;
     }
 
     //Load version number
@@ -634,15 +649,16 @@ void CMap::loadMap(const std::string& file, ReadType iReadType)
     // }
 
     MapReader* reader = MapReader::getLoaderByVersion(version);
-    reader->load(*this, mapfile, iReadType);
+    bool fLoaded = reader->load(*this, mapfile, iReadType);
     delete reader;
     reader = NULL;
 
     if (iReadType == read_type_summary)
-        return;
+        return fLoaded;
 
     clearWarpLocks();
     //cout << " done" << endl;
+    return fLoaded;
 }
 
 void CMap::UpdateAllTileGaps()
@@ -905,7 +921,7 @@ void CMap::saveMap(const std::string& file)
 
     //Write tileset names and indexes for translation at load time
     //Number of tilesets used by this map
-    short iTilesetCount = g_tilesetmanager->GetCount();
+    short iTilesetCount = tilesetmanager->GetCount();
     bool * fTilesetUsed = new bool[iTilesetCount];
     for (short iTileset = 0; iTileset < iTilesetCount; iTileset++)
         fTilesetUsed[iTileset] = false;
@@ -947,7 +963,7 @@ void CMap::saveMap(const std::string& file)
             mapfile.write_i32(iTileset);
 
             //Tileset Name
-            mapfile.write_string_long(g_tilesetmanager->GetTileset(iTileset)->GetName());
+            mapfile.write_string_long(tilesetmanager->GetTileset(iTileset)->GetName());
         }
     }
 
@@ -964,10 +980,10 @@ void CMap::saveMap(const std::string& file)
 
                 //Make sure the tile's col and row are within the tileset
                 if (tile->iID >= 0) {
-                    if (tile->iCol < 0 || tile->iCol >= g_tilesetmanager->GetTileset(tile->iID)->GetWidth())
+                    if (tile->iCol < 0 || tile->iCol >= tilesetmanager->GetTileset(tile->iID)->GetWidth())
                         tile->iCol = 0;
 
-                    if (tile->iRow < 0 || tile->iRow >= g_tilesetmanager->GetTileset(tile->iID)->GetHeight())
+                    if (tile->iRow < 0 || tile->iRow >= tilesetmanager->GetTileset(tile->iID)->GetHeight())
                         tile->iRow = 0;
                 }
 
@@ -1002,10 +1018,10 @@ void CMap::saveMap(const std::string& file)
 
                 //Make sure the tile's col and row are within the tileset
                 if (tile->iID >= 0) {
-                    if (tile->iCol < 0 || tile->iCol >= g_tilesetmanager->GetTileset(tile->iID)->GetWidth())
+                    if (tile->iCol < 0 || tile->iCol >= tilesetmanager->GetTileset(tile->iID)->GetWidth())
                         tile->iCol = 0;
 
-                    if (tile->iRow < 0 || tile->iRow >= g_tilesetmanager->GetTileset(tile->iID)->GetHeight())
+                    if (tile->iRow < 0 || tile->iRow >= tilesetmanager->GetTileset(tile->iID)->GetHeight())
                         tile->iRow = 0;
                 }
 
@@ -1363,6 +1379,17 @@ void CMap::saveMap(const std::string& file)
 }
 
 SDL_Surface * CMap::createThumbnailSurface(bool fUseClassicPack)
+{
+    SDL_Surface * sThumbnail = createThumbnailBackground(fUseClassicPack);
+
+    if (sThumbnail)
+        drawThumbnail(sThumbnail);
+
+    return sThumbnail;
+}
+
+//Only touches surfaces of its own, so it can run on a worker
+SDL_Surface * CMap::createThumbnailBackground(bool fUseClassicPack)
 {
     SDL_Surface * sThumbnail = SDL_CreateRGBSurface(screen->flags, 160, 120, 16, 0, 0, 0, 0);
 
@@ -1370,14 +1397,14 @@ SDL_Surface * CMap::createThumbnailSurface(bool fUseClassicPack)
     std::string path;
 
     if (fUseClassicPack) {
-        sprintf(localSzBackgroundFile, "gfx/packs/Classic/backgrounds/%s", g_map->szBackgroundFile);
+        sprintf(localSzBackgroundFile, "gfx/packs/Classic/backgrounds/%s", szBackgroundFile);
         path = convertPath(localSzBackgroundFile);
 
         //if the background file doesn't exist, use the classic background
         if (!File_Exists(path))
             path = convertPath("gfx/packs/Classic/backgrounds/Land_Classic.png");
     } else {
-        sprintf(localSzBackgroundFile, "gfx/packs/backgrounds/%s", g_map->szBackgroundFile);
+        sprintf(localSzBackgroundFile, "gfx/packs/backgrounds/%s", szBackgroundFile);
         path = convertPath(localSzBackgroundFile, gamegraphicspacklist->current_name());
 
         //if the background file doesn't exist, use the classic background
@@ -1413,6 +1440,12 @@ SDL_Surface * CMap::createThumbnailSurface(bool fUseClassicPack)
 
     SDL_FreeSurface(sBackground);
 
+    return sThumbnail;
+}
+
+//Draws the map over the background from the shared tileset and sprite surfaces
+void CMap::drawThumbnail(SDL_Surface * sThumbnail)
+{
     preDrawPreviewBackground(sThumbnail, true);
     preDrawPreviewBlocks(sThumbnail, true);
     preDrawPreviewMapItems(sThumbnail, true);
@@ -1420,8 +1453,6 @@ SDL_Surface * CMap::createThumbnailSurface(bool fUseClassicPack)
     drawThumbnailPlatforms(sThumbnail);
     preDrawPreviewForeground(sThumbnail, true);
     preDrawPreviewWarps(sThumbnail, true);
-
-    return sThumbnail;
 }
 
 //Save thumbnail image
@@ -1433,14 +1464,18 @@ void CMap::saveThumbnail(const std::string &sFile, bool fUseClassicPack)
         return;
 
     //Save the screenshot with the same name as the map file
+    saveThumbnailSurface(sThumbnail, sFile);
 
+    SDL_FreeSurface(sThumbnail);
+}
+
+void CMap::saveThumbnailSurface(SDL_Surface * sThumbnail, const std::string &sFile)
+{
 #ifdef PNG_SAVE_FORMAT
     IMG_SavePNG(sThumbnail, sFile.c_str());
 #else
     SDL_SaveBMP(sThumbnail, sFile.c_str());
 #endif
-
-    SDL_FreeSurface(sThumbnail);
 }
 
 void CMap::calculatespawnareas(short iType, bool fUseTempBlocks, bool fIgnoreDeath)
@@ -1652,8 +1687,8 @@ void CMap::draw(SDL_Surface *targetSurface, int layer)
 
             //If this is an animated tile, then setup an animated tile struct for use in drawing
             if (tile->iID >= 0) {
-                g_tilesetmanager->Draw(targetSurface, tile->iID, 0, tile->iCol, tile->iRow, i, j);
-                //SDL_BlitSurface(rm->spr_maptiles[0].getSurface(), &g_tilesetmanager->rRects[0][tile->iCol][tile->iRow], targetSurface, &bltrect);
+                tilesetmanager->Draw(targetSurface, tile->iID, 0, tile->iCol, tile->iRow, i, j);
+                //SDL_BlitSurface(resources->spr_maptiles[0].getSurface(), &tilesetmanager->rRects[0][tile->iCol][tile->iRow], targetSurface, &bltrect);
             } else if (tile->iID == TILESETANIMATED) {
                 //See if we already have this tile
                 bool fNeedNewAnimatedTile = true;
@@ -1706,7 +1741,7 @@ void CMap::draw(SDL_Surface *targetSurface, int layer)
                     animatedtiles.push_back(animatedtile);
                 }
             } else if (tile->iID == TILESETUNKNOWN) { //Draw red X where tile should be
-                SDL_BlitSurface(rm->spr_unknowntile[0].getSurface(), &g_tilesetmanager->rRects[0][0][0], targetSurface, &bltrect);
+                SDL_BlitSurface(resources->spr_unknowntile[0].getSurface(), &tilesetmanager->rRects[0][0][0], targetSurface, &bltrect);
             }
         }
 
@@ -1768,36 +1803,28 @@ void CMap::addPlatformAnimatedTiles()
 
 void CMap::drawThumbnailHazards(SDL_Surface * targetSurface)
 {
-    blitdest = targetSurface;
-
     for (short iHazard = 0; iHazard < iNumMapHazards; iHazard++) {
-        DrawMapHazard(&maphazards[iHazard], 2, false);
+        DrawMapHazard(targetSurface, &maphazards[iHazard], 2, false);
     }
-
-    blitdest = screen;
 }
 
 void CMap::drawThumbnailPlatforms(SDL_Surface * targetSurface)
 {
-    blitdest = targetSurface;
-
     for (short iPlatform = 0; iPlatform < iNumPlatforms; iPlatform++) {
         MovingPlatform * platform = platforms[iPlatform];
         MovingPlatformPath * basepath = platform->pPath;
 
         if (basepath->iType == 0) {
             StraightPath * path = (StraightPath*) basepath;
-            DrawPlatform(path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, ((short)path->dPathPointX[1]) << 1, ((short)path->dPathPointY[1]) << 1, 0.0f, 0.0f, 0.0f, 2, platform->iTileWidth, platform->iTileHeight, true, true);
+            DrawPlatform(targetSurface, path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, ((short)path->dPathPointX[1]) << 1, ((short)path->dPathPointY[1]) << 1, 0.0f, 0.0f, 0.0f, 2, platform->iTileWidth, platform->iTileHeight, true, true);
         } else if (basepath->iType == 1) {
             StraightPathContinuous * path = (StraightPathContinuous*) basepath;
-            DrawPlatform(path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, 0, 0, path->dAngle, 0.0f, 0.0f, 2, platform->iTileWidth, platform->iTileHeight, true, true);
+            DrawPlatform(targetSurface, path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, 0, 0, path->dAngle, 0.0f, 0.0f, 2, platform->iTileWidth, platform->iTileHeight, true, true);
         } else if (basepath->iType == 2) {
             EllipsePath * path = (EllipsePath*) basepath;
-            DrawPlatform(path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, 0, 0, path->dStartAngle, path->dRadiusX * 2, path->dRadiusY * 2, 2, platform->iTileWidth, platform->iTileHeight, true, true);
+            DrawPlatform(targetSurface, path->iType, platform->iTileData, ((short)path->dPathPointX[0]) << 1, ((short)path->dPathPointY[0]) << 1, 0, 0, path->dStartAngle, path->dRadiusX * 2, path->dRadiusY * 2, 2, platform->iTileWidth, platform->iTileHeight, true, true);
         }
     }
-
-    blitdest = screen;
 }
 
 void CMap::preDrawPreviewWarps(SDL_Surface * targetSurface, bool fThumbnail)
@@ -1812,13 +1839,13 @@ void CMap::preDrawPreviewWarps(SDL_Surface * targetSurface, bool fThumbnail)
 
     for (int j = 0; j < MAPHEIGHT; j++) {
         for (int i = 0; i < MAPWIDTH; i++) {
-            Warp * wWarp = &g_map->warpdata[i][j];
+            Warp * wWarp = &warpdata[i][j];
 
             if (wWarp->connection != -1) {
                 SDL_Rect rSrc = {wWarp->connection * iTileSize, wWarp->direction * iTileSize, iTileSize, iTileSize};
                 SDL_Rect rDst = {i * iTileSize, j * iTileSize, iTileSize, iTileSize};
 
-                SDL_BlitSurface(rm->spr_thumbnail_warps[iScreenshotSize].getSurface(), &rSrc, targetSurface, &rDst);
+                SDL_BlitSurface(resources->spr_thumbnail_warps[iScreenshotSize].getSurface(), &rSrc, targetSurface, &rDst);
             }
         }
     }
@@ -1838,7 +1865,7 @@ void CMap::preDrawPreviewMapItems(SDL_Surface * targetSurface, bool fThumbnail)
         SDL_Rect rSrc = {mapitems[j].itype * iTileSize, 0, iTileSize, iTileSize};
         SDL_Rect rDst = {mapitems[j].ix * iTileSize, mapitems[j].iy * iTileSize, iTileSize, iTileSize};
 
-        SDL_BlitSurface(rm->spr_thumbnail_mapitems[iScreenshotSize].getSurface(), &rSrc, targetSurface, &rDst);
+        SDL_BlitSurface(resources->spr_thumbnail_mapitems[iScreenshotSize].getSurface(), &rSrc, targetSurface, &rDst);
     }
 }
 
@@ -1861,7 +1888,17 @@ void CMap::preDrawPreviewBackground(SDL_Surface * targetSurface, bool fThumbnail
     //drawPreviewBlocks(targetSurface, fThumbnail);
 }
 
-void CMap::preDrawPreviewBackground(gfxSprite * background, SDL_Surface * targetSurface, bool fThumbnail)
+void CMap::preDrawPreviewBackground(SDL_Surface * background, SDL_Surface * targetSurface, bool fThumbnail)
+{
+    if (!scalePreviewBackground(background, targetSurface, fThumbnail))
+        return;
+
+    smallDelay();
+    preDrawPreviewBackground(targetSurface, fThumbnail);
+}
+
+//Only touches the two surfaces it's given, so it can run on a worker
+bool CMap::scalePreviewBackground(SDL_Surface * background, SDL_Surface * targetSurface, bool fThumbnail)
 {
     SDL_Rect srcrect;
     srcrect.x = 0;
@@ -1881,13 +1918,12 @@ void CMap::preDrawPreviewBackground(gfxSprite * background, SDL_Surface * target
         dstrect.h = smw->ScreenHeight/2;
     }
 
-    if (SDL_SCALEBLIT(background->getSurface(), &srcrect, targetSurface, &dstrect) < 0) {
+    if (SDL_SCALEBLIT(background, &srcrect, targetSurface, &dstrect) < 0) {
         libretro_printf("SDL_SoftStretch error: %s\n", SDL_GetError());
-        return;
+        return false;
     }
 
-    smallDelay();
-    preDrawPreviewBackground(targetSurface, fThumbnail);
+    return true;
 }
 
 void CMap::preDrawPreviewBlocks(SDL_Surface * targetSurface, bool fThumbnail)
@@ -1937,12 +1973,12 @@ void CMap::drawPreview(SDL_Surface * targetSurface, int layer, bool fThumbnail)
 
             //Handle drawing preview for animated tiles
             if (tile->iID >= 0) {
-                g_tilesetmanager->Draw(targetSurface, tile->iID, iTilesetSize, tile->iCol, tile->iRow, i, j);
-                // SDL_BlitSurface(rm->spr_maptiles[iTilesetIndex].getSurface(), &g_tilesetmanager->rRects[iTilesetSize][tile->iCol][tile->iRow], targetSurface, &rectDst);
+                tilesetmanager->Draw(targetSurface, tile->iID, iTilesetSize, tile->iCol, tile->iRow, i, j);
+                // SDL_BlitSurface(resources->spr_maptiles[iTilesetIndex].getSurface(), &tilesetmanager->rRects[iTilesetSize][tile->iCol][tile->iRow], targetSurface, &rectDst);
             } else if (tile->iID == TILESETANIMATED) {
-                SDL_BlitSurface(rm->spr_tileanimation[iTilesetSize].getSurface(), &g_tilesetmanager->rRects[iTilesetSize][tile->iCol << 2][tile->iRow], targetSurface, &g_tilesetmanager->rRects[iTilesetSize][i][j]);
+                SDL_BlitSurface(resources->spr_tileanimation[iTilesetSize].getSurface(), &tilesetmanager->rRects[iTilesetSize][tile->iCol << 2][tile->iRow], targetSurface, &tilesetmanager->rRects[iTilesetSize][i][j]);
             } else if (tile->iID == TILESETUNKNOWN) {
-                SDL_BlitSurface(rm->spr_unknowntile[iTilesetSize].getSurface(), &g_tilesetmanager->rRects[iTilesetSize][0][0], targetSurface, &g_tilesetmanager->rRects[iTilesetSize][i][j]);
+                SDL_BlitSurface(resources->spr_unknowntile[iTilesetSize].getSurface(), &tilesetmanager->rRects[iTilesetSize][0][0], targetSurface, &tilesetmanager->rRects[iTilesetSize][i][j]);
             }
         }
     }
@@ -1999,9 +2035,9 @@ void CMap::drawPreviewBlocks(SDL_Surface * targetSurface, bool fThumbnail)
             }
 
             if (fThumbnail)
-                SDL_BlitSurface(rm->spr_blocks[2].getSurface(), &rectSrc, targetSurface, &rectDst);
+                SDL_BlitSurface(resources->spr_blocks[2].getSurface(), &rectSrc, targetSurface, &rectDst);
             else
-                SDL_BlitSurface(rm->spr_blocks[1].getSurface(), &rectSrc, targetSurface, &rectDst);
+                SDL_BlitSurface(resources->spr_blocks[1].getSurface(), &rectSrc, targetSurface, &rectDst);
         }
 
         rectDst.x += iBlockSize;
@@ -2077,11 +2113,11 @@ void CMap::SetupAnimatedTiles()
     }
 
     if (iAnimatedTileCount > 0) {
-        SDL_Surface * backgroundSurface = rm->spr_background.getSurface();
-        SDL_Surface * animatedTileSrcSurface = rm->spr_tileanimation[0].getSurface();
+        SDL_Surface * backgroundSurface = resources->spr_background.getSurface();
+        SDL_Surface * animatedTileSrcSurface = resources->spr_tileanimation[0].getSurface();
 
-        animatedFrontmapSurface = rm->spr_frontmap[g_iCurrentDrawIndex].getSurface();
-        animatedBackmapSurface = rm->spr_backmap[g_iCurrentDrawIndex].getSurface();
+        animatedFrontmapSurface = resources->spr_frontmap[g_iCurrentDrawIndex].getSurface();
+        animatedBackmapSurface = resources->spr_backmap[g_iCurrentDrawIndex].getSurface();
         animatedTilesSurface = SDL_CreateRGBSurface(screen->flags, 1024, 1024, screen->format->BitsPerPixel, 0, 0, 0, 0);
 
         int iTransparentColor = SDL_MapRGB(animatedTilesSurface->format, 255, 0, 255);
@@ -2106,11 +2142,11 @@ void CMap::SetupAnimatedTiles()
                     for (short iLayer = 0; iLayer < iAnimatedBackgroundLayers; iLayer++) {
                         TilesetTile * tilesetTile = &tile->layers[iLayer];
                         if (tilesetTile->iID >= 0) {
-                            SDL_BlitSurface(g_tilesetmanager->GetTileset(tilesetTile->iID)->GetSurface(0), &(tile->rSrc[iLayer][0]), animatedTilesSurface, &rDst);
+                            SDL_BlitSurface(tilesetmanager->GetTileset(tilesetTile->iID)->GetSurface(0), &(tile->rSrc[iLayer][0]), animatedTilesSurface, &rDst);
                         } else if (tilesetTile->iID == TILESETANIMATED) {
                             SDL_BlitSurface(animatedTileSrcSurface, &(tile->rSrc[iLayer][sTileAnimationFrame]), animatedTilesSurface, &rDst);
                         } else if (tilesetTile->iID == TILESETUNKNOWN) {
-                            SDL_BlitSurface(rm->spr_unknowntile[0].getSurface(), &g_tilesetmanager->rRects[0][0][0], animatedTilesSurface, &rDst);
+                            SDL_BlitSurface(resources->spr_unknowntile[0].getSurface(), &tilesetmanager->rRects[0][0][0], animatedTilesSurface, &rDst);
                         }
                     }
 
@@ -2142,11 +2178,11 @@ void CMap::SetupAnimatedTiles()
                     for (short iLayer = 2; iLayer < 4; iLayer++) {
                         TilesetTile * tilesetTile = &tile->layers[iLayer];
                         if (tilesetTile->iID >= 0) {
-                            SDL_BlitSurface(g_tilesetmanager->GetTileset(tilesetTile->iID)->GetSurface(0), &(tile->rSrc[iLayer][0]), animatedTilesSurface, &rDst);
+                            SDL_BlitSurface(tilesetmanager->GetTileset(tilesetTile->iID)->GetSurface(0), &(tile->rSrc[iLayer][0]), animatedTilesSurface, &rDst);
                         } else if (tilesetTile->iID == TILESETANIMATED) {
                             SDL_BlitSurface(animatedTileSrcSurface, &(tile->rSrc[iLayer][sTileAnimationFrame]), animatedTilesSurface, &rDst);
                         } else if (tilesetTile->iID == TILESETUNKNOWN) {
-                            SDL_BlitSurface(rm->spr_unknowntile[0].getSurface(), &g_tilesetmanager->rRects[0][0][0], animatedTilesSurface, &rDst);
+                            SDL_BlitSurface(resources->spr_unknowntile[0].getSurface(), &tilesetmanager->rRects[0][0][0], animatedTilesSurface, &rDst);
                         }
                     }
 
@@ -2217,8 +2253,8 @@ void CMap::SetupAnimatedTiles()
 
         //Setup the back buffer to draw animated tiles to each frame
         //This is flipped every NUM_FRAMES_BETWEEN_TILE_ANIMATION to be the displayed surface
-        animatedFrontmapSurface = rm->spr_frontmap[1 - g_iCurrentDrawIndex].getSurface();
-        animatedBackmapSurface = rm->spr_backmap[1 - g_iCurrentDrawIndex].getSurface();
+        animatedFrontmapSurface = resources->spr_frontmap[1 - g_iCurrentDrawIndex].getSurface();
+        animatedBackmapSurface = resources->spr_backmap[1 - g_iCurrentDrawIndex].getSurface();
 
         //Draw the first set of animated tiles to the back buffer
         AnimateTiles(0);
@@ -2244,6 +2280,8 @@ void CMap::updatePlatforms()
             ++iter;
         }
     }
+
+    indexPlatforms();
 }
 
 void CMap::drawPlatforms(short iLayer)
@@ -2274,33 +2312,139 @@ void CMap::drawPlatforms(short iOffsetX, short iOffsetY, short iLayer)
     }
 }
 
-void CMap::movingPlatformCollision(IO_MovingObject * object)
+void CMap::preDrawPreviewPlatforms()
 {
-    for (short iPlatform = 0; iPlatform < iNumPlatforms; iPlatform++) {
-        platforms[iPlatform]->collide(object);
+    for (short iLayer = 0; iLayer < 5; iLayer++) {
+        std::list<MovingPlatform*>::iterator iterate = platformdrawlayer[iLayer].begin(), lim = platformdrawlayer[iLayer].end();
+
+        while (iterate != lim) {
+            (*iterate)->drawTiles();
+            iterate++;
+        }
     }
+}
 
-    std::list<MovingPlatform*>::iterator iterateAll = tempPlatforms.begin(), lim = tempPlatforms.end();
-    while (iterateAll != lim) {
-        (*iterateAll)->collide(object);
-        iterateAll++;
+PlatformArea::PlatformArea(float x, float y, float w, float h, float velx, float vely)
+{
+    left = x - (velx > 0.0f ? velx : 0.0f) - TILESIZE;
+    right = x + w - (velx < 0.0f ? velx : 0.0f) + TILESIZE;
+    top = y - (vely > 0.0f ? vely : 0.0f) - TILESIZE;
+    bottom = y + h - (vely < 0.0f ? vely : 0.0f) + TILESIZE;
+}
+
+//Index cells covered by a box. Rows are clamped to the screen, columns wrap
+//around it the same way objects collide with platforms across the edges.
+struct PlatformCells {
+    PlatformCells(float left, float top, float right, float bottom) {
+        int iLeft = (int)floorf(left / PLATFORMINDEX_CELLSIZE);
+        int iRight = (int)floorf(right / PLATFORMINDEX_CELLSIZE);
+
+        if (iRight - iLeft + 1 >= PLATFORMINDEX_COLUMNS) {
+            iFirstColumn = 0;
+            iColumns = PLATFORMINDEX_COLUMNS;
+        } else {
+            iFirstColumn = ((iLeft % PLATFORMINDEX_COLUMNS) + PLATFORMINDEX_COLUMNS) % PLATFORMINDEX_COLUMNS;
+            iColumns = iRight - iLeft + 1;
+        }
+
+        iTopRow = clampRow(top);
+        iBottomRow = clampRow(bottom);
     }
+
+    static int clampRow(float y) {
+        if (y < 0.0f)
+            return 0;
+
+        if (y >= PLATFORMINDEX_ROWS * PLATFORMINDEX_CELLSIZE)
+            return PLATFORMINDEX_ROWS - 1;
+
+        return (int)y / PLATFORMINDEX_CELLSIZE;
+    }
+
+    int iFirstColumn, iColumns;
+    int iTopRow, iBottomRow;
+};
+
+void CMap::indexPlatforms()
+{
+    for (short iRow = 0; iRow < PLATFORMINDEX_ROWS; iRow++) {
+        for (short iColumn = 0; iColumn < PLATFORMINDEX_COLUMNS; iColumn++)
+            platformcells[iRow][iColumn].clear();
+    }
+
+    indexedplatforms.assign(platforms, platforms + iNumPlatforms);
+    indexedplatforms.insert(indexedplatforms.end(), tempPlatforms.begin(), tempPlatforms.end());
+
+    for (short iPlatform = 0; iPlatform < (short)indexedplatforms.size(); iPlatform++) {
+        MovingPlatform * platform = indexedplatforms[iPlatform];
+
+        PlatformCells cells(platform->fx - platform->iHalfWidth, platform->fy - platform->iHalfHeight,
+                            platform->fx + platform->iHalfWidth, platform->fy + platform->iHalfHeight);
+
+        for (int iRow = cells.iTopRow; iRow <= cells.iBottomRow; iRow++) {
+            for (int iColumn = 0; iColumn < cells.iColumns; iColumn++)
+                platformcells[iRow][(cells.iFirstColumn + iColumn) % PLATFORMINDEX_COLUMNS].push_back(iPlatform);
+        }
+    }
+
+    fPlatformIndexValid = true;
 }
 
-bool CMap::movingPlatformCheckSides(IO_MovingObject * object)
+//Adds the platforms that can touch something inside area to platformcandidates,
+//in collision order, and returns where they start. The platform being ridden is
+//always included since colliding with it is what lets go of it. Colliding can
+//look up platforms again (a dying player drops what it carries), so each lookup
+//keeps its own part of the buffer until releasePlatforms().
+size_t CMap::findPlatforms(const PlatformArea& area, MovingPlatform * riding)
 {
-    bool fRet = false;
-    for (short iPlatform = 0; iPlatform < iNumPlatforms; iPlatform++) {
-        fRet |= platforms[iPlatform]->collision_detection_check_sides(object);
+    if (!fPlatformIndexValid)
+        indexPlatforms();
+
+    std::vector<short>& candidates = platformcandidates;
+    size_t iFirstCandidate = candidates.size();
+
+    if (indexedplatforms.empty())
+        return iFirstCandidate;
+
+    PlatformCells cells(area.left, area.top, area.right, area.bottom);
+
+    for (int iRow = cells.iTopRow; iRow <= cells.iBottomRow; iRow++) {
+        for (int iColumn = 0; iColumn < cells.iColumns; iColumn++) {
+            const std::vector<short>& cell = platformcells[iRow][(cells.iFirstColumn + iColumn) % PLATFORMINDEX_COLUMNS];
+            candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
     }
 
-    std::list<MovingPlatform*>::iterator iterateAll = tempPlatforms.begin(), lim = tempPlatforms.end();
-    while (iterateAll != lim) {
-        fRet |= (*iterateAll)->collision_detection_check_sides(object);
-        iterateAll++;
+    if (riding) {
+        std::vector<MovingPlatform*>::iterator found = std::find(indexedplatforms.begin(), indexedplatforms.end(), riding);
+
+        if (found != indexedplatforms.end())
+            candidates.push_back((short)(found - indexedplatforms.begin()));
     }
 
-    return fRet;
+    std::sort(candidates.begin() + iFirstCandidate, candidates.end());
+    candidates.erase(std::unique(candidates.begin() + iFirstCandidate, candidates.end()), candidates.end());
+
+    return iFirstCandidate;
+}
+
+//The platform to collide with after iPlatform, -1 when done. Once a collision
+//pushed the object out of its area every following platform is tried, so the
+//results stay the same as colliding with all of them.
+short CMap::nextPlatform(size_t& iCandidate, short iPlatform, bool fInArea) const
+{
+    if (!fInArea)
+        return iPlatform + 1 < (short)indexedplatforms.size() ? iPlatform + 1 : -1;
+
+    while (iCandidate < platformcandidates.size() && platformcandidates[iCandidate] <= iPlatform)
+        iCandidate++;
+
+    return iCandidate < platformcandidates.size() ? platformcandidates[iCandidate] : -1;
+}
+
+void CMap::releasePlatforms(size_t iFirstCandidate)
+{
+    platformcandidates.resize(iFirstCandidate);
 }
 
 void CMap::resetPlatforms()
@@ -2317,6 +2461,7 @@ void CMap::resetPlatforms()
     }
 
     tempPlatforms.clear();
+    fPlatformIndexValid = false;
 }
 
 void CMap::lockconnection(int connection)
@@ -2369,7 +2514,7 @@ void CMap::drawWarpLocks()
 {
     for (int iWarpExit = 0; iWarpExit < numwarpexits && iWarpExit < MAXWARPS; iWarpExit++) {
         if (warplocked[warpexits[iWarpExit].connection] || warpexits[iWarpExit].locktimer > 0) {
-            rm->spr_warplock.draw(warpexits[iWarpExit].lockx, warpexits[iWarpExit].locky);
+            resources->spr_warplock.draw(warpexits[iWarpExit].lockx, warpexits[iWarpExit].locky);
         }
     }
 }
@@ -2397,8 +2542,8 @@ void CMap::update()
         iTileAnimationTimer = 0;
 
         //Flip front and back buffers
-        animatedFrontmapSurface = rm->spr_frontmap[g_iCurrentDrawIndex].getSurface();
-        animatedBackmapSurface = rm->spr_backmap[g_iCurrentDrawIndex].getSurface();
+        animatedFrontmapSurface = resources->spr_frontmap[g_iCurrentDrawIndex].getSurface();
+        animatedBackmapSurface = resources->spr_backmap[g_iCurrentDrawIndex].getSurface();
 
         g_iCurrentDrawIndex = 1 - g_iCurrentDrawIndex;
 
@@ -2484,11 +2629,13 @@ void CMap::AddPermanentPlatform(MovingPlatform * platform)
 {
     platforms[iNumPlatforms++] = platform;
     platformdrawlayer[platform->iDrawLayer].push_back(platform);
+    fPlatformIndexValid = false;
 }
 
 void CMap::AddTemporaryPlatform(MovingPlatform * platform)
 {
     tempPlatforms.push_back(platform);
+    fPlatformIndexValid = false;
 }
 
 bool CMap::IsInPlatformNoSpawnZone(short x, short y, short width, short height)
@@ -2512,7 +2659,7 @@ bool CMap::IsInPlatformNoSpawnZone(short x, short y, short width, short height)
 void CMap::drawfrontlayer()
 {
     for (int k = 0; k < numdrawareas; k++)
-        rm->spr_frontmap[g_iCurrentDrawIndex].draw(drawareas[k].x, drawareas[k].y, drawareas[k].x, drawareas[k].y, drawareas[k].w, drawareas[k].h);
+        resources->spr_frontmap[g_iCurrentDrawIndex].draw(drawareas[k].x, drawareas[k].y, drawareas[k].x, drawareas[k].y, drawareas[k].w, drawareas[k].h);
 
     //Draw gaps in pink for debugging
     /*
@@ -2555,7 +2702,7 @@ void CMap::optimize()
         for (int i = 0; i < MAPWIDTH; i++) {
             for (int m = 1; m < MAPLAYERS; m++) {
                 TilesetTile * tile = &mapdata[i][j][m];
-                TileType type = g_tilesetmanager->GetTileset(tile->iID)->GetTileType(tile->iCol, tile->iRow);
+                TileType type = tilesetmanager->GetTileset(tile->iID)->GetTileType(tile->iCol, tile->iRow);
                 if (type != tile_nonsolid && type != tile_gap && type != tile_solid_on_top) {
                     for (int k = m - 1; k >= 0; k--) {
                         TilesetTile * compareTile = &mapdata[i][j][k];
@@ -14,6 +14,11 @@
 #define NUM_FRAMES_IN_TILE_ANIMATION        4
 #define NUM_FRAMES_BETWEEN_TILE_ANIMATION   8
 
+//Moving platforms are bucketed into cells of 2x2 tiles for collision queries
+#define PLATFORMINDEX_CELLSIZE  64
+#define PLATFORMINDEX_COLUMNS   (MAPWIDTH * TILESIZE / PLATFORMINDEX_CELLSIZE)
+#define PLATFORMINDEX_ROWS      (MAPHEIGHT * TILESIZE / PLATFORMINDEX_CELLSIZE)
+
 enum TileType {
     tile_nonsolid = 0,
     tile_solid = 1,
@@ -194,29 +199,43 @@ struct MapBlock {
 	bool fHidden;
 };
 
+//Where an object may touch moving platforms during one collision pass: its
+//box swept back over its last move, with room for the pushes it gets
+struct PlatformArea {
+	PlatformArea(float x, float y, float w, float h, float velx, float vely);
+
+	bool contains(float x, float y, float w, float h) const {
+		return x >= left && y >= top && x + w <= right && y + h <= bottom;
+	}
+
+	float left, top, right, bottom;
+};
+
 class IO_Block;
 
-void DrawMapHazard(MapHazard * hazard, short iSize, bool fDrawCenter);
-void DrawPlatform(short pathtype, TilesetTile ** tiles,
-	short startX, short startY, short endX, short endY,
-	float angle, float radiusX, float radiusY,
-	short iSize, short iPlatformWidth, short iPlatformHeight,
-	bool fDrawPlatform, bool fDrawShadow);
+class CResourceManager;
+class CTilesetManager;
 
 class CMap
 {
 	public:
-		CMap();
+		//Maps draw with the given sprites and tilesets instead of the global
+		//ones, so previews and thumbnails can have maps of their own
+		CMap(CResourceManager * nresources, CTilesetManager * ntilesetmanager);
 		~CMap();
 
 		void clearMap();
 		void clearPlatforms();
 
-		void loadMap(const std::string& file, ReadType iReadType);
+		//False if the map file couldn't be opened or read
+		bool loadMap(const std::string& file, ReadType iReadType);
 		void saveMap(const std::string& file);
 
 		SDL_Surface * createThumbnailSurface(bool fUseClassicPack);
+		SDL_Surface * createThumbnailBackground(bool fUseClassicPack);
+		void drawThumbnail(SDL_Surface * sThumbnail);
 		void saveThumbnail(const std::string &file, bool fUseClassicPack);
+		static void saveThumbnailSurface(SDL_Surface * sThumbnail, const std::string &file);
 
 		void UpdateAllTileGaps();
 		void UpdateTileGap(short i, short j);
@@ -229,9 +248,20 @@ class CMap
 		void predrawforeground(gfxSprite &foregroundspr);
 
 		void SetupAnimatedTiles();
+		bool hasAnimatedTiles() const {
+			return iAnimatedTileCount > 0;
+		}
+
+		void DrawMapHazard(SDL_Surface * targetSurface, MapHazard * hazard, short iSize, bool fDrawCenter);
+		void DrawPlatform(SDL_Surface * targetSurface, short pathtype, TilesetTile ** tiles,
+			short startX, short startY, short endX, short endY,
+			float angle, float radiusX, float radiusY,
+			short iSize, short iPlatformWidth, short iPlatformHeight,
+			bool fDrawPlatform, bool fDrawShadow);
 
 		void preDrawPreviewBackground(SDL_Surface * targetSurface, bool fThumbnail);
-		void preDrawPreviewBackground(gfxSprite * spr_background, SDL_Surface * targetSurface, bool fThumbnail);
+		void preDrawPreviewBackground(SDL_Surface * background, SDL_Surface * targetSurface, bool fThumbnail);
+		bool scalePreviewBackground(SDL_Surface * background, SDL_Surface * targetSurface, bool fThumbnail);
 		void preDrawPreviewBlocks(SDL_Surface * targetSurface, bool fThumbnail);
 		void preDrawPreviewForeground(SDL_Surface * targetSurface, bool fThumbnail);
 		void preDrawPreviewWarps(SDL_Surface * targetSurface, bool fThumbnail);
@@ -268,12 +298,19 @@ class CMap
 		void updatePlatforms();
 		void drawPlatforms(short iLayer);
 		void drawPlatforms(short iOffsetX, short iOffsetY, short iLayer);
+		//Preview reads leave the platform tiles for the main thread to draw
+		void preDrawPreviewPlatforms();
 		void resetPlatforms();
 
 		void movingPlatformCollision(CPlayer * player);
 		void movingPlatformCollision(IO_MovingObject * object);
 		bool movingPlatformCheckSides(IO_MovingObject * object);
 
+    //Platforms moved or were replaced outside of updatePlatforms()
+    void invalidatePlatformIndex() {
+        fPlatformIndexValid = false;
+    }
+
     bool isconnectionlocked(int connection) {
         return warplocked[connection];
     }
@@ -309,6 +346,9 @@ class CMap
 		void SetTileGap(short i, short j);
 		void calculatespawnareas(short iType, bool fUseTempBlocks, bool fIgnoreDeath);
 
+		CResourceManager * resources;
+		CTilesetManager * tilesetmanager;
+
 		TilesetTile	mapdata[MAPWIDTH][MAPHEIGHT][MAPLAYERS];
 		MapTile		mapdatatop[MAPWIDTH][MAPHEIGHT];
 		MapBlock	objectdata[MAPWIDTH][MAPHEIGHT];
@@ -322,6 +362,21 @@ class CMap
 
 		std::list<MovingPlatform*> tempPlatforms;
 
+		//All platforms in collision order (permanent, then temporary) and the
+		//index cells their bounds cover, rebuilt each frame after they move
+		std::vector<MovingPlatform*> indexedplatforms;
+		std::vector<short> platformcells[PLATFORMINDEX_ROWS][PLATFORMINDEX_COLUMNS];
+		bool fPlatformIndexValid;
+
+		//Candidates of every platform lookup in progress, one after the other,
+		//so looking up platforms doesn't allocate each time
+		std::vector<short> platformcandidates;
+
+		void indexPlatforms();
+		size_t findPlatforms(const PlatformArea& area, MovingPlatform * riding);
+		short nextPlatform(size_t& iCandidate, short iPlatform, bool fInArea) const;
+		void releasePlatforms(size_t iFirstCandidate);
+
 		MapItem		mapitems[MAXMAPITEMS];
 		MapHazard	maphazards[MAXMAPHAZARDS];
 
@@ -407,7 +462,7 @@ class CMap
 		friend int save_as();
 		friend int load();
 		friend void LoadMapObjects(bool fPreview);
-		friend void LoadMapHazards(bool fPreview);
+		friend void LoadMapHazards(CMap * map, bool fPreview);
 		friend void draw_platform(short iPlatform, bool fDrawTileTypes);
 		friend void insert_platforms_into_map();
 		friend void loadcurrentmap();
@@ -424,6 +479,7 @@ class CMap
 
 		friend class MovingPlatform;
 		friend class MapList;
+		friend class SaveState;
 		friend class MI_MapField;
 		friend class CPlayer;
 		friend class PlayerWarpStatus;
@@ -130,7 +130,7 @@ public:
 
 protected:
     virtual void read_autofilters(CMap& map, BinaryFile& mapfile); // 13 autofilters
-    virtual void read_tileset(BinaryFile&); // custom tileset support
+    virtual void read_tileset(CMap&, BinaryFile&); // custom tileset support
     virtual void read_tiles(CMap&, BinaryFile&); // multi-tileset mapdata
     virtual void read_switches(CMap&, BinaryFile&); // switches stored as-is
     virtual void read_items(CMap&, BinaryFile&); // map item support
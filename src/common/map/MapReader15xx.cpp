@@ -6,7 +6,6 @@
 
 #include <cstring>
 
-extern CTilesetManager* g_tilesetmanager;
 extern short g_iMusicCategoryConversion[26];
 extern short g_iTileTypeConversion[NUMTILETYPES];
 extern short g_iDefaultPowerupPresets[NUM_POWERUP_PRESETS][NUM_POWERUPS];
@@ -57,11 +56,11 @@ void MapReader1500::read_tiles(CMap& map, BinaryFile& mapfile)
             short iTileID = (short)mapfile.read_i32();
 
             TilesetTile * tile = &map.mapdata[i][j][1];
-            tile->iID = g_tilesetmanager->GetClassicTilesetIndex();
+            tile->iID = map.tilesetmanager->GetClassicTilesetIndex();
             tile->iCol = iTileID % 32;
             tile->iRow = iTileID / 32;
 
-            TileType iType = g_tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
+            TileType iType = map.tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
 
             if (iType >= 0 && iType < NUMTILETYPES) {
                 map.mapdatatop[i][j].iType = iType;
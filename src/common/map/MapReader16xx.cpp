@@ -6,7 +6,6 @@
 
 extern void libretro_printf(const char *fmt, ...);
 
-extern CTilesetManager* g_tilesetmanager;
 extern short g_iTileConversion[];
 extern short g_iTileTypeConversion[NUMTILETYPES];
 extern short g_iDefaultPowerupPresets[NUM_POWERUP_PRESETS][NUM_POWERUPS];
@@ -43,7 +42,7 @@ void MapReader1600::read_tiles(CMap& map, BinaryFile& mapfile)
                     short iTileID = g_iTileConversion[iTile];
 
                     TilesetTile * tile = &map.mapdata[i][j][k];
-                    tile->iID = g_tilesetmanager->GetClassicTilesetIndex();
+                    tile->iID = map.tilesetmanager->GetClassicTilesetIndex();
                     tile->iCol = iTileID % 32;
                     tile->iRow = iTileID / 32;
                 }
@@ -54,7 +53,7 @@ void MapReader1600::read_tiles(CMap& map, BinaryFile& mapfile)
 
             for (short k = MAPLAYERS - 1; k >= 0; k--) {
                 TilesetTile * tile = &map.mapdata[i][j][k];
-                TileType type = g_tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
+                TileType type = map.tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
                 if (type != tile_nonsolid) {
                     if (type >= 0 && type < NUMTILETYPES) {
                         map.mapdatatop[i][j].iType = type;
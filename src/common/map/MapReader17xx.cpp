@@ -10,7 +10,6 @@
 
 extern void libretro_printf(const char *fmt, ...);
 
-extern CTilesetManager* g_tilesetmanager;
 extern const char* g_szBackgroundConversion[26];
 extern short g_iTileTypeConversion[NUMTILETYPES];
 extern short g_iDefaultPowerupPresets[NUM_POWERUP_PRESETS][NUM_POWERUPS];
@@ -52,7 +51,7 @@ void MapReader1702::read_autofilters(CMap& map, BinaryFile& mapfile)
 
 void MapReader1700::read_tiles(CMap& map, BinaryFile& mapfile)
 {
-    short iClassicTilesetID = g_tilesetmanager->GetIndexFromName("Classic");
+    short iClassicTilesetID = map.tilesetmanager->GetIndexFromName("Classic");
 
     unsigned short i, j, k;
     for (j = 0; j < MAPHEIGHT; j++) {
@@ -255,7 +254,7 @@ void MapReader1700::read_platforms(CMap& map, BinaryFile& mapfile, bool fPreview
         if (!path)
             continue;
 
-        MovingPlatform * platform = new MovingPlatform(tiles, types, iWidth, iHeight, iDrawLayer, path, fPreview);
+        MovingPlatform * platform = new MovingPlatform(&map, tiles, types, iWidth, iHeight, iDrawLayer, path, fPreview);
         map.platforms[iPlatform] = platform;
         map.platformdrawlayer[iDrawLayer].push_back(platform);
     }
@@ -281,11 +280,11 @@ void MapReader1700::read_platform_tiles(CMap& map, BinaryFile& mapfile,
 
                 type = tile_nonsolid;
             } else {
-                tile->iID = g_tilesetmanager->GetClassicTilesetIndex();
+                tile->iID = map.tilesetmanager->GetClassicTilesetIndex();
                 tile->iCol = iTile % TILESETWIDTH;
                 tile->iRow = iTile / TILESETWIDTH;
 
-                type = g_tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
+                type = map.tilesetmanager->GetClassicTileset()->GetTileType(tile->iCol, tile->iRow);
             }
 
             if (type >= 0 && type < NUMTILETYPES) {
@@ -7,7 +7,6 @@
 
 #include <iostream>
 
-extern CTilesetManager* g_tilesetmanager;
 extern short g_iTileTypeConversion[NUMTILETYPES];
 
 using namespace std;
@@ -46,7 +45,7 @@ void MapReader1800::read_autofilters(CMap& map, BinaryFile& mapfile)
         map.fAutoFilter[iFilter] = iAutoFilterValues[iFilter] > 0;
 }
 
-void MapReader1800::read_tileset(BinaryFile& mapfile)
+void MapReader1800::read_tileset(CMap& map, BinaryFile& mapfile)
 {
     //Load tileset information
 
@@ -71,14 +70,14 @@ void MapReader1800::read_tileset(BinaryFile& mapfile)
 
     for (short iTileset = 0; iTileset < iNumTilesets; iTileset++) {
         short iID = translation[iTileset].iID;
-        translationid[iID] = g_tilesetmanager->GetIndexFromName(translation[iTileset].szName);
+        translationid[iID] = map.tilesetmanager->GetIndexFromName(translation[iTileset].szName);
 
         if (translationid[iID] == TILESETUNKNOWN) {
             tilesetwidths[iID] = 1;
             tilesetheights[iID] = 1;
         } else {
-            tilesetwidths[iID] = g_tilesetmanager->GetTileset(translationid[iID])->GetWidth();
-            tilesetheights[iID] = g_tilesetmanager->GetTileset(translationid[iID])->GetHeight();
+            tilesetwidths[iID] = map.tilesetmanager->GetTileset(translationid[iID])->GetWidth();
+            tilesetheights[iID] = map.tilesetmanager->GetTileset(translationid[iID])->GetHeight();
         }
     }
 
@@ -302,7 +301,7 @@ void MapReader1800::read_platforms(CMap& map, BinaryFile& mapfile, bool fPreview
         if (!path)
             continue;
 
-        MovingPlatform * platform = new MovingPlatform(tiles, types, iWidth, iHeight, iDrawLayer, path, fPreview);
+        MovingPlatform * platform = new MovingPlatform(&map, tiles, types, iWidth, iHeight, iDrawLayer, path, fPreview);
         map.platforms[iPlatform] = platform;
         map.platformdrawlayer[iDrawLayer].push_back(platform);
     }
@@ -369,7 +368,7 @@ bool MapReader1800::load(CMap& map, BinaryFile& mapfile/*, const char* filename*
     cout << " [Version " << version[0] << '.' << version[1] << '.'
          << version[2] << '.' << version[3] << " Map Detected]\n";*/
 
-    read_tileset(mapfile);
+    read_tileset(map, mapfile);
 
     read_tiles(map, mapfile);
     read_background(map, mapfile);
@@ -9,6 +9,7 @@
 #include "PlayerKillTypes.h"
 #include "ResourceManager.h"
 #include "TilesetManager.h"
+#include "gfx/gfxDirtyRects.h"
 
 #include "sdl12wrapper.h"
 
@@ -24,14 +25,11 @@ extern short y_shake;
 
 extern short g_iCurrentDrawIndex;
 
-extern CMap* g_map;
-extern CTilesetManager* g_tilesetmanager;
 
 extern CPlayer* list_players[4];
 extern short list_players_cnt;
 
 extern CGameValues game_values;
-extern CResourceManager* rm;
 extern CGame* smw;
 
 enum CollisionStyle {collision_none, collision_normal, collision_overlap_left, collision_overlap_right};
@@ -293,7 +291,9 @@ void EllipsePath::Reset()
 
 FallingPath::FallingPath(float startX, float startY) :
     MovingPlatformPath(0.0f, startX, startY, 0.0f, 0.0f, false)
-{}
+{
+    iType = 3;
+}
 
 bool FallingPath::Move(short type)
 {
@@ -332,13 +332,15 @@ void FallingPath::Reset()
 // Moving Platform
 //------------------------------------------------------------------------------
 
-MovingPlatform::MovingPlatform(TilesetTile ** tiledata, MapTile ** tiletypes, short w, short h, short drawlayer, MovingPlatformPath * path, bool fPreview)
+MovingPlatform::MovingPlatform(CMap * map, TilesetTile ** tiledata, MapTile ** tiletypes, short w, short h, short drawlayer, MovingPlatformPath * path, bool fPreview)
 {
+    pMap = map;
+
     fDead = false;
     iPlayerId = -1;
 
     short iTileSize = TILESIZE;
-    short iTileSizeIndex = 0;
+    iTileSizeIndex = 0;
 
     if (fPreview) {
         iTileSize = PREVIEWTILESIZE;
@@ -373,6 +375,28 @@ MovingPlatform::MovingPlatform(TilesetTile ** tiledata, MapTile ** tiletypes, sh
         SDL_FillRect(sSurface[iSurface], NULL, SDL_MapRGB(sSurface[iSurface]->format, 255, 0, 255));
     }
 
+    if (!fPreview)
+        drawTiles();
+
+    rSrcRect.x = 0;
+    rSrcRect.y = 0;
+    rSrcRect.w = w * iTileSize;
+    rSrcRect.h = h * iTileSize;
+
+    rDstRect.x = ix - iHalfWidth;
+    rDstRect.y = iy - iHalfHeight;
+    rDstRect.w = w * iTileSize;
+    rDstRect.h = h * iTileSize;
+
+    fVelX = pPath->dVelX[0];
+    fVelY = pPath->dVelY[0];
+
+    fOldVelX = fVelX;
+    fOldVelY = fVelY;
+}
+
+void MovingPlatform::drawTiles()
+{
     //Run through all tiles in the platform, detect unknown and blank tiles,
     //and draw all static tiles to the platform surface
     for (short iSurface = 0; iSurface < 2; iSurface++) {
@@ -384,31 +408,15 @@ MovingPlatform::MovingPlatform(TilesetTile ** tiledata, MapTile ** tiletypes, sh
                     continue;
 
                 if (tile->iID >= 0) {
-                    g_tilesetmanager->Draw(sSurface[iSurface], tile->iID, iTileSizeIndex, tile->iCol, tile->iRow, iCol, iRow);
+                    pMap->tilesetmanager->Draw(sSurface[iSurface], tile->iID, iTileSizeIndex, tile->iCol, tile->iRow, iCol, iRow);
                 } else if (tile->iID == TILESETANIMATED) {
-                    SDL_BlitSurface(rm->spr_tileanimation[iTileSizeIndex].getSurface(), &g_tilesetmanager->rRects[iTileSizeIndex][tile->iCol << 2][tile->iRow], sSurface[iSurface], &g_tilesetmanager->rRects[iTileSizeIndex][iCol][iRow]);
+                    SDL_BlitSurface(pMap->resources->spr_tileanimation[iTileSizeIndex].getSurface(), &pMap->tilesetmanager->rRects[iTileSizeIndex][tile->iCol << 2][tile->iRow], sSurface[iSurface], &pMap->tilesetmanager->rRects[iTileSizeIndex][iCol][iRow]);
                 } else if (tile->iID == TILESETUNKNOWN) {
-                    SDL_BlitSurface(rm->spr_unknowntile[iTileSizeIndex].getSurface(), &g_tilesetmanager->rRects[iTileSizeIndex][0][0], sSurface[iSurface], &g_tilesetmanager->rRects[iTileSizeIndex][iCol][iRow]);
+                    SDL_BlitSurface(pMap->resources->spr_unknowntile[iTileSizeIndex].getSurface(), &pMap->tilesetmanager->rRects[iTileSizeIndex][0][0], sSurface[iSurface], &pMap->tilesetmanager->rRects[iTileSizeIndex][iCol][iRow]);
                 }
             }
         }
     }
-
-    rSrcRect.x = 0;
-    rSrcRect.y = 0;
-    rSrcRect.w = w * iTileSize;
-    rSrcRect.h = h * iTileSize;
-
-    rDstRect.x = ix - iHalfWidth;
-    rDstRect.y = iy - iHalfHeight;
-    rDstRect.w = w * iTileSize;
-    rDstRect.h = h * iTileSize;
-
-    fVelX = pPath->dVelX[0];
-    fVelY = pPath->dVelY[0];
-
-    fOldVelX = fVelX;
-    fOldVelY = fVelY;
 }
 
 MovingPlatform::~MovingPlatform()
@@ -444,6 +452,8 @@ void MovingPlatform::draw()
         return;
     }
 
+    g_dirtyrects.mark(blitdest, rDstRect);
+
     //Deal with wrapping over sides of screen
     bool fBlitSide = false;
     if (ix - iHalfWidth < 0) {
@@ -463,6 +473,8 @@ void MovingPlatform::draw()
             libretro_printf("SDL_BlitSurface error: %s\n", SDL_GetError());
         }
 
+        g_dirtyrects.mark(blitdest, rDstRect);
+
         //rDstRect.x = ix - iHalfWidth;
     }
 
@@ -955,10 +967,10 @@ void MovingPlatform::check_map_collision_right(CPlayer * player)
 
     short iTestBackgroundY = ((short)player->fy + PH) / TILESIZE;
 
-    IO_Block * topblock = g_map->block(iTestBackgroundX, iTestBackgroundY);
+    IO_Block * topblock = pMap->block(iTestBackgroundX, iTestBackgroundY);
 
     if ((topblock && !topblock->isTransparent() && !topblock->isHidden()) ||
-            (g_map->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid)) {
+            (pMap->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid)) {
         player->setXf((float)((iTestBackgroundX << 5) - PW) - 0.2f);
         player->flipsidesifneeded();
         return;
@@ -969,10 +981,10 @@ void MovingPlatform::check_map_collision_right(CPlayer * player)
 
     short iTestBackgroundY2 = (short)player->fy / TILESIZE;
 
-    IO_Block * bottomblock = g_map->block(iTestBackgroundX, iTestBackgroundY2);
+    IO_Block * bottomblock = pMap->block(iTestBackgroundX, iTestBackgroundY2);
 
     if ((bottomblock && !bottomblock->isTransparent() && !bottomblock->isHidden()) ||
-            (g_map->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
+            (pMap->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
         player->setXf((float)((iTestBackgroundX << 5) - PW) - 0.2f);
         player->flipsidesifneeded();
         return;
@@ -987,10 +999,10 @@ void MovingPlatform::check_map_collision_left(CPlayer * player)
     short iTestBackgroundX = (short)player->fx / TILESIZE;
     short iTestBackgroundY = ((short)player->fy + PH) / TILESIZE;
 
-    IO_Block * topblock = g_map->block(iTestBackgroundX, iTestBackgroundY);
+    IO_Block * topblock = pMap->block(iTestBackgroundX, iTestBackgroundY);
 
     if ((topblock && !topblock->isTransparent() && !topblock->isHidden()) ||
-            (g_map->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid)) {
+            (pMap->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid)) {
         player->setXf((float)((iTestBackgroundX << 5) + TILESIZE) + 0.2f);
         player->flipsidesifneeded();
         return;
@@ -1001,10 +1013,10 @@ void MovingPlatform::check_map_collision_left(CPlayer * player)
 
     short iTestBackgroundY2 = (short)player->fy / TILESIZE;
 
-    IO_Block * bottomblock = g_map->block(iTestBackgroundX, iTestBackgroundY2);
+    IO_Block * bottomblock = pMap->block(iTestBackgroundX, iTestBackgroundY2);
 
     if ((bottomblock && !bottomblock->isTransparent() && !bottomblock->isHidden()) ||
-            (g_map->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
+            (pMap->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
         player->setXf((float)((iTestBackgroundX << 5) + TILESIZE) + 0.2f);
         player->flipsidesifneeded();
         return;
@@ -1416,13 +1428,13 @@ void MovingPlatform::collide(IO_MovingObject * object)
                     else
                         iTestBackgroundX = ((short)object->fx + object->collisionWidth) / TILESIZE;
 
-                    IO_Block * topblock = g_map->block(iTestBackgroundX, iTestBackgroundY);
-                    IO_Block * bottomblock = g_map->block(iTestBackgroundX, iTestBackgroundY2);
+                    IO_Block * topblock = pMap->block(iTestBackgroundX, iTestBackgroundY);
+                    IO_Block * bottomblock = pMap->block(iTestBackgroundX, iTestBackgroundY2);
 
                     if ((topblock && !topblock->isTransparent() && !topblock->isHidden()) ||
                             (bottomblock && !bottomblock->isTransparent() && !bottomblock->isHidden()) ||
-                            (g_map->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid) ||
-                            (g_map->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
+                            (pMap->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid) ||
+                            (pMap->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
                         object->setXf((float)((iTestBackgroundX << 5) - object->collisionWidth) - 0.2f);
                         object->flipsidesifneeded();
                     }
@@ -1477,13 +1489,13 @@ void MovingPlatform::collide(IO_MovingObject * object)
                     short iTestBackgroundY2 = ((short)object->fy + object->collisionHeight) / TILESIZE;
                     short iTestBackgroundX = (short)object->fx / TILESIZE;
 
-                    IO_Block * topblock = g_map->block(iTestBackgroundX, iTestBackgroundY);
-                    IO_Block * bottomblock = g_map->block(iTestBackgroundX, iTestBackgroundY2);
+                    IO_Block * topblock = pMap->block(iTestBackgroundX, iTestBackgroundY);
+                    IO_Block * bottomblock = pMap->block(iTestBackgroundX, iTestBackgroundY2);
 
                     if ((topblock && !topblock->isTransparent() && !topblock->isHidden()) ||
                             (bottomblock && !bottomblock->isTransparent() && !bottomblock->isHidden()) ||
-                            (g_map->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid) ||
-                            (g_map->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
+                            (pMap->map(iTestBackgroundX, iTestBackgroundY) & tile_flag_solid) ||
+                            (pMap->map(iTestBackgroundX, iTestBackgroundY2) & tile_flag_solid)) {
                         object->setXf((float)((iTestBackgroundX << 5) + TILESIZE) + 0.2f);
                         object->flipsidesifneeded();
                     }
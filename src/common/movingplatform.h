@@ -123,9 +123,14 @@ class FallingPath : public MovingPlatformPath
 class MovingPlatform
 {
 	public:
-		MovingPlatform(TilesetTile ** tiledata, MapTile ** tiletypes, short w, short h, short drawlayer, MovingPlatformPath * path, bool preview);
+		MovingPlatform(CMap * map, TilesetTile ** tiledata, MapTile ** tiletypes, short w, short h, short drawlayer, MovingPlatformPath * path, bool preview);
 		~MovingPlatform();
 
+		//Draws the tiles into the platform's surfaces. Previews are read on
+		//worker threads, which must not blit from the shared tilesets, so
+		//their platforms wait for this until they are back on the main thread.
+		void drawTiles();
+
 		void draw();
 		void draw(short iOffsetX, short iOffsetY);
 		void update();
@@ -189,6 +194,7 @@ class MovingPlatform
 		short iOnStep;
 
 		SDL_Surface	* sSurface[2];
+		short iTileSizeIndex;
 
 		SDL_Rect	rSrcRect;
 		SDL_Rect    rDstRect;
@@ -198,6 +204,7 @@ class MovingPlatform
 
 		short iDrawLayer;
 
+		CMap * pMap;
 		MovingPlatformPath * pPath;
 
 		float fVelX, fVelY;
@@ -206,6 +213,7 @@ class MovingPlatform
 
 	friend class FallingPath;
 	friend class StraightPathContinuous;
+	friend class SaveState;
 
 	friend class CPlayer;
 	friend class IO_MovingObject;
@@ -4,12 +4,14 @@
 #include "SDL.h"
 #endif
 
+#include <cstdio>
 #include <cstring>
 #include <string>
 
 #ifdef __LIBRETRO__
 #include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <streams/file_stream_transforms.h>
 #else
 #include <sys/stat.h>
 
@@ -107,6 +109,28 @@ bool File_Exists (const std::string fileName)
 #endif
 }
 
+uint64_t File_Hash(const std::string& fileName)
+{
+    uint64_t iHash = 14695981039346656037ULL;
+
+    FILE * fp = fopen(fileName.c_str(), "rb");
+
+    if (!fp)
+        return 0;
+
+    uint8_t buffer[4096];
+    size_t iRead;
+
+    while ((iRead = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        for (size_t i = 0; i < iRead; i++)
+            iHash = (iHash ^ buffer[i]) * 1099511628211ULL;
+    }
+
+    fclose(fp);
+
+    return iHash;
+}
+
 /*********************************************************************
   Mac OS X Application Bundles                              *********/
 
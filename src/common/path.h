@@ -1,6 +1,7 @@
 #ifndef PATH_H
 #define PATH_H
 
+#include <stdint.h>
 #include <string>
 
 #ifndef PATH_MAX
@@ -10,6 +11,8 @@
 /* Call Initialize_Paths() when your application launches */
 
 bool File_Exists (const std::string fileName);
+//FNV-1a over the whole file, 0 if it can't be read
+uint64_t File_Hash(const std::string& fileName);
 /* All filenames must go through this door */
 #define convertPathC(s) convertPath(s).c_str()
 const std::string convertPath(const std::string& source);
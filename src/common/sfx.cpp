@@ -1,5 +1,8 @@
 #include "sfx.h"
 
+#include "MusicStream.h"
+#include "SoundCache.h"
+
 #include "SDL.h"
 
 #include <cstdio>
@@ -18,8 +21,9 @@ sfxSound * g_PlayingSoundChannels[NUM_SOUND_CHANNELS];
 
 bool sfx_init()
 {
-    // Initialize audio with typical OGG-compatible settings
-    if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) == -1) {
+    // Initialize audio with typical OGG-compatible settings, in chunks of one
+    // 60 fps frame like the libretro audio driver mixes them
+    if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 735) == -1) {
         libretro_printf("Mix_OpenAudio failed: %s\n", Mix_GetError());
         return false;
     }
@@ -54,6 +58,7 @@ bool sfx_init()
 
 void sfx_close()
 {
+	g_musicstream.stop();
 	Mix_CloseAudio();
     Mix_Quit();
 }
@@ -70,6 +75,7 @@ void sfx_stopallsounds()
 void sfx_setmusicvolume(int volume)
 {
 	Mix_VolumeMusic(volume);
+	g_musicstream.setVolume(volume);
 }
 
 void sfx_setsoundvolume(int volume)
@@ -77,6 +83,11 @@ void sfx_setsoundvolume(int volume)
 	Mix_Volume(-1, volume);
 }
 
+void sfx_update()
+{
+	g_musicstream.update();
+}
+
 sfxSound::sfxSound()
 {
 	paused = false;
@@ -89,18 +100,12 @@ sfxSound::~sfxSound()
 	reset();
 }
 
-bool sfxSound::init(const string& filename)
+bool sfxSound::init(const string& filename, bool fDecodeOnFirstPlay)
 {
-	if (sfx)
+	if (sfx || ready)
 		reset();
 
-	libretro_printf("load %s...\n", filename.c_str());
-	sfx = Mix_LoadWAV(filename.c_str());
-
-    if (sfx == NULL) {
-		libretro_printf(" failed loading %s\n", filename.c_str());
-		return false;
-	}
+	this->filename = filename;
 
 	channel = -1;
 	starttime = 0;
@@ -109,11 +114,44 @@ bool sfxSound::init(const string& filename)
 
 	Mix_ChannelFinished(&soundfinished);
 
+	if (fDecodeOnFirstPlay)
+		return true;
+
+	return decode();
+}
+
+//Takes the samples from the sound cache if it has them, otherwise decodes the file
+bool sfxSound::decode()
+{
+	if (sfx)
+		return true;
+
+	if (!ready)
+		return false;
+
+	libretro_printf("load %s...\n", filename.c_str());
+	sfx = g_soundcache.load(filename);
+
+	if (sfx)
+		return true;
+
+	sfx = Mix_LoadWAV(filename.c_str());
+
+    if (sfx == NULL) {
+		libretro_printf(" failed loading %s\n", filename.c_str());
+		ready = false;
+		return false;
+	}
+
+	g_soundcache.store(filename, sfx);
 	return true;
 }
 
 int sfxSound::play()
 {
+	if (!decode())
+		return -1;
+
 	int ticks = SDL_GetTicks();
 
 	//Don't play sounds right over the top (doubles volume)
@@ -136,6 +174,9 @@ int sfxSound::play()
 
 int sfxSound::playloop(int iLoop)
 {
+	if (!decode())
+		return -1;
+
 	instances++;
 	channel = Mix_PlayChannel(-1, sfx, iLoop);
 
@@ -209,10 +250,20 @@ sfxMusic::~sfxMusic()
 
 bool sfxMusic::load(const string& filename)
 {
-	if (music)
+	if (music || ready)
 		reset();
 
 	libretro_printf("load %s...\n", filename.c_str());
+
+	//OGG files are decoded ahead on a worker instead of in the mixer callback
+	if (CMusicStream::canPlay(filename)) {
+		this->filename = filename;
+		g_musicstream.setFinishedHook(&musicfinished);
+
+		ready = true;
+		return true;
+	}
+
 	music = Mix_LoadMUS(filename.c_str());
 
     if (!music) {
@@ -229,13 +280,30 @@ bool sfxMusic::load(const string& filename)
 
 void sfxMusic::play(bool fPlayonce, bool fResume)
 {
-	Mix_PlayMusic(music, fPlayonce ? 0 : -1);
+	if (music) {
+		g_musicstream.stop();
+		Mix_PlayMusic(music, fPlayonce ? 0 : -1);
+	} else if (ready) {
+		//Mix_PlayMusic() would have replaced the old music without calling the hook
+		Mix_HookMusicFinished(NULL);
+		Mix_HaltMusic();
+		Mix_HookMusicFinished(&musicfinished);
+
+		g_musicstream.play(filename, fPlayonce);
+	}
+
 	fResumeMusic = fResume;
 }
 
 void sfxMusic::stop()
 {
-	Mix_HaltMusic();
+	//Like Mix_HaltMusic(), stopping a stream that plays calls the finished hook
+	if (g_musicstream.playing()) {
+		g_musicstream.stop();
+		musicfinished();
+	} else {
+		Mix_HaltMusic();
+	}
 }
 
 void sfxMusic::sfx_pause()
@@ -246,10 +314,16 @@ void sfxMusic::sfx_pause()
 		Mix_PauseMusic();
 	else
 		Mix_ResumeMusic();
+
+	g_musicstream.setPaused(paused);
 }
 
 void sfxMusic::reset()
 {
+	//Freeing music that plays stops it
+	if (!music && ready && g_musicstream.playing(filename))
+		g_musicstream.stop();
+
 	Mix_FreeMusic(music);
 	music = NULL;
 	ready = false;
@@ -257,5 +331,5 @@ void sfxMusic::reset()
 
 int sfxMusic::isplaying()
 {
-	return Mix_PlayingMusic();
+	return Mix_PlayingMusic() || g_musicstream.playing();
 }
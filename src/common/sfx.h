@@ -16,13 +16,17 @@ void sfx_stopallsounds();
 void sfx_setmusicvolume(int volume);
 void sfx_setsoundvolume(int volume);
 
+//Once a frame, keeps streamed music decoded ahead of the mixer
+void sfx_update();
+
 class sfxSound
 {
 	public:
 		sfxSound();
 		~sfxSound();
 
-		bool init(const std::string& filename);
+		//A sound decoded on first play only costs a file name until it's needed
+		bool init(const std::string& filename, bool fDecodeOnFirstPlay = false);
 
 		int play();
 		int playloop(int iLoop);
@@ -42,7 +46,10 @@ class sfxSound
 		void clearchannel();
 
 	private:
+		bool decode();
+
 		Mix_Chunk *sfx;
+		std::string filename;
 		int channel;
 		bool paused;
 		bool ready;
@@ -74,6 +81,7 @@ class sfxMusic
 
 	private:
 		Mix_Music *music;
+		std::string filename;  //Of music that is streamed instead
 		bool paused;
 		bool ready;
 };
@@ -11,31 +11,23 @@
 extern CGameValues game_values;
 extern CResourceManager* rm;
 
-extern CMap* g_map;
 extern MapList *maplist;
 
 extern SDL_Surface* blitdest;
 extern CObjectContainer noncolcontainer;
 extern CObjectContainer objectcontainer[3];
-extern void LoadCurrentMapBackground();
-extern void LoadMapHazards(bool fPreview);
+extern void LoadMapHazards(CMap * map, bool fPreview);
 
-#if !defined(__EMSCRIPTEN__) && !defined(__LIBRETRO__)
-    inline void smallDelay() { SDL_Delay(10); }
-#else
-    inline void smallDelay() {}
-#endif
+#define MAPPREVIEW_REQUEST_DELAY    4   //Frames to wait so scrolling through maps doesn't load each one
 
 MI_MapPreview::MI_MapPreview(gfxSprite * nspr, short x, short y, short width, short indent)
     : UI_Control(x, y)
     , spr(nspr)
+    , iRequestDelay(0)
     , iWidth(width)
     , iIndent(indent)
     , iSlideListOut(0)
 {
-    surfaceMapBackground = SDL_CreateRGBSurface(0, smw->ScreenWidth/2, smw->ScreenHeight/2, 16, 0, 0, 0, 0);
-    surfaceMapBlockLayer = SDL_CreateRGBSurface(0, smw->ScreenWidth/2, smw->ScreenHeight/2, 16, 0, 0, 0, 0);
-    surfaceMapForeground = SDL_CreateRGBSurface(0, smw->ScreenWidth/2, smw->ScreenHeight/2, 16, 0, 0, 0, 0);
     LoadCurrentMap();
 
     rectDst.x = x + 16;
@@ -50,13 +42,28 @@ MI_MapPreview::~MI_MapPreview() {}
 
 void MI_MapPreview::Update()
 {
+    if (!sPendingPath.empty()) {
+        //Asked again every frame in case the request got cancelled
+        if (iRequestDelay > 0)
+            iRequestDelay--;
+        else
+            g_mappreviews.request(sPendingPath);
+
+        g_mappreviews.update();
+
+        MapPreviewPtr ready = g_mappreviews.find(sPendingPath);
+        if (ready)
+            Show(ready);
+    }
+
     //Update hazards
     noncolcontainer.update();
 
     objectcontainer[1].update();
     objectcontainer[1].cleandeadobjects();
 
-    g_map->updatePlatforms();
+    if (preview)
+        preview->map->updatePlatforms();
 }
 
 void MI_MapPreview::Draw()
@@ -74,13 +81,22 @@ void MI_MapPreview::Draw()
 
     rectDst.x = iMapBoxX + 16;
 
-    SDL_BlitSurface(surfaceMapBackground, NULL, blitdest, &rectDst);
+    //Nothing loaded yet
+    if (!preview) {
+        SDL_Rect rectFill = rectDst;
+        SDL_FillRect(blitdest, &rectFill, SDL_MapRGB(blitdest->format, 0, 0, 0));
+        return;
+    }
 
-    g_map->drawPlatforms(rectDst.x, rectDst.y, 0);
+    CMap * map = preview->map;
 
-    SDL_BlitSurface(surfaceMapBlockLayer, NULL, blitdest, &rectDst);
+    SDL_BlitSurface(preview->background, NULL, blitdest, &rectDst);
 
-    g_map->drawPlatforms(rectDst.x, rectDst.y, 1);
+    map->drawPlatforms(rectDst.x, rectDst.y, 0);
+
+    SDL_BlitSurface(preview->blocklayer, NULL, blitdest, &rectDst);
+
+    map->drawPlatforms(rectDst.x, rectDst.y, 1);
 
     //Draw map hazards
     for (short i = 0; i < objectcontainer[1].list_end; i++) {
@@ -104,13 +120,13 @@ void MI_MapPreview::Draw()
         }
     }
 
-    g_map->drawPlatforms(rectDst.x, rectDst.y, 2);
+    map->drawPlatforms(rectDst.x, rectDst.y, 2);
 
-    if (game_values.toplayer)
-        SDL_BlitSurface(surfaceMapForeground, NULL, blitdest, &rectDst);
+    if (preview->fTopLayer)
+        SDL_BlitSurface(preview->foreground, NULL, blitdest, &rectDst);
 
-    g_map->drawPlatforms(rectDst.x, rectDst.y, 3);
-    g_map->drawPlatforms(rectDst.x, rectDst.y, 4);
+    map->drawPlatforms(rectDst.x, rectDst.y, 3);
+    map->drawPlatforms(rectDst.x, rectDst.y, 4);
 }
 
 void MI_MapPreview::LoadCurrentMap()
@@ -123,28 +139,25 @@ void MI_MapPreview::LoadCurrentMap()
 
 void MI_MapPreview::LoadMap(const char * szMapPath)
 {
-    g_map->loadMap(szMapPath, read_type_preview);
-    smallDelay(); //Sleeps to help the music from skipping
-
-    LoadCurrentMapBackground();
-    smallDelay();
-
-    g_map->preDrawPreviewBackground(&rm->spr_background, surfaceMapBackground, false);
-    smallDelay();
-
-    g_map->preDrawPreviewBlocks(surfaceMapBlockLayer, false);
-    smallDelay();
-
-    g_map->preDrawPreviewMapItems(surfaceMapBackground, false);
-    smallDelay();
+    MapPreviewPtr cached = g_mappreviews.find(szMapPath);
+    if (cached) {
+        Show(cached);
+        return;
+    }
 
-    g_map->preDrawPreviewForeground(surfaceMapForeground, false);
-    smallDelay();
+    //The map is rendered on the worker and shown from Update() when it's done.
+    //Until then the last preview stays up.
+    sPendingPath = szMapPath;
+    iRequestDelay = preview ? MAPPREVIEW_REQUEST_DELAY : 0;
+}
 
-    g_map->preDrawPreviewWarps(game_values.toplayer ? surfaceMapForeground : surfaceMapBackground, false);
-    smallDelay();
+void MI_MapPreview::Show(MapPreviewPtr newpreview)
+{
+    preview = newpreview;
+    sPendingPath.clear();
+    iRequestDelay = 0;
 
-    LoadMapHazards(true);
+    LoadMapHazards(preview->map, true);
 }
 
 bool MI_MapPreview::SetMap(const char * paramSzMapName, bool fWorld)
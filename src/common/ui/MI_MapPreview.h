@@ -2,6 +2,9 @@
 #define UI_MAP_PREVIEW
 
 #include "uicontrol.h"
+#include "MapPreviewCache.h"
+
+#include <string>
 
 class MI_MapPreview : public UI_Control
 {
@@ -31,15 +34,22 @@ protected:
 
     gfxSprite * spr;
 
-    SDL_Surface * surfaceMapBackground;
-    SDL_Surface * surfaceMapBlockLayer;
-    SDL_Surface * surfaceMapForeground;
+    //The preview being shown, kept until the next one is ready
+    MapPreviewPtr preview;
+
+    std::string sPendingPath;
+    short iRequestDelay;
+
     SDL_Rect rectDst;
 
     short iWidth, iIndent;
     char szMapName[256];
 
     short iSlideListOut;
+
+private:
+
+    void Show(MapPreviewPtr newpreview);
 };
 
 #endif // UI_MAP_PREVIEW
@@ -1,9 +1,12 @@
 #include "GSGameplay.h"
 
 #include "FileList.h"
+#include "FrameProfiler.h"
+#include "gfx/gfxDirtyRects.h"
 #include "GameMode.h"
 #include "gamemodes.h"
 #include "GameValues.h"
+#include "GameplayHeap.h"
 #include "GSMenu.h"
 #include "net.h"
 #include "map.h"
@@ -11,6 +14,7 @@
 #include "object.h"
 #include "objectgame.h"
 #include "objecthazard.h"
+#include "ObjectGrid.h"
 #include "player.h"
 #include "RandomNumberGenerator.h"
 #include "ResourceManager.h"
@@ -21,6 +25,7 @@
 #include <cmath>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 extern void libretro_printf(const char *fmt, ...);
 
@@ -80,6 +85,11 @@ GameplayState::GameplayState()
     spinspeed = 0.0f;
     spindirection = 1;
     spintimer = 0;
+
+    iMatchSerial = 0;
+
+    fRenderingEnabled = true;
+    iLastDrawIndex = 0;
 }
 
 GameplayState& GameplayState::instance() {
@@ -93,7 +103,7 @@ GameplayState& GameplayState::instance() {
 
 extern void SetupScoreBoard(bool fOrderMatters);
 extern void ShowScoreBoard();
-extern void LoadMapHazards(bool fPreview);
+extern void LoadMapHazards(CMap * map, bool fPreview);
 
 extern SDL_Rect iCountDownNumbers[4][4][2];
 extern short iCountDownTimes[28];
@@ -545,16 +555,15 @@ void shakeScreen()
 
     game_values.screenshaketimer--;
 
-    static bool shakeleft = false;
-    if (shakeleft) {
+    if (game_values.screenshakeleft) {
         x_shake -= 2;
         if (x_shake <= -2) {
-            shakeleft = false;
+            game_values.screenshakeleft = false;
         }
     } else {
         x_shake += 2;
         if (x_shake >= 2) {
-            shakeleft = true;
+            game_values.screenshakeleft = true;
         }
     }
 
@@ -772,8 +781,53 @@ void handleP2ObjCollisions()
     }
 }
 
+//Counts collision handler calls, so the sweep knows when objects may have been moved
+static unsigned int iObj2ObjHandled = 0;
+
+//Runs the collision check between two moving objects, returns true if the first one died
+static bool handleObj2ObjPair(IO_MovingObject * movingobject1, CObject * object2)
+{
+    if (object2->getObjectType() != object_moving)
+        return false;
+
+    IO_MovingObject * movingobject2 = (IO_MovingObject*)object2;
+
+    //if (g_iCollisionMap[movingobject1->getMovingObjectType()][movingobject2->getMovingObjectType()])
+    //  return false;
+
+    if (object2->isDead())
+        return false;
+
+    MovingObjectType iType1 = movingobject1->getMovingObjectType();
+    MovingObjectType iType2 = movingobject2->getMovingObjectType();
+    if (g_iCollisionMap[iType1][iType2]) {
+        if (coldec_obj2obj(movingobject1, movingobject2)) {
+            collisionhandler_o2o(movingobject1, movingobject2);
+            iObj2ObjHandled++;
+        }
+    } else if (g_iCollisionMap[iType2][iType1]) {
+        if (coldec_obj2obj(movingobject2, movingobject1)) {
+            collisionhandler_o2o(movingobject2, movingobject1);
+            iObj2ObjHandled++;
+        }
+    }
+
+    return movingobject1->isDead();
+}
+
+//Visits the same pairs in the same order as checking every object against every later one,
+//but only objects that share a grid cell are tested. Objects spawned by a collision handler
+//during the sweep are not in the grid and get checked against everything, as before.
+//Handlers can also move objects (a scored flag sends its base elsewhere), so after one ran
+//the grid is built again if anything moved and the sweep picks up after the last pair.
 void handleObj2ObjCollisions()
 {
+    static CObjectGrid objectgrid;
+    static std::vector<short> candidates;
+
+    objectgrid.build(objectcontainer, 3);
+    unsigned int iSynced = iObj2ObjHandled;
+
     for (short iLayer1 = 0; iLayer1 < 3; iLayer1++) {
         short iContainerEnd1 = objectcontainer[iLayer1].list_end;
         for (short iObject1 = 0; iObject1 < iContainerEnd1; iObject1++) {
@@ -784,41 +838,74 @@ void handleObj2ObjCollisions()
 
             IO_MovingObject * movingobject1 = (IO_MovingObject*)object1;
 
-            for (short iLayer2 = iLayer1; iLayer2 < 3; iLayer2++) {
-                short iContainerEnd2 = objectcontainer[iLayer2].list_end;
-                for (short iObject2 = (iLayer1 == iLayer2 ? iObject1 + 1 : 0); iObject2 < iContainerEnd2; iObject2++) {
-                    CObject * object2 = objectcontainer[iLayer2].list[iObject2];
+            if (iSynced != iObj2ObjHandled) {
+                iSynced = iObj2ObjHandled;
+                objectgrid.rebuildIfMoved(objectcontainer, 3);
+            }
 
-                    if (object2->getObjectType() != object_moving)
-                        continue;
+            //A dead object ends the sweep at the first live object after it, which the grid can't tell us
+            if (!objectgrid.isIndexed(iLayer1, iObject1) || object1->isDead()) {
+                for (short iLayer2 = iLayer1; iLayer2 < 3; iLayer2++) {
+                    short iContainerEnd2 = objectcontainer[iLayer2].list_end;
+                    for (short iObject2 = (iLayer1 == iLayer2 ? iObject1 + 1 : 0); iObject2 < iContainerEnd2; iObject2++) {
+                        if (handleObj2ObjPair(movingobject1, objectcontainer[iLayer2].list[iObject2]))
+                            return; // CONTINUEOBJECT1
+                    }
+                }
 
-                    IO_MovingObject * movingobject2 = (IO_MovingObject*)object2;
+                continue;
+            }
 
-                    //if (g_iCollisionMap[movingobject1->getMovingObjectType()][movingobject2->getMovingObjectType()])
-                    //  continue;
+            //Key of the last object tested against object1
+            short iLastKey = iLayer1 * MAXOBJECTS + iObject1;
+            bool fRebuilt;
 
-                    //if (iLayer1 == iLayer2 && iObject1 == iObject2)
-                    //  continue;
+            do {
+                fRebuilt = false;
 
-                    if (object2->isDead())
-                        continue;
+                objectgrid.getCandidates(iLayer1, iObject1, candidates);
+                size_t iCandidate = std::upper_bound(candidates.begin(), candidates.end(), iLastKey) - candidates.begin();
 
-                    MovingObjectType iType1 = movingobject1->getMovingObjectType();
-                    MovingObjectType iType2 = movingobject2->getMovingObjectType();
-                    if (g_iCollisionMap[iType1][iType2]) {
-                        if (coldec_obj2obj(movingobject1, movingobject2)) {
-                            collisionhandler_o2o(movingobject1, movingobject2);
-                        }
-                    } else if (g_iCollisionMap[iType2][iType1]) {
-                        if (coldec_obj2obj(movingobject2, movingobject1)) {
-                            collisionhandler_o2o(movingobject2, movingobject1);
+                for (short iLayer2 = iLastKey / MAXOBJECTS; iLayer2 < 3 && !fRebuilt; iLayer2++) {
+                    for (; iCandidate < candidates.size() && candidates[iCandidate] / MAXOBJECTS == iLayer2; iCandidate++) {
+                        iLastKey = candidates[iCandidate];
+
+                        if (handleObj2ObjPair(movingobject1, objectcontainer[iLayer2].list[iLastKey % MAXOBJECTS]))
+                            return; // CONTINUEOBJECT1
+
+                        if (iSynced != iObj2ObjHandled) {
+                            iSynced = iObj2ObjHandled;
+                            if (objectgrid.rebuildIfMoved(objectcontainer, 3)) {
+                                fRebuilt = true;
+                                break;
+                            }
                         }
                     }
 
-                    if (object1->isDead())
-                        return; // CONTINUEOBJECT1
+                    if (fRebuilt)
+                        break;
+
+                    short iFirstNew = objectgrid.indexedEnd(iLayer2);
+                    if (iLastKey / MAXOBJECTS == iLayer2 && iFirstNew <= iLastKey % MAXOBJECTS)
+                        iFirstNew = iLastKey % MAXOBJECTS + 1;
+
+                    short iContainerEnd2 = objectcontainer[iLayer2].list_end;
+                    for (short iObject2 = iFirstNew; iObject2 < iContainerEnd2; iObject2++) {
+                        iLastKey = iLayer2 * MAXOBJECTS + iObject2;
+
+                        if (handleObj2ObjPair(movingobject1, objectcontainer[iLayer2].list[iObject2]))
+                            return; // CONTINUEOBJECT1
+
+                        if (iSynced != iObj2ObjHandled) {
+                            iSynced = iObj2ObjHandled;
+                            if (objectgrid.rebuildIfMoved(objectcontainer, 3)) {
+                                fRebuilt = true;
+                                break;
+                            }
+                        }
+                    }
                 }
-            }
+            } while (fRebuilt);
         }
     }
 }
@@ -1108,7 +1195,18 @@ void GameplayState::drawPlayerSwap()
 
 void GameplayState::drawBackLayer()
 {
-    rm->spr_backmap[g_iCurrentDrawIndex].draw(0, 0);
+    //Only the spots drawn over last frame need the back map again, unless the
+    //last frame is gone, the whole screen moved or the animated tiles just
+    //flipped to the other back map
+    bool fTrackable = gfx_screenpreserved() && x_shake == 0 && y_shake == 0 && !game_values.spotlights &&
+                      !(iLastDrawIndex != g_iCurrentDrawIndex && g_map->hasAnimatedTiles());
+
+    iLastDrawIndex = g_iCurrentDrawIndex;
+
+    if (!g_dirtyrects.restore(rm->spr_backmap[g_iCurrentDrawIndex].getSurface(), blitdest, fTrackable))
+        rm->spr_backmap[g_iCurrentDrawIndex].draw(0, 0);
+
+    g_dirtyrects.beginFrame(blitdest, fTrackable);
 
     //draw back eyecandy behind players
     g_map->drawPlatforms(0);
@@ -1189,11 +1287,30 @@ void GameplayState::drawOutOfScreenIndicators()
 
 void GameplayState::drawEverything(short iCountDownState, short iScoreTextOffset[4])
 {
-    drawBackLayer();
-    drawMiddleLayer();
-    drawFrontLayer();
+    CProfileScope profileDraw(PROFILE_DRAW);
+
+    {
+        CProfileScope profile(PROFILE_DRAW_BACK);
+        drawBackLayer();
+    }
+
+    {
+        CProfileScope profile(PROFILE_DRAW_MIDDLE);
+        drawMiddleLayer();
+    }
+
+    {
+        CProfileScope profile(PROFILE_DRAW_FRONT);
+        drawFrontLayer();
+    }
+
+    {
+        CProfileScope profile(PROFILE_DRAW_SPOTLIGHTS);
+        drawSpotlights();
+    }
+
+    CProfileScope profileHud(PROFILE_DRAW_HUD);
 
-    drawSpotlights();
     drawScoreboard(iScoreTextOffset);
     drawWindMeter();
     drawOutOfScreenIndicators();
@@ -1203,6 +1320,29 @@ void GameplayState::drawEverything(short iCountDownState, short iScoreTextOffset
     drawScreenShakeBackground();
 }
 
+//Phase timings from the frame profiler, one line per phase in milliseconds
+static void drawProfilerOverlay()
+{
+    char szLine[64];
+    short iLineHeight = rm->menu_font_small.getHeight();
+    short iY = 40;
+
+    rm->menu_font_small.drawf(5, iY, "%-20s %6s %6s %6s", "ms", "min", "avg", "max");
+
+    for (short iPhase = 0; iPhase < PROFILE_LAST; iPhase++) {
+        CFrameProfiler::PhaseStats stats;
+
+        if (!g_profiler.getStats((ProfilePhase)iPhase, stats))
+            continue;
+
+        iY += iLineHeight;
+
+        snprintf(szLine, sizeof(szLine), "%-20s %6.2f %6.2f %6.2f", CFrameProfiler::phaseName((ProfilePhase)iPhase),
+                 stats.iMin / 1000.0, stats.iAvg / 1000.0, stats.iMax / 1000.0);
+        rm->menu_font_small.draw(5, iY, szLine);
+    }
+}
+
 void drawExitPauseDialog()
 {
     if (game_values.pausegame) {
@@ -1379,7 +1519,7 @@ void UpdateScoreBoard()
 
 void LoadMapObjects(bool fPreview)
 {
-    LoadMapHazards(fPreview);
+    LoadMapHazards(g_map, fPreview);
 
     //Clear all the previous switch settings
     for (short iSwitch = 0; iSwitch < 8; iSwitch++)
@@ -1540,6 +1680,12 @@ void LoadMapObjects(bool fPreview)
     g_map->UpdateAllTileGaps();
 }
 
+static void resetGameplayHeap(CGameplayHeap& heap, const char * szName)
+{
+    if (!heap.reset())
+        libretro_printf("Warning: %s heap still has %u live blocks after clean up\n", szName, heap.liveCount());
+}
+
 void CleanUp()
 {
     short i;
@@ -1560,6 +1706,11 @@ void CleanUp()
     objectcontainer[1].clean();
     objectcontainer[2].clean();
 
+    //Everything the match created is gone now, start the next one with empty arenas
+    resetGameplayHeap(g_objectheap, "object");
+    resetGameplayHeap(g_eyecandyheap, "eyecandy");
+    resetGameplayHeap(g_gameplayheap, "gameplay");
+
     LoadMapObjects(true);
     g_map->clearWarpLocks();
     g_map->resetPlatforms();
@@ -1965,6 +2116,9 @@ void debug_gameplay()
 
 void GameplayState::onEnterState()
 {
+    iMatchSerial++;
+    g_dirtyrects.invalidate();
+
     iCountDownState = 0;
     iCountDownTimer = 0;
 
@@ -2337,6 +2491,8 @@ void update_playerswap()
 
 void GameplayState::update_world()
 {
+    CProfileScope profileWorld(PROFILE_UPDATE_WORLD);
+
     shakeScreen();
     spinScreen();
     updateBulletBillPowerup();
@@ -2358,34 +2514,54 @@ void GameplayState::update_world()
     if (++game_values.cputurn > 3)
         game_values.cputurn = 0;
 
-    if (!netplay.active || (netplay.active && netplay.theHostIsMe))
+    if (!netplay.active || (netplay.active && netplay.theHostIsMe)) {
+        CProfileScope profile(PROFILE_P2P_COLLISIONS);
         handleP2PCollisions();
+    }
 
     //Move platforms
-    g_map->updatePlatforms();
+    {
+        CProfileScope profile(PROFILE_PLATFORMS);
+        g_map->updatePlatforms();
+    }
 
     game_values.playskidsound = false;
     game_values.playinvinciblesound = false;
     game_values.playflyingsound = false;
 
-    for (unsigned short i = 0; i < list_players_cnt; i++)
-        list_players[i]->move();    //move all objects before doing object-object collision detection in
-    //->think(), so we test against the new position after object-map collision detection
+    {
+        CProfileScope profile(PROFILE_PLAYER_MOVE);
+
+        for (unsigned short i = 0; i < list_players_cnt; i++)
+            list_players[i]->move();    //move all objects before doing object-object collision detection in
+        //->think(), so we test against the new position after object-map collision detection
+    }
 
     playSFX();
 
-    noncolcontainer.update();
-    objectcontainer[0].update();
-    objectcontainer[1].update();
-    objectcontainer[2].update();
+    {
+        CProfileScope profile(PROFILE_OBJECT_UPDATE);
+
+        noncolcontainer.update();
+        objectcontainer[0].update();
+        objectcontainer[1].update();
+        objectcontainer[2].update();
+    }
+
+    {
+        CProfileScope profile(PROFILE_P2OBJ_COLLISIONS);
+        handleP2ObjCollisions();
+    }
 
-    handleP2ObjCollisions();
     if (game_values.swapplayers) {
         update_playerswap();
         return;
     }
 
-    handleObj2ObjCollisions();
+    {
+        CProfileScope profile(PROFILE_OBJ2OBJ_COLLISIONS);
+        handleObj2ObjCollisions();
+    }
 
     //Commit all player actions at this point (after we have collided with any objects
     //that the player might have picked up)
@@ -2395,26 +2571,50 @@ void GameplayState::update_world()
     cleanDeadNonPlayerObjects();
     CleanDeadPlayers();
 
-    eyecandy[0].update();
-    eyecandy[1].update();
-    eyecandy[2].update();
+    {
+        CProfileScope profile(PROFILE_EYECANDY);
 
-    game_values.gamemode->think();
+        eyecandy[0].update();
+        eyecandy[1].update();
+        eyecandy[2].update();
+    }
+
+    {
+        CProfileScope profile(PROFILE_GAMEMODE_THINK);
+        game_values.gamemode->think();
+    }
 
     if (game_values.slowdownon != -1 && ++game_values.slowdowncounter > 580) {
         game_values.slowdownon = -1;
         game_values.slowdowncounter = 0;
     }
 
-    g_map->update();
+    {
+        CProfileScope profile(PROFILE_MAP_UPDATE);
+        g_map->update();
+    }
 
     updateScreenShake();
 
     updateScoreboardAnimation();
 }
 
+bool GameplayState::redrawsWholeScreen() const
+{
+    //The pause dialog is drawn over the last frame, and the dirty rectangles
+    //only restore what changed since then
+    return fRenderingEnabled && shouldUpdate() && game_values.screenfade != 255 && !g_dirtyrects.isEnabled();
+}
+
+bool GameplayState::framesCanRepeat() const
+{
+    return !shouldUpdate();
+}
+
 void GameplayState::update()
 {
+    g_profiler.beginFrame();
+
     read_network();
 
     if (!netplay.active) {
@@ -2442,6 +2642,7 @@ void GameplayState::update()
         if (netplay.active)
             netplay.client.sendLeaveGameMessage();
         GameStateManager::instance().changeStateTo(&MenuState::instance());
+        g_profiler.endFrame();
         return;
     }
 
@@ -2462,14 +2663,20 @@ void GameplayState::update()
         if (game_values.screenfade == 255) {
             if (game_values.gamestate == GS_START_GAME) {
                 start_gameplay();
+                g_profiler.endFrame();
                 return;
             } else if (game_values.gamestate == GS_END_GAME) {
                 end_gameplay();
+                g_profiler.endFrame();
                 return;
             }
         }
 
         //--------------- draw everything ----------------------
+        if (fRenderingEnabled)
+            drawEverything(iCountDownState, iScoreTextOffset);
+    } else if (fRenderingEnabled && !gfx_screenpreserved()) {
+        //Just paused while drawing into a frontend buffer; put the match back under the dialog
         drawEverything(iCountDownState, iScoreTextOffset);
     }
 
@@ -2479,6 +2686,10 @@ void GameplayState::update()
 
     playMusic();
 
+    g_profiler.endFrame();
+
+    if (fRenderingEnabled && g_profiler.overlayEnabled())
+        drawProfilerOverlay();
 
 #ifdef _DEBUG
     if (g_fAutoTest)
@@ -9,8 +9,16 @@ class GameplayState : public GameState
     public:
         void update();
 
+        bool redrawsWholeScreen() const;
+        bool framesCanRepeat() const;
+
         static GameplayState& instance();
 
+        //Headless runs (see libretro/benchmark.cpp) only simulate the match
+        void setRenderingEnabled(bool enabled) {
+            fRenderingEnabled = enabled;
+        }
+
     private:
         GameplayState();
         ~GameplayState() {}
@@ -71,6 +79,15 @@ class GameplayState : public GameState
         short spindirection;
         short spintimer;
 
+        //Bumped every time a match starts so save states can't cross matches
+        unsigned int iMatchSerial;
+
+        bool fRenderingEnabled;
+
+        //Back map the last frame was drawn from, for the dirty rectangles
+        short iLastDrawIndex;
+
+    friend class SaveState;
 };
 
 #endif // GAMESTATE_GAMEPLAY_H
@@ -8,6 +8,7 @@
 #include "net.h"
 #include "map.h"
 #include "MapList.h"
+#include "MapPreviewCache.h"
 #include "ResourceManager.h"
 #include "Score.h"
 
@@ -105,6 +106,7 @@ extern void LoadCurrentMapBackground();
 extern TourStop * ParseTourStopLine(char * buffer, int32_t iVersion[4], bool fIsWorld);
 
 extern CMap* g_map;
+extern CTilesetManager* g_tilesetmanager;
 
 extern CScore *score[4];
 extern short score_cnt;
@@ -1041,6 +1043,9 @@ void MenuState::update()
         } else if (MENU_CODE_WORLD_GRAPHICS_PACK_CHANGED == code) {
             rm->LoadWorldGraphics();
         } else if (MENU_CODE_GAME_GRAPHICS_PACK_CHANGED == code) {
+            //Previews were drawn with the old tiles and backgrounds
+            g_mappreviews.clear();
+
             gfx_loadpalette(convertPathCP("gfx/packs/palette.png", gamegraphicspacklist->current_name()));
             rm->LoadGameGraphics();
         } else if (MENU_CODE_SOUND_PACK_CHANGED == code) {
@@ -1123,6 +1128,7 @@ void MenuState::update()
             mCurrentMenu = mMapFilterEditMenu;
             mCurrentMenu->ResetMenu();
         } else if (MENU_CODE_MAP_BROWSER_EXIT == code) {
+            mMapFilterEditMenu->miMapBrowser->Close();
             mGameSettingsMenu->miMapField->LoadCurrentMap();
             szCurrentMapName = mGameSettingsMenu->miMapField->GetMapName();
 
@@ -1345,6 +1351,12 @@ void MenuState::update()
 
     if (game_values.screenfade == 255) {
         if (GS_START_GAME == game_values.gamestate) {
+            //Previews still on the worker aren't shown anymore
+            g_mappreviews.cancel();
+
+            //Loaded the first time a match starts
+            rm->RequireMatchGraphics();
+
             if (game_values.matchtype == MATCH_TYPE_QUICK_GAME)
                 mModeOptionsMenu->SetRandomGameModeSettings(game_values.gamemode->gamemode);
             else if (game_values.matchtype == MATCH_TYPE_NET_GAME)
@@ -1493,12 +1505,16 @@ void MenuState::update()
         fGenerateMapThumbs = false;
         rm->backgroundmusic[2].sfx_pause();
 
+        //The worker mustn't read the thumbnails and maps while they're redone
+        g_mappreviews.cancel();
+
         //Reload map auto filters from live map files (don't use the cache)
         maplist->ReloadMapAutoFilters();
 
         //Write out all the map thumbnails for the map browser and filter editor
         char szThumbnail[256];
         std::map<std::string, MapListNode*>::iterator itr = maplist->GetIteratorAt(0, false);
+        CMap * thumbnailmap = new CMap(rm, g_tilesetmanager);
 
         short iMapCount = maplist->GetCount();
         for (short iMap = 0; iMap < iMapCount; iMap++) {
@@ -1512,12 +1528,14 @@ void MenuState::update()
             strcat(szThumbnail, ".bmp");
 #endif
 
-            g_map->loadMap((*itr).second->filename, read_type_preview);
-            g_map->saveThumbnail(convertPath(szThumbnail), false);
+            thumbnailmap->loadMap((*itr).second->filename, read_type_preview);
+            thumbnailmap->saveThumbnail(convertPath(szThumbnail), false);
 
             itr++;
         }
 
+        delete thumbnailmap;
+
         rm->backgroundmusic[2].sfx_pause();
     }
 }
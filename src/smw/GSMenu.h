@@ -79,6 +79,9 @@ class MenuState : public GameState
         bool init();
         void update();
 
+        bool redrawsWholeScreen() const { return true; }
+        bool framesCanRepeat() const { return true; }
+
         static MenuState& instance();
 
 #ifdef _DEBUG
@@ -12,6 +12,9 @@ class SplashScreenState : public GameState
         bool init();
         void update();
 
+        bool redrawsWholeScreen() const { return true; }
+        bool framesCanRepeat() const { return true; }
+
         static SplashScreenState& instance();
 
     private:
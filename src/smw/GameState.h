@@ -8,6 +8,13 @@ class GameState
         virtual void update() = 0;
         virtual void cleanup() {}
 
+        //Whether the next frame paints every pixel of the screen, so it can be
+        //drawn straight into a buffer with undefined contents
+        virtual bool redrawsWholeScreen() const { return false; }
+
+        //Whether frames are often the same as the one before (menus, pause)
+        virtual bool framesCanRepeat() const { return false; }
+
     protected:
         virtual void onEnterState() {}
         virtual void onLeaveState() {}
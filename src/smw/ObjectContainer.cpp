@@ -5,6 +5,7 @@
 #include "objectgame.h"
 #include "RandomNumberGenerator.h"
 
+#include <algorithm>
 #include <cmath>
 
 extern CGameValues game_values;
@@ -32,6 +33,12 @@ void CObjectContainer::clean()
         list[i] = NULL;
     }
     list_end = 0;
+
+    for (short iType = 0; iType < OBJECTTYPE_LAST; iType++)
+        typeIndex[iType].clear();
+
+    for (short iType = 0; iType < MOVINGOBJECT_LAST; iType++)
+        movingTypeIndex[iType].clear();
 }
 
 bool CObjectContainer::add(CObject* ec)
@@ -44,10 +51,69 @@ bool CObjectContainer::add(CObject* ec)
 
     list[list_end] = ec;
     ec->index = list_end;	// save index for removing
+    addToIndex(list_end);
     list_end++;
     return true;
 }
 
+void CObjectContainer::reindex()
+{
+    for (short iType = 0; iType < OBJECTTYPE_LAST; iType++)
+        typeIndex[iType].clear();
+
+    for (short iType = 0; iType < MOVINGOBJECT_LAST; iType++)
+        movingTypeIndex[iType].clear();
+
+    for (short i = 0; i < list_end; i++)
+        addToIndex(i);
+}
+
+//Object types are fixed once an object is constructed, so they are only looked up here
+void CObjectContainer::addToIndex(short i)
+{
+    ObjectType type = list[i]->getObjectType();
+    typeIndex[type].push_back(i);
+
+    if (type == object_moving)
+        movingTypeIndex[((IO_MovingObject*)list[i])->getMovingObjectType()].push_back(i);
+}
+
+void CObjectContainer::removeFromIndex(short i)
+{
+    ObjectType type = list[i]->getObjectType();
+
+    std::vector<short> * buckets[2] = {&typeIndex[type], NULL};
+    if (type == object_moving)
+        buckets[1] = &movingTypeIndex[((IO_MovingObject*)list[i])->getMovingObjectType()];
+
+    for (short iBucket = 0; iBucket < 2 && buckets[iBucket]; iBucket++) {
+        std::vector<short>& bucket = *buckets[iBucket];
+        bucket.erase(std::lower_bound(bucket.begin(), bucket.end(), i));
+    }
+}
+
+//Called after the last object in the list was moved to "to", which makes it the last entry of its buckets
+void CObjectContainer::moveLastInIndex(short to)
+{
+    ObjectType type = list[to]->getObjectType();
+
+    std::vector<short> * buckets[2] = {&typeIndex[type], NULL};
+    if (type == object_moving)
+        buckets[1] = &movingTypeIndex[((IO_MovingObject*)list[to])->getMovingObjectType()];
+
+    for (short iBucket = 0; iBucket < 2 && buckets[iBucket]; iBucket++) {
+        std::vector<short>& bucket = *buckets[iBucket];
+
+        size_t iEntry = bucket.size() - 1;
+        while (iEntry > 0 && bucket[iEntry - 1] > to) {
+            bucket[iEntry] = bucket[iEntry - 1];
+            iEntry--;
+        }
+
+        bucket[iEntry] = to;
+    }
+}
+
 void CObjectContainer::update()
 {
     for (short i = 0; i < list_end; i++)
@@ -62,10 +128,13 @@ void CObjectContainer::draw()
 
 bool CObjectContainer::isBlockAt(short x, short y)
 {
-    for (short i = 0; i < list_end; i++) {
-        if (x >= list[i]->ix && x < list[i]->ix + list[i]->iw &&
-                y >= list[i]->iy && y < list[i]->iy + list[i]->ih &&
-                list[i]->getObjectType() == object_block) {
+    const std::vector<short>& blocks = typeIndex[object_block];
+
+    for (size_t iBlock = 0; iBlock < blocks.size(); iBlock++) {
+        CObject * block = list[blocks[iBlock]];
+
+        if (x >= block->ix && x < block->ix + block->iw &&
+                y >= block->iy && y < block->iy + block->ih) {
             return true;
         }
     }
@@ -77,9 +146,13 @@ float CObjectContainer::getClosestObject(short ix, short iy, short objectType)
 {
     int dist = smw->ScreenWidth * 1000;  //Longest distance from corner to corner squared
 
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() != objectType)
-            continue;
+    if (objectType < 0 || objectType >= OBJECTTYPE_LAST)
+        return (float)sqrt((double)dist);
+
+    const std::vector<short>& objects = typeIndex[objectType];
+
+    for (size_t iObject = 0; iObject < objects.size(); iObject++) {
+        short i = objects[iObject];
 
         short x = list[i]->ix - ix;
         short y = list[i]->iy - iy;
@@ -97,9 +170,13 @@ float CObjectContainer::getClosestMovingObject(short ix, short iy, short movingO
 {
     int dist = smw->ScreenWidth * 1000;  //Longest distance from corner to corner squared
 
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() != object_moving || ((IO_MovingObject*)list[i])->getMovingObjectType() != movingObjectType)
-            continue;
+    if (movingObjectType < 0 || movingObjectType >= MOVINGOBJECT_LAST)
+        return (float)sqrt((double)dist);
+
+    const std::vector<short>& objects = movingTypeIndex[movingObjectType];
+
+    for (size_t iObject = 0; iObject < objects.size(); iObject++) {
+        short i = objects[iObject];
 
         short x = list[i]->ix - ix;
         short y = list[i]->iy - iy;
@@ -115,45 +192,29 @@ float CObjectContainer::getClosestMovingObject(short ix, short iy, short movingO
 
 short CObjectContainer::countTypes(ObjectType type)
 {
-    short count = 0;
-
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() == type) {
-            count++;
-        }
-    }
-
-    return count;
+    return (short)typeIndex[type].size();
 }
 
 short CObjectContainer::countMovingTypes(MovingObjectType type)
 {
-    short count = 0;
-
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() == object_moving && ((IO_MovingObject*)list[i])->getMovingObjectType() == type) {
-            count++;
-        }
-    }
-
-    return count;
+    return (short)movingTypeIndex[type].size();
 }
 
 void CObjectContainer::adjustPlayerAreas(CPlayer * player, CPlayer * other)
 {
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() == object_area) {
-            OMO_Area * area = (OMO_Area*)list[i];
+    const std::vector<short>& areas = typeIndex[object_area];
 
-            if (area->colorID == other->colorID) {
-                if (game_values.gamemodesettings.domination.relocateondeath)
-                    area->placeArea();
+    for (size_t iArea = 0; iArea < areas.size(); iArea++) {
+        OMO_Area * area = (OMO_Area*)list[areas[iArea]];
 
-                if (game_values.gamemodesettings.domination.stealondeath && player)
-                    area->setOwner(player);
-                else if (game_values.gamemodesettings.domination.loseondeath)
-                    area->reset();
-            }
+        if (area->colorID == other->colorID) {
+            if (game_values.gamemodesettings.domination.relocateondeath)
+                area->placeArea();
+
+            if (game_values.gamemodesettings.domination.stealondeath && player)
+                area->setOwner(player);
+            else if (game_values.gamemodesettings.domination.loseondeath)
+                area->reset();
         }
     }
 }
@@ -163,30 +224,24 @@ void CObjectContainer::removePlayerRaceGoals(short id, short iGoal)
     if (game_values.gamemodesettings.race.penalty == 0 && iGoal != -1)
         return;
 
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() == object_race_goal) {
-            OMO_RaceGoal * goal = (OMO_RaceGoal*)list[i];
+    const std::vector<short>& goals = typeIndex[object_race_goal];
 
-            if (iGoal == -1 || 2 == game_values.gamemodesettings.race.penalty ||
-                    (1 == game_values.gamemodesettings.race.penalty && goal->getGoalID() == iGoal)) {
-                goal->reset(id);
-            }
+    for (size_t iRaceGoal = 0; iRaceGoal < goals.size(); iRaceGoal++) {
+        OMO_RaceGoal * goal = (OMO_RaceGoal*)list[goals[iRaceGoal]];
+
+        if (iGoal == -1 || 2 == game_values.gamemodesettings.race.penalty ||
+                (1 == game_values.gamemodesettings.race.penalty && goal->getGoalID() == iGoal)) {
+            goal->reset(id);
         }
     }
 }
 
 void CObjectContainer::pushBombs(short x, short y)
 {
-    for (short i = 0; i < list_end; i++) {
-        if (list[i]->getObjectType() != object_moving)
-            continue;
-
-        IO_MovingObject * mo = (IO_MovingObject*)list[i];
-
-        if (mo->getMovingObjectType() != movingobject_bomb)
-            continue;
+    const std::vector<short>& bombs = movingTypeIndex[movingobject_bomb];
 
-        CO_Bomb * bomb = (CO_Bomb*)list[i];
+    for (size_t iBomb = 0; iBomb < bombs.size(); iBomb++) {
+        CO_Bomb * bomb = (CO_Bomb*)list[bombs[iBomb]];
 
         if (bomb->HasOwner())
             continue;
@@ -211,11 +266,13 @@ void CObjectContainer::cleandeadobjects()
 {
     for (short i = 0; i < list_end; i++) {
         if (list[i]->dead) {
+            removeFromIndex(i);
             delete list[i];
             list_end--;
 
             if (i != list_end) {
                 list[i] = list[list_end];
+                moveLastInIndex(i);
             }
 
             i--;
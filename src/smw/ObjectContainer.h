@@ -5,6 +5,8 @@
 #include "ObjectBase.h"
 #include "player.h"
 
+#include <vector>
+
 //object container
 class CObjectContainer
 {
@@ -31,9 +33,22 @@ class CObjectContainer
 
         CObject * getRandomObject();
 
+        //Rebuilds the type indices after list was overwritten directly (save states)
+        void reindex();
+
     public:
         CObject *list[MAXOBJECTS];
         short        list_end;
+
+    private:
+        //Indices into list per object type and per moving object type, kept in
+        //ascending order so walking a bucket visits objects in list order
+        std::vector<short> typeIndex[OBJECTTYPE_LAST];
+        std::vector<short> movingTypeIndex[MOVINGOBJECT_LAST];
+
+        void addToIndex(short i);
+        void removeFromIndex(short i);
+        void moveLastInIndex(short to);
 };
 
 #endif // OBJECTCONTAINER_H
@@ -0,0 +1,148 @@
+#include "ObjectGrid.h"
+
+#include "Game.h"
+#include "ObjectContainer.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern CGame *smw;
+
+//Rounds towards negative infinity, objects can hang off the top and left of the screen
+static short floordiv(short value, short divisor)
+{
+    return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+}
+
+//------------------------------------------------------------------------------
+// class object grid
+//------------------------------------------------------------------------------
+CObjectGrid::CObjectGrid()
+{
+    fEnabled = false;
+
+    iCols = 0;
+    iRows = 0;
+
+    for (short i = 0; i < OBJECTGRID_MAXCONTAINERS; i++)
+        iIndexedEnd[i] = 0;
+
+    memset(visited, 0, sizeof(visited));
+    iVisitMark = 0;
+}
+
+void CObjectGrid::build(CObjectContainer * containers, short iNumContainers)
+{
+    //The column wrap only lines up with coldec_obj2obj() when the screen is a whole number of tiles
+    fEnabled = smw->ScreenWidth % TILESIZE == 0 && iNumContainers <= OBJECTGRID_MAXCONTAINERS;
+
+    if (!fEnabled)
+        return;
+
+    iCols = smw->ScreenWidth / TILESIZE;
+    iRows = (smw->ScreenHeight + TILESIZE - 1) / TILESIZE;
+
+    cells.assign(iCols * iRows, -1);
+    entries.clear();
+
+    for (short iContainer = 0; iContainer < OBJECTGRID_MAXCONTAINERS; iContainer++) {
+        iIndexedEnd[iContainer] = iContainer < iNumContainers ? containers[iContainer].list_end : 0;
+
+        for (short iIndex = 0; iIndex < iIndexedEnd[iContainer]; iIndex++) {
+            CObject * object = containers[iContainer].list[iIndex];
+
+            if (object->getObjectType() != object_moving)
+                continue;
+
+            short iKey = iContainer * MAXOBJECTS + iIndex;
+            CellRange& range = ranges[iKey];
+
+            ObjectBox& box = boxes[iKey];
+            box.ix = object->ix;
+            box.iy = object->iy;
+            box.iWidth = object->collisionWidth;
+            box.iHeight = object->collisionHeight;
+
+            //Edges are inclusive, coldec_obj2obj() counts touching boxes as colliding
+            range.iLeft = floordiv(object->ix, TILESIZE);
+            range.iRight = floordiv(object->ix + object->collisionWidth, TILESIZE);
+
+            if (range.iRight - range.iLeft >= iCols)
+                range.iRight = range.iLeft + iCols - 1;
+
+            //Everything above or below the screen shares the edge rows, which only adds candidates
+            range.iTop = std::max((short)0, std::min((short)(iRows - 1), floordiv(object->iy, TILESIZE)));
+            range.iBottom = std::max((short)0, std::min((short)(iRows - 1), floordiv(object->iy + object->collisionHeight, TILESIZE)));
+
+            for (short iRow = range.iTop; iRow <= range.iBottom; iRow++) {
+                for (short iCol = range.iLeft; iCol <= range.iRight; iCol++) {
+                    int iCell = iRow * iCols + (iCol % iCols + iCols) % iCols;
+
+                    CellEntry entry;
+                    entry.iKey = iKey;
+                    entry.iNext = cells[iCell];
+
+                    cells[iCell] = (int)entries.size();
+                    entries.push_back(entry);
+                }
+            }
+        }
+    }
+}
+
+bool CObjectGrid::rebuildIfMoved(CObjectContainer * containers, short iNumContainers)
+{
+    if (!fEnabled)
+        return false;
+
+    for (short iContainer = 0; iContainer < iNumContainers; iContainer++) {
+        for (short iIndex = 0; iIndex < iIndexedEnd[iContainer]; iIndex++) {
+            CObject * object = containers[iContainer].list[iIndex];
+
+            if (object->getObjectType() != object_moving)
+                continue;
+
+            const ObjectBox& box = boxes[iContainer * MAXOBJECTS + iIndex];
+
+            if (box.ix != object->ix || box.iy != object->iy ||
+                box.iWidth != object->collisionWidth || box.iHeight != object->collisionHeight) {
+                build(containers, iNumContainers);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void CObjectGrid::getCandidates(short iContainer, short iIndex, std::vector<short>& candidates)
+{
+    candidates.clear();
+
+    if (++iVisitMark == 0) {
+        memset(visited, 0, sizeof(visited));
+        iVisitMark = 1;
+    }
+
+    short iObjectKey = iContainer * MAXOBJECTS + iIndex;
+    const CellRange& range = ranges[iObjectKey];
+
+    for (short iRow = range.iTop; iRow <= range.iBottom; iRow++) {
+        for (short iCol = range.iLeft; iCol <= range.iRight; iCol++) {
+            int iEntry = cells[iRow * iCols + (iCol % iCols + iCols) % iCols];
+
+            while (iEntry >= 0) {
+                short iKey = entries[iEntry].iKey;
+
+                if (iKey > iObjectKey && visited[iKey] != iVisitMark) {
+                    visited[iKey] = iVisitMark;
+                    candidates.push_back(iKey);
+                }
+
+                iEntry = entries[iEntry].iNext;
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+}
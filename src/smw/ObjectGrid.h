@@ -0,0 +1,76 @@
+#ifndef OBJECTGRID_H
+#define OBJECTGRID_H
+
+#include "GlobalConstants.h"
+
+#include <vector>
+
+class CObjectContainer;
+
+#define OBJECTGRID_MAXCONTAINERS    3
+
+//Broadphase for moving object collisions. Each frame the moving objects of the
+//containers are bucketed into tile sized cells; columns wrap around the screen
+//the same way coldec_obj2obj() does, so two objects that can collide across the
+//left and right edges always share a cell. Collision handlers can move objects
+//during the sweep, so after one ran the grid is built again if anything moved.
+//
+//Objects are identified by a key of container * MAXOBJECTS + index, which is
+//also the order the full O(n^2) sweep visits them in.
+class CObjectGrid
+{
+    public:
+        CObjectGrid();
+
+        void build(CObjectContainer * containers, short iNumContainers);
+
+        //Builds again if an indexed object moved or changed size since the
+        //last build, returns whether it did
+        bool rebuildIfMoved(CObjectContainer * containers, short iNumContainers);
+
+        //Objects added to a container after build() are not in the grid
+        bool isIndexed(short iContainer, short iIndex) const {
+            return fEnabled && iIndex < iIndexedEnd[iContainer];
+        }
+
+        short indexedEnd(short iContainer) const {
+            return fEnabled ? iIndexedEnd[iContainer] : 0;
+        }
+
+        //Keys of the indexed moving objects that come after this one and share
+        //at least one cell with it, in ascending order
+        void getCandidates(short iContainer, short iIndex, std::vector<short>& candidates);
+
+    private:
+        struct CellEntry {
+            short iKey;
+            int iNext;
+        };
+
+        struct CellRange {
+            short iLeft, iRight;
+            short iTop, iBottom;
+        };
+
+        //Where an object was when it was bucketed
+        struct ObjectBox {
+            short ix, iy;
+            short iWidth, iHeight;
+        };
+
+        bool fEnabled;
+
+        short iCols, iRows;
+        short iIndexedEnd[OBJECTGRID_MAXCONTAINERS];
+
+        std::vector<int> cells;
+        std::vector<CellEntry> entries;
+
+        CellRange ranges[OBJECTGRID_MAXCONTAINERS * MAXOBJECTS];
+        ObjectBox boxes[OBJECTGRID_MAXCONTAINERS * MAXOBJECTS];
+
+        unsigned int visited[OBJECTGRID_MAXCONTAINERS * MAXOBJECTS];
+        unsigned int iVisitMark;
+};
+
+#endif // OBJECTGRID_H
@@ -0,0 +1,559 @@
+#include "SaveState.h"
+
+#include "eyecandy.h"
+#include "gamemodes.h"
+#include "GameplayHeap.h"
+#include "GameValues.h"
+#include "GSGameplay.h"
+#include "map.h"
+#include "movingplatform.h"
+#include "ObjectContainer.h"
+#include "objects/moving/MovingObject.h"
+#include "player.h"
+#include "RandomNumberGenerator.h"
+#include "SaveStateStream.h"
+
+#include <ctime>
+#include <list>
+
+#define SAVESTATE_MAGIC     0x534D5753  //"SMWS"
+#define SAVESTATE_VERSION   2
+
+//Room for everything outside the arenas: containers, map arrays, game mode and platforms
+#define SAVESTATE_RESERVE   (256 * 1024)
+
+extern CGameValues game_values;
+extern CMap* g_map;
+
+extern CPlayer* list_players[4];
+extern short list_players_cnt;
+
+extern CScore *score[4];
+extern short score_cnt;
+
+extern short x_shake;
+extern short y_shake;
+
+extern int g_iNextNetworkID;
+extern short g_iWinningPlayer;
+
+extern CObjectContainer noncolcontainer;
+extern CObjectContainer objectcontainer[3];
+extern CEyecandyContainer eyecandy[3];
+extern SpotlightManager spotlightManager;
+
+struct SaveStateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t session;   //Different every time the core is started
+    uint32_t match;     //0 if the state was taken outside of a match
+};
+
+static uint32_t sessionToken()
+{
+    static uint32_t token = 0;
+
+    //Mix in the arena address too, two cores started in the same second still differ
+    while (token == 0)
+        token = (uint32_t)time(NULL) ^ (uint32_t)(uintptr_t)&g_gameplayheap;
+
+    return token;
+}
+
+//------------------------------------------------------------------------------
+// class save state
+//------------------------------------------------------------------------------
+size_t SaveState::maxSize()
+{
+    return sizeof(SaveStateHeader) + OBJECTHEAP_SIZE + EYECANDYHEAP_SIZE + GAMEPLAYHEAP_SIZE + SAVESTATE_RESERVE;
+}
+
+bool SaveState::inMatch()
+{
+    return GameStateManager::instance().currentState == &GameplayState::instance();
+}
+
+unsigned int SaveState::currentMatchSerial()
+{
+    if (!inMatch())
+        return 0;
+
+    return GameplayState::instance().iMatchSerial;
+}
+
+bool SaveState::save(void * data, size_t size)
+{
+    if (size < maxSize())
+        return false;
+
+    SaveStateHeader header;
+    header.magic = SAVESTATE_MAGIC;
+    header.version = SAVESTATE_VERSION;
+    header.session = sessionToken();
+    header.match = currentMatchSerial();
+
+    //The match can't be captured while part of it lives outside the arenas
+    if (header.match != 0 && heapsOverflowed())
+        return false;
+
+    SaveStateStream stream(SaveStateStream::mode_save, (uint8_t *)data, size);
+    stream.sync(header);
+
+    if (header.match != 0)
+        syncMatch(stream);
+
+    if (stream.failed())
+        return false;
+
+    //Keep the unused tail stable so frontends can diff consecutive states cheaply
+    memset((uint8_t *)data + stream.position(), 0, size - stream.position());
+    return true;
+}
+
+bool SaveState::load(const void * data, size_t size)
+{
+    if (size < maxSize())
+        return false;
+
+    SaveStateHeader header;
+    memcpy(&header, data, sizeof(SaveStateHeader));
+
+    if (header.magic != SAVESTATE_MAGIC || header.version != SAVESTATE_VERSION || header.session != sessionToken())
+        return false;
+
+    if (header.match != currentMatchSerial())
+        return false;
+
+    //Taken outside of a match, there is nothing to restore
+    if (header.match == 0)
+        return true;
+
+    if (heapsOverflowed())
+        return false;
+
+    SaveStateStream stream(SaveStateStream::mode_load, (uint8_t *)data, size);
+    stream.sync(header);
+    syncMatch(stream);
+
+    return !stream.failed();
+}
+
+bool SaveState::heapsOverflowed()
+{
+    return g_objectheap.overflowCount() > 0 || g_eyecandyheap.overflowCount() > 0 || g_gameplayheap.overflowCount() > 0;
+}
+
+void SaveState::syncHeap(SaveStateStream& stream, CGameplayHeap& heap)
+{
+    //The arena and the allocator bookkeeping that goes with it
+    stream.sync(heap.iTop);
+
+    if (heap.iTop > heap.iCapacity) {
+        stream.fail();
+        return;
+    }
+
+    stream.raw(heap.pool, heap.iTop);
+    stream.sync(heap.freelist);
+
+    stream.sync(heap.iLiveCount);
+    stream.sync(heap.iPeakLiveCount);
+    stream.sync(heap.iAllocationCount);
+    stream.sync(heap.iOverflowAllocationCount);
+}
+
+void SaveState::syncMatch(SaveStateStream& stream)
+{
+    //The generator is always Well512, see RandomNumberGenerator()
+    Well512RandomNumberGenerator& rng = static_cast<Well512RandomNumberGenerator&>(RandomNumberGenerator::generator());
+    stream.sync(rng.state);
+    stream.sync(rng.index);
+
+    syncHeap(stream, g_objectheap);
+    syncHeap(stream, g_eyecandyheap);
+    syncHeap(stream, g_gameplayheap);
+
+    if (stream.failed())
+        return;
+
+    //Everything outside the arenas that points into them
+    stream.sync(noncolcontainer.list);
+    stream.sync(noncolcontainer.list_end);
+
+    for (short i = 0; i < 3; i++) {
+        stream.sync(objectcontainer[i].list);
+        stream.sync(objectcontainer[i].list_end);
+    }
+
+    if (stream.isLoading()) {
+        noncolcontainer.reindex();
+
+        for (short i = 0; i < 3; i++)
+            objectcontainer[i].reindex();
+    }
+
+    for (short i = 0; i < 3; i++) {
+        stream.sync(eyecandy[i].list);
+        stream.sync(eyecandy[i].list_end);
+    }
+
+    std::vector<Spotlight*>& spotlights = spotlightManager.spotlightList;
+    uint32_t iNumSpotlights = (uint32_t)spotlights.size();
+    stream.sync(iNumSpotlights);
+
+    if (stream.isLoading())
+        spotlights.resize(iNumSpotlights);
+
+    if (iNumSpotlights > 0)
+        stream.raw(&spotlights[0], sizeof(Spotlight*) * iNumSpotlights);
+
+    stream.sync(list_players);
+    stream.sync(list_players_cnt);
+
+    for (short i = 0; i < 4; i++)
+        stream.raw(score[i], sizeof(CScore));
+
+    stream.sync(score_cnt);
+
+    stream.sync(x_shake);
+    stream.sync(y_shake);
+    stream.sync(g_iNextNetworkID);
+    stream.sync(g_iWinningPlayer);
+
+    syncGameValues(stream);
+    syncGameplayState(stream);
+
+    //The active mode object itself stays put for the whole match, only its contents change
+    stream.sync(game_values.gamemode);
+    stream.raw(game_values.gamemode, gameModeSize(game_values.gamemode));
+
+    syncMap(stream);
+    syncTempPlatforms(stream);
+}
+
+void SaveState::syncGameValues(SaveStateStream& stream)
+{
+    stream.sync(game_values.gamestate);
+
+    stream.sync(game_values.pausegame);
+    stream.sync(game_values.exitinggame);
+    stream.sync(game_values.exityes);
+
+    stream.sync(game_values.showscoreboard);
+    stream.sync(game_values.scorepercentmove);
+
+    stream.sync(game_values.tournamentwinner);
+
+    stream.sync(game_values.slowdownon);
+    stream.sync(game_values.slowdowncounter);
+
+    stream.sync(game_values.storedpowerups);
+    stream.sync(game_values.gamepowerups);
+
+    stream.sync(game_values.worldpowerups);
+    stream.sync(game_values.worldpowerupcount);
+
+    stream.sync(game_values.screenshaketimer);
+    stream.sync(game_values.screenshakeleft);
+    stream.sync(game_values.screenshakeplayerid);
+    stream.sync(game_values.screenshaketeamid);
+    stream.sync(game_values.screenshakekillinair);
+    stream.sync(game_values.screenshakekillscount);
+
+    stream.sync(game_values.bulletbilltimer);
+    stream.sync(game_values.bulletbillspawntimer);
+
+    stream.sync(game_values.teamdeadcounter);
+    stream.sync(game_values.cputurn);
+
+    stream.sync(game_values.tournament_scores);
+
+    stream.sync(game_values.playskidsound);
+    stream.sync(game_values.playinvinciblesound);
+    stream.sync(game_values.playflyingsound);
+
+    stream.sync(game_values.swapplayers);
+    stream.sync(game_values.swapplayersposition);
+    stream.sync(game_values.swapplayersblink);
+    stream.sync(game_values.swapplayersblinkcount);
+
+    stream.sync(game_values.screenfade);
+    stream.sync(game_values.screenfadespeed);
+
+    stream.sync(game_values.noexit);
+    stream.sync(game_values.noexittimer);
+    stream.sync(game_values.forceexittimer);
+
+    stream.sync(game_values.gamewindx);
+    stream.sync(game_values.gamewindy);
+
+    stream.sync(game_values.windaffectsplayers);
+    stream.sync(game_values.spinscreen);
+    stream.sync(game_values.reversewalk);
+    stream.sync(game_values.spotlights);
+
+    stream.sync(game_values.unlocksecret1part1);
+    stream.sync(game_values.unlocksecret1part2);
+    stream.sync(game_values.unlocksecret2part1);
+    stream.sync(game_values.unlocksecret2part2);
+    stream.sync(game_values.unlocksecret3part1);
+    stream.sync(game_values.unlocksecret3part2);
+    stream.sync(game_values.unlocksecretunlocked);
+
+    stream.sync(game_values.playerInput.outputControls);
+}
+
+void SaveState::syncGameplayState(SaveStateStream& stream)
+{
+    GameplayState& gameplay = GameplayState::instance();
+
+    stream.sync(gameplay.iCountDownState);
+    stream.sync(gameplay.iCountDownTimer);
+    stream.sync(gameplay.iWindTimer);
+    stream.sync(gameplay.dNextWind);
+    stream.sync(gameplay.iScoreTextOffset);
+
+    stream.sync(gameplay.respawnCount);
+    stream.sync(gameplay.respawnanimationtimer);
+    stream.sync(gameplay.respawnanimationframe);
+
+    stream.sync(gameplay.current_playerKeys);
+    stream.sync(gameplay.previous_playerKeys);
+
+    stream.sync(gameplay.spinangle);
+    stream.sync(gameplay.spinspeed);
+    stream.sync(gameplay.spindirection);
+    stream.sync(gameplay.spintimer);
+}
+
+void SaveState::syncMap(SaveStateStream& stream)
+{
+    CMap& map = *g_map;
+
+    stream.sync(map.mapdatatop);
+    stream.sync(map.objectdata);
+    stream.sync(map.blockdata);
+    stream.sync(map.nospawn);
+
+    stream.sync(map.spawnareas);
+    stream.sync(map.numspawnareas);
+    stream.sync(map.totalspawnsize);
+
+    stream.sync(map.warpexits);
+    stream.sync(map.warplocktimer);
+    stream.sync(map.warplocked);
+
+    stream.sync(map.iSwitches);
+
+    stream.sync(map.iTileAnimationTimer);
+    stream.sync(map.iTileAnimationFrame);
+
+    //Permanent platforms are owned by the map, so only their contents are saved
+    for (short iPlatform = 0; iPlatform < map.iNumPlatforms; iPlatform++) {
+        MovingPlatform * platform = map.platforms[iPlatform];
+        MovingPlatformPath * path = platform->pPath;
+
+        stream.raw(platform, sizeof(MovingPlatform));
+
+        switch (path->GetType()) {
+        case 0:
+            stream.raw(path, sizeof(StraightPath));
+            break;
+        case 1:
+            stream.raw(path, sizeof(StraightPathContinuous));
+            break;
+        case 2:
+            stream.raw(path, sizeof(EllipsePath));
+            break;
+        default:
+            stream.raw(path, sizeof(FallingPath));
+            break;
+        }
+    }
+}
+
+//Temporary platforms (falling donut blocks) come and go on the system heap, so
+//they are saved in full and rebuilt on load. Anything riding one is pointed at
+//the rebuilt copy afterwards.
+void SaveState::syncTempPlatforms(SaveStateStream& stream)
+{
+    std::list<MovingPlatform*>& tempPlatforms = g_map->tempPlatforms;
+
+    if (stream.isLoading()) {
+        std::list<MovingPlatform*>::iterator iter = tempPlatforms.begin(), lim = tempPlatforms.end();
+        while (iter != lim) {
+            delete (*iter);
+            ++iter;
+        }
+
+        tempPlatforms.clear();
+    }
+
+    uint32_t iNumPlatforms = (uint32_t)tempPlatforms.size();
+    stream.sync(iNumPlatforms);
+
+    std::list<MovingPlatform*>::iterator iter = tempPlatforms.begin();
+
+    for (uint32_t iPlatform = 0; iPlatform < iNumPlatforms && !stream.failed(); iPlatform++) {
+        MovingPlatform * platform = stream.isLoading() ? NULL : *iter++;
+
+        //Snapshot images, written straight from the live objects when saving
+        union {
+            uint8_t bytes[sizeof(MovingPlatform)];
+            double align;
+        } platformImage;
+
+        union {
+            uint8_t bytes[sizeof(FallingPath)];
+            double align;
+        } pathImage;
+
+        if (!stream.isLoading()) {
+            if (platform->pPath->GetType() != 3) {
+                stream.fail();
+                return;
+            }
+
+            memcpy(platformImage.bytes, platform, sizeof(MovingPlatform));
+            memcpy(pathImage.bytes, platform->pPath, sizeof(FallingPath));
+        }
+
+        MovingPlatform * oldPlatform = platform;
+        stream.sync(oldPlatform);
+        stream.sync(platformImage.bytes);
+        stream.sync(pathImage.bytes);
+
+        MovingPlatform * image = (MovingPlatform *)platformImage.bytes;
+        short iTileWidth = image->iTileWidth;
+        short iTileHeight = image->iTileHeight;
+
+        TilesetTile ** tiledata = platform ? platform->iTileData : NULL;
+        MapTile ** typedata = platform ? platform->iTileType : NULL;
+
+        if (stream.isLoading()) {
+            tiledata = new TilesetTile*[iTileWidth];
+            typedata = new MapTile*[iTileWidth];
+
+            for (short iCol = 0; iCol < iTileWidth; iCol++) {
+                tiledata[iCol] = new TilesetTile[iTileHeight];
+                typedata[iCol] = new MapTile[iTileHeight];
+            }
+        }
+
+        for (short iCol = 0; iCol < iTileWidth; iCol++) {
+            stream.raw(tiledata[iCol], sizeof(TilesetTile) * iTileHeight);
+            stream.raw(typedata[iCol], sizeof(MapTile) * iTileHeight);
+        }
+
+        if (!stream.isLoading())
+            continue;
+
+        //Build a fresh platform so it gets its own surfaces, then put the saved state back on top
+        FallingPath * path = new FallingPath(0.0f, 0.0f);
+        platform = new MovingPlatform(g_map, tiledata, typedata, iTileWidth, iTileHeight, image->iDrawLayer, path, false);
+
+        SDL_Surface * surfaces[2] = {platform->sSurface[0], platform->sSurface[1]};
+
+        memcpy((void *)platform, platformImage.bytes, sizeof(MovingPlatform));
+        platform->iTileData = tiledata;
+        platform->iTileType = typedata;
+        platform->sSurface[0] = surfaces[0];
+        platform->sSurface[1] = surfaces[1];
+        platform->pPath = path;
+
+        memcpy((void *)path, pathImage.bytes, sizeof(FallingPath));
+        path->SetPlatform(platform);
+
+        tempPlatforms.push_back(platform);
+        remapPlatform(oldPlatform, platform);
+    }
+
+    //The restored platforms are somewhere else than the indexed ones
+    if (stream.isLoading())
+        g_map->invalidatePlatformIndex();
+}
+
+size_t SaveState::gameModeSize(CGameMode * mode)
+{
+    switch (mode->getgamemode()) {
+    case game_mode_classic:
+        return sizeof(CGM_Classic);
+    case game_mode_frag:
+        return sizeof(CGM_Frag);
+    case game_mode_timelimit:
+        return sizeof(CGM_TimeLimit);
+    case game_mode_jail:
+        return sizeof(CGM_Jail);
+    case game_mode_coins:
+        return sizeof(CGM_Coins);
+    case game_mode_stomp:
+        return sizeof(CGM_Stomp);
+    case game_mode_eggs:
+        return sizeof(CGM_Eggs);
+    case game_mode_ctf:
+        return sizeof(CGM_CaptureTheFlag);
+    case game_mode_chicken:
+        return sizeof(CGM_Chicken);
+    case game_mode_tag:
+        return sizeof(CGM_Tag);
+    case game_mode_star:
+        return sizeof(CGM_Star);
+    case game_mode_domination:
+        return sizeof(CGM_Domination);
+    case game_mode_koth:
+        return sizeof(CGM_KingOfTheHill);
+    case game_mode_race:
+        return sizeof(CGM_Race);
+    case game_mode_owned:
+        return sizeof(CGM_Owned);
+    case game_mode_frenzy:
+        return sizeof(CGM_Frenzy);
+    case game_mode_survival:
+        return sizeof(CGM_Survival);
+    case game_mode_greed:
+        return sizeof(CGM_Greed);
+    case game_mode_health:
+        return sizeof(CGM_Health);
+    case game_mode_collection:
+        return sizeof(CGM_Collection);
+    case game_mode_chase:
+        return sizeof(CGM_Chase);
+    case game_mode_shyguytag:
+        return sizeof(CGM_ShyGuyTag);
+    case game_mode_bonus:
+        return sizeof(CGM_Bonus);
+    case game_mode_pipe_minigame:
+        return sizeof(CGM_Pipe_MiniGame);
+    case game_mode_boss_minigame:
+        return sizeof(CGM_Boss_MiniGame);
+    case game_mode_boxes_minigame:
+        return sizeof(CGM_Boxes_MiniGame);
+    default:
+        return sizeof(CGameMode);
+    }
+}
+
+void SaveState::remapPlatform(MovingPlatform * from, MovingPlatform * to)
+{
+    for (short iPlayer = 0; iPlayer < list_players_cnt; iPlayer++) {
+        if (list_players[iPlayer]->platform == from)
+            list_players[iPlayer]->platform = to;
+    }
+
+    CObjectContainer * containers[4] = {&noncolcontainer, &objectcontainer[0], &objectcontainer[1], &objectcontainer[2]};
+
+    for (short iContainer = 0; iContainer < 4; iContainer++) {
+        CObjectContainer * container = containers[iContainer];
+
+        for (short i = 0; i < container->list_end; i++) {
+            ObjectType type = container->list[i]->getObjectType();
+
+            if (type != object_moving && type != object_frenzycard)
+                continue;
+
+            IO_MovingObject * object = (IO_MovingObject *)container->list[i];
+            if (object->platform == from)
+                object->platform = to;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stddef.h>
+
+class CGameMode;
+class CGameplayHeap;
+class MovingPlatform;
+class SaveStateStream;
+
+//Snapshots of a running match for the libretro serialization interface
+//(save states, rewind, run-ahead). Everything the simulation owns lives in
+//the gameplay heaps, so a state is those arenas plus the handful of globals,
+//map arrays and platforms that point into it or sit beside it.
+//
+//States are only valid in the session and match that produced them: the
+//arena is restored byte for byte, so all pointers must still mean the same
+//thing when the state is loaded. Outside of a match a state carries just its
+//header and loading it changes nothing.
+class SaveState
+{
+    public:
+        static size_t maxSize();
+
+        static bool save(void * data, size_t size);
+        static bool load(const void * data, size_t size);
+
+    private:
+        static bool inMatch();
+        static unsigned int currentMatchSerial();
+        static bool heapsOverflowed();
+
+        static void syncMatch(SaveStateStream& stream);
+        static void syncHeap(SaveStateStream& stream, CGameplayHeap& heap);
+        static void syncGameValues(SaveStateStream& stream);
+        static void syncGameplayState(SaveStateStream& stream);
+        static void syncMap(SaveStateStream& stream);
+        static void syncTempPlatforms(SaveStateStream& stream);
+
+        static size_t gameModeSize(CGameMode * mode);
+        static void remapPlatform(MovingPlatform * from, MovingPlatform * to);
+};
+
+#endif // SAVESTATE_H
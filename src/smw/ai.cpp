@@ -34,7 +34,7 @@ CPlayerAI::CPlayerAI()
 
 CPlayerAI::~CPlayerAI()
 {
-    std::map<int, AttentionObject*>::iterator itr = attentionObjects.begin(), lim = attentionObjects.end();
+    AttentionObjectMap::iterator itr = attentionObjects.begin(), lim = attentionObjects.end();
     while (itr != lim) {
         delete (itr->second);
         itr++;
@@ -135,7 +135,7 @@ void CPlayerAI::Think(COutputControl * playerKeys)
 
     //Expire attention objects
 	std::vector<int> toDelete;
-    std::map<int, AttentionObject*>::iterator itr = attentionObjects.begin(), lim = attentionObjects.end();
+    AttentionObjectMap::iterator itr = attentionObjects.begin(), lim = attentionObjects.end();
     while (itr != lim) {
         if (itr->second->iTimer > 0) {
             if (--(itr->second->iTimer) == 0) {
@@ -149,7 +149,7 @@ void CPlayerAI::Think(COutputControl * playerKeys)
 
 	for (std::vector<int>::iterator tdIt = toDelete.begin(); tdIt != toDelete.end(); ++tdIt) {
 		// perform the actual disposal and removal
-		std::map<int, AttentionObject*>::iterator deadObjIt = attentionObjects.find(*tdIt);
+		AttentionObjectMap::iterator deadObjIt = attentionObjects.find(*tdIt);
 
 		delete deadObjIt->second;
 
@@ -626,7 +626,7 @@ void CPlayerAI::GetNearestObjects()
     bool fInvincible = pPlayer->isInvincible() || pPlayer->isShielded() || pPlayer->shyguy;
     short iTeamID = pPlayer->teamID;
 
-    std::map<int, AttentionObject*>::iterator lim = attentionObjects.end();
+    AttentionObjectMap::iterator lim = attentionObjects.end();
 
     for (short i = 0; i < objectcontainer[1].list_end; i++) {
         CObject * object = objectcontainer[1].list[i];
@@ -5,6 +5,7 @@
 #include <map>
 
 #include "Game.h"
+#include "GameplayHeap.h"
 extern CGame *smw;
 
 class CObject;
@@ -63,14 +64,22 @@ struct AttentionObject {
     int iID;	  //Global ID of this object
     short iType;  //Ignore it, high priority, etc.
     short iTimer;  //When it the attention expires, 0 for never
+
+    static void * operator new(size_t size) { return g_gameplayheap.allocate(size); }
+    static void operator delete(void * ptr) { g_gameplayheap.release(ptr); }
 };
 
+typedef std::map<int, AttentionObject*, std::less<int>, GameplayHeapAllocator<std::pair<const int, AttentionObject*> > > AttentionObjectMap;
+
 class CPlayerAI
 {
 public:
     CPlayerAI();
     virtual ~CPlayerAI();
 
+    static void * operator new(size_t size) { return g_gameplayheap.allocate(size); }
+    static void operator delete(void * ptr) { g_gameplayheap.release(ptr); }
+
     virtual void Init();
 
     void SetPlayer(CPlayer * player) {
@@ -91,7 +100,7 @@ private:
     short iFallDanger;
     NearestObjects nearestObjects;
 
-    std::map<int, AttentionObject*> attentionObjects;
+    AttentionObjectMap attentionObjects;
     AttentionObject currentAttentionObject;
 };
 
@@ -764,6 +764,7 @@ CGM_Chicken::CGM_Chicken() : CGameMode()
 {
     goal = 200;
     gamemode = game_mode_chicken;
+    counter = 0;
 
     SetupModeStrings("Chicken", "Points", 50);
 }
@@ -781,8 +782,6 @@ void CGM_Chicken::think()
         else if (chicken->getVelX() < -VELMOVING_CHICKEN)
             chicken->velx = -VELMOVING_CHICKEN;
 
-        static short counter = 0;
-
         if (chicken->isready() && !chicken->IsTanookiStatue()) {
             if (++counter >= game_values.pointspeed) {
                 counter = 0;
@@ -880,6 +879,7 @@ CGM_Tag::CGM_Tag() : CGameMode()
 {
     goal = 200;
     gamemode = game_mode_tag;
+    counter = 0;
 
     SetupModeStrings("Tag", "Points", 50);
 }
@@ -906,8 +906,6 @@ void CGM_Tag::think()
             tagged = GetHighestScorePlayer(!fReverseScoring);
         }
 
-        static short counter = 0;
-
         if (tagged->isready()) {
             if (++counter >= game_values.pointspeed) {
                 counter = 0;
@@ -1624,6 +1622,7 @@ CGM_Owned::CGM_Owned() : CGameMode()
 {
     goal = 200;
     gamemode = game_mode_owned;
+    counter = 0;
 
     SetupModeStrings("Owned", "Points", 50);
 }
@@ -1633,8 +1632,6 @@ void CGM_Owned::think()
     if (gameover) {
         displayplayertext();
     } else {
-        static short counter = 0;
-
         if (++counter >= game_values.pointspeed) {
             counter = 0;
 
@@ -2957,6 +2954,7 @@ CGM_Chase::CGM_Chase() : CGameMode()
 {
     goal = 200;
     gamemode = game_mode_chase;
+    counter = 0;
 
     SetupModeStrings("Phanto", "Points", 50);
 }
@@ -2985,8 +2983,6 @@ void CGM_Chase::think()
 
     CPlayer * keyholder = key->owner;
     if (keyholder) {
-        static short counter = 0;
-
         if (keyholder->isready() && !keyholder->IsTanookiStatue()) {
             if (++counter >= game_values.pointspeed) {
                 counter = 0;
@@ -130,6 +130,8 @@ class CGM_Chicken : public CGameMode
     }
 #endif
 
+	private:
+		short counter;
 };
 
 class CGM_Tag : public CGameMode
@@ -150,6 +152,8 @@ class CGM_Tag : public CGameMode
     }
 #endif
 
+	private:
+		short counter;
 };
 
 class CGM_ShyGuyTag : public CGameMode
@@ -300,6 +304,7 @@ class CGM_Owned : public CGameMode
 #endif
 
 	private:
+		short counter;
 		short CheckWinner(CPlayer * player);
 
 };
@@ -553,6 +558,7 @@ class CGM_Chase : public CGameMode
 #endif
 
 	private:
+		short counter;
 		CO_PhantoKey * key;
 };
 
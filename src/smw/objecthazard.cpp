@@ -32,7 +32,7 @@ extern CResourceManager* rm;
 extern CGame* smw;
 
 
-void LoadMapHazards(bool fPreview)
+void LoadMapHazards(CMap * map, bool fPreview)
 {
     //Make sure we don't have any objects created before we create them from the map settings
     noncolcontainer.clean();
@@ -41,8 +41,8 @@ void LoadMapHazards(bool fPreview)
     objectcontainer[2].clean();
 
     //Create objects for all the map hazards
-    for (short iMapHazard = 0; iMapHazard < g_map->iNumMapHazards; iMapHazard++) {
-        MapHazard * hazard = &g_map->maphazards[iMapHazard];
+    for (short iMapHazard = 0; iMapHazard < map->iNumMapHazards; iMapHazard++) {
+        MapHazard * hazard = &map->maphazards[iMapHazard];
         if (hazard->itype == 0) {
             for (short iFireball = 0; iFireball < hazard->iparam[0]; iFireball++)
                 objectcontainer[1].add(new OMO_OrbitHazard(&rm->spr_hazard_fireball[fPreview ? 1 : 0], (hazard->ix << 4) + 16, (hazard->iy << 4) + 16, (float)(iFireball * 24), hazard->dparam[0], hazard->dparam[1], 4, 8, 18, 18, 0, 0, 0, hazard->dparam[0] < 0.0f ? 18 : 0, 18, 18));
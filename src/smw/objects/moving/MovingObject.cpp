@@ -25,6 +25,37 @@ extern CEyecandyContainer eyecandy[3];
 
 extern CPlayer* GetPlayerFromGlobalID(short iGlobalID);
 
+void CMap::movingPlatformCollision(IO_MovingObject * object)
+{
+    PlatformArea area(object->fx, object->fPrecalculatedY, object->collisionWidth, object->collisionHeight, object->velx, object->vely);
+
+    size_t iFirstCandidate = findPlatforms(area, object->platform);
+    size_t iCandidate = iFirstCandidate;
+    short iPlatform = -1;
+
+    while ((iPlatform = nextPlatform(iCandidate, iPlatform, area.contains(object->fx, object->fPrecalculatedY, object->collisionWidth, object->collisionHeight))) >= 0)
+        indexedplatforms[iPlatform]->collide(object);
+
+    releasePlatforms(iFirstCandidate);
+}
+
+bool CMap::movingPlatformCheckSides(IO_MovingObject * object)
+{
+    PlatformArea area(object->fx, object->fPrecalculatedY, object->collisionWidth, object->collisionHeight, object->velx, object->vely);
+
+    size_t iFirstCandidate = findPlatforms(area, object->platform);
+
+    bool fRet = false;
+    size_t iCandidate = iFirstCandidate;
+    short iPlatform = -1;
+
+    while ((iPlatform = nextPlatform(iCandidate, iPlatform, area.contains(object->fx, object->fPrecalculatedY, object->collisionWidth, object->collisionHeight))) >= 0)
+        fRet |= indexedplatforms[iPlatform]->collision_detection_check_sides(object);
+
+    releasePlatforms(iFirstCandidate);
+    return fRet;
+}
+
 //------------------------------------------------------------------------------
 // class MovingObject (all moving objects inheirit from this class)
 //------------------------------------------------------------------------------
@@ -94,6 +94,8 @@ class IO_MovingObject : public CObject
 	friend class MO_PirhanaPlant;
 
 	friend class MovingPlatform;
+	friend class CMap;
+	friend class SaveState;
 
 	friend void removeifprojectile(IO_MovingObject * object, bool playsound, bool forcedead);
 	friend void RunGame();
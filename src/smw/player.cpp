@@ -54,24 +54,22 @@ void CScore::AdjustScore(short iValue)
 
 void CMap::movingPlatformCollision(CPlayer * player)
 {
-    //Collide player with normal moving platforms
-    for (short iPlatform = 0; iPlatform < iNumPlatforms; iPlatform++) {
-        platforms[iPlatform]->collide(player);
+    //Collide player with the normal moving platforms, then the temporary ones
+    //(like falling donut blocks), skipping those too far away to touch
+    PlatformArea area(player->fx, player->fPrecalculatedY, PW, PH, player->velx, player->vely);
 
-        if (!player->isready())
-            return;
-    }
+    size_t iFirstCandidate = findPlatforms(area, player->platform);
+    size_t iCandidate = iFirstCandidate;
+    short iPlatform = -1;
 
-    //Collide player with temporary platforms (like falling donut blocks)
-    std::list<MovingPlatform*>::iterator iterateAll = tempPlatforms.begin(), lim = tempPlatforms.end();
-    while (iterateAll != lim) {
-        (*iterateAll)->collide(player);
+    while ((iPlatform = nextPlatform(iCandidate, iPlatform, area.contains(player->fx, player->fPrecalculatedY, PW, PH))) >= 0) {
+        indexedplatforms[iPlatform]->collide(player);
 
         if (!player->isready())
-            return;
-
-        iterateAll++;
+            break;
     }
+
+    releasePlatforms(iFirstCandidate);
 }
 
 CPlayer * GetPlayerFromGlobalID(short iGlobalID)
@@ -2,6 +2,7 @@
 #define PLAYER_H
 
 #include "ai.h"
+#include "GameplayHeap.h"
 #include "gfx.h"
 #include "GlobalConstants.h"
 #include "Score.h"
@@ -82,6 +83,9 @@ public:
             CScore *nscore, short * respawnCounter, CPlayerAI * ai);
     ~CPlayer();
 
+    static void * operator new(size_t size) { return g_gameplayheap.allocate(size); }
+    static void operator delete(void * ptr) { g_gameplayheap.release(ptr); }
+
     void Init();
 
     /* Player info */
@@ -500,6 +504,7 @@ private:
 
 		friend class FallingPath;
 		friend class MovingPlatform;
+		friend class CMap;
 
 		friend bool SwapPlayers(short iUsingPlayerID);
 		friend CPlayer * GetPlayerFromGlobalID(short iGlobalID);
@@ -514,6 +519,7 @@ private:
 		friend struct NetPkgs::P2PCollision;
 
 		friend class GameplayState;
+		friend class SaveState;
 
 		friend class PlayerAwardEffects;
 		friend class PlayerBurnupTimer;
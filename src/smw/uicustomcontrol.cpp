@@ -17,12 +17,6 @@
 #include <cstdlib> // abs()
 #include <cstring>
 
-#if !defined(__EMSCRIPTEN__) && !defined(__LIBRETRO__)
-    inline void smallDelay() { SDL_Delay(10); }
-#else
-    inline void smallDelay() {}
-#endif
-
 extern SDL_Surface* screen;
 extern SDL_Surface* blitdest;
 
@@ -2437,9 +2431,6 @@ bool MI_MapFilterScroll::MovePrev()
 MI_MapBrowser::MI_MapBrowser() :
     UI_Control(0, 0)
 {
-    for (short iSurface = 0; iSurface < 9; iSurface++)
-        mapSurfaces[iSurface] = NULL;
-
     srcRectBackground.x = 0;
     srcRectBackground.y = 0;
     srcRectBackground.w = smw->ScreenWidth;
@@ -2454,17 +2445,12 @@ MI_MapBrowser::MI_MapBrowser() :
 }
 
 MI_MapBrowser::~MI_MapBrowser()
-{
-    for (short iSurface = 0; iSurface < 9; iSurface++) {
-        if (mapSurfaces[iSurface]) {
-            SDL_FreeSurface(mapSurfaces[iSurface]);
-            mapSurfaces[iSurface] = NULL;
-        }
-    }
-}
+{}
 
 void MI_MapBrowser::Update()
 {
+    thumbnails.update();
+
     if (++iFilterTagAnimationTimer > 8) {
         iFilterTagAnimationTimer = 0;
 
@@ -2479,7 +2465,6 @@ void MI_MapBrowser::Draw()
     if (!fShow)
         return;
 
-    SDL_Rect rSrc = {0, 0, 160, 120};
     SDL_Rect rDst = {0, 0, 160, 120};
 
     for (short iRow = 0; iRow < 3; iRow++) {
@@ -2492,7 +2477,7 @@ void MI_MapBrowser::Draw()
 
                 rDst.x = iCol * 200 + 40;
 
-                SDL_BlitSurface(mapSurfaces[iRow * 3 + iCol], &rSrc, blitdest, &rDst);
+                DrawThumbnail(iRow * 3 + iCol, &rDst);
 
                 if (iType == 0) {
                     if (mapListNodes[iRow * 3 + iCol]->pfFilters[game_values.selectedmapfilter])
@@ -2513,7 +2498,7 @@ void MI_MapBrowser::Draw()
     rm->menu_dialog.draw(rDst.x - 16, rDst.y + 132, 0, 464, 176, 16);
     rm->menu_dialog.draw(rDst.x + 160, rDst.y + 132, 496, 464, 16, 16);
 
-    SDL_BlitSurface(mapSurfaces[iSelectedRow * 3 + iSelectedCol], &rSrc, blitdest, &rDst);
+    DrawThumbnail(iSelectedRow * 3 + iSelectedCol, &rDst);
 
     if (iType == 0) {
         if (mapListNodes[iSelectedRow * 3 + iSelectedCol]->pfFilters[game_values.selectedmapfilter])
@@ -2523,6 +2508,22 @@ void MI_MapBrowser::Draw()
     rm->menu_font_large.drawChopRight(rDst.x, rDst.y + 120, 165, mapNames[iSelectedRow * 3 + iSelectedCol]);
 }
 
+void MI_MapBrowser::DrawThumbnail(short iMap, SDL_Rect * rDst)
+{
+    SDL_Rect rSrc = {0, 0, 160, 120};
+    SDL_Rect rThumbnail = *rDst;
+
+    SDL_Surface * thumbnail = thumbnails.get(mapListNodes[iMap]->filename);
+
+    //Still being made on the worker, or it couldn't be made at all
+    if (!thumbnail) {
+        SDL_FillRect(blitdest, &rThumbnail, SDL_MapRGB(blitdest->format, 0, 0, 0));
+        return;
+    }
+
+    SDL_BlitSurface(thumbnail, &rSrc, blitdest, &rThumbnail);
+}
+
 MenuCodeEnum MI_MapBrowser::Modify(bool modify)
 {
     fModifying = modify;
@@ -2667,45 +2668,36 @@ void MI_MapBrowser::Reset(short type)
 
 void MI_MapBrowser::LoadPage(short page, bool fUseFilters)
 {
-    for (short iMap = 0; iMap < 9; iMap++) {
-        short iIndex = iMap + page * 9;
+    std::vector<std::string> wanted;
 
-        if (iIndex >= iMapCount)
-            return;
+    //The page on screen comes first, then the ones paging would show next
+    short iPages[3] = {page, (short)(page + 1), (short)(page - 1)};
 
-        std::map<std::string, MapListNode*>::iterator itr = maplist->GetIteratorAt(iIndex, fUseFilters);
+    for (short iPageIndex = 0; iPageIndex < 3; iPageIndex++) {
+        for (short iMap = 0; iMap < 9; iMap++) {
+            short iIndex = iMap + iPages[iPageIndex] * 9;
 
-        //See if we already have a thumbnail saved for this map
-
-        char szThumbnail[256];
-        strcpy(szThumbnail, "maps/cache/");
-        char * pszThumbnail = szThumbnail + strlen(szThumbnail);
-        GetNameFromFileName(pszThumbnail, (*itr).second->filename.c_str());
-
-#ifdef PNG_SAVE_FORMAT
-        strcat(szThumbnail, ".png");
-#else
-        strcat(szThumbnail, ".bmp");
-#endif
+            if (iIndex < 0 || iIndex >= iMapCount)
+                break;
 
-        std::string sConvertedPath = convertPath(szThumbnail);
+            std::map<std::string, MapListNode*>::iterator itr = maplist->GetIteratorAt(iIndex, fUseFilters);
+            wanted.push_back((*itr).second->filename);
 
-        if (!File_Exists(sConvertedPath)) {
-            g_map->loadMap((*itr).second->filename, read_type_preview);
-            smallDelay();  //Sleeps to help the music from skipping
-            g_map->saveThumbnail(sConvertedPath, false);
-            smallDelay();
+            if (iPageIndex == 0) {
+                mapListNodes[iMap] = (*itr).second;
+                mapNames[iMap] = (*itr).first.c_str();
+                mapListItr[iMap] = itr;
+            }
         }
+    }
 
-        if (mapSurfaces[iMap])
-            SDL_FreeSurface(mapSurfaces[iMap]);
-
-        mapSurfaces[iMap] = IMG_Load(sConvertedPath.c_str());
+    thumbnails.want(wanted);
+    thumbnails.update();
+}
 
-        mapListNodes[iMap] = (*itr).second;
-        mapNames[iMap] = (*itr).first.c_str();
-        mapListItr[iMap] = itr;
-    }
+void MI_MapBrowser::Close()
+{
+    thumbnails.cancel();
 }
 
 
@@ -2,6 +2,7 @@
 #define UICUSTOMCONTROL_H
 
 #include "input.h"
+#include "MapThumbnails.h"
 #include "uicontrol.h"
 #include "ui/MI_MapField.h"
 #include "ui/MI_PowerupSlider.h"
@@ -467,16 +468,20 @@ class MI_MapBrowser : public UI_Control
 
 		void Reset(short type);
 
+		//Waits for the thumbnail worker before the menus draw map previews again
+		void Close();
+
 	private:
 
 		void LoadPage(short page, bool fUseFilters);
+		void DrawThumbnail(short iMap, SDL_Rect * rDst);
 
 		short iPage;
 		short iSelectedCol;
 		short iSelectedRow;
 		short iSelectedIndex;
 
-		SDL_Surface * mapSurfaces[9];
+		CMapThumbnails thumbnails;
 		MapListNode * mapListNodes[9];
 		const char * mapNames[9];
 		std::map<std::string, MapListNode*>::iterator mapListItr[9];
@@ -396,6 +396,9 @@ bool WorldMap::Load(short tilesize)
     Cleanup();
     ResetDrawCycle();
 
+    //Every world draw comes after a load, so the world sprites wait until here
+    rm->RequireWorldGraphics();
+
     iTileSize = tilesize;
 
     if (iTileSize == TILESIZE) {